@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_ADAM7_HPP_INCLUDED
+#define PNGPP_ADAM7_HPP_INCLUDED
+
+#include <cassert>
+#include <cstddef>
+
+#include "types.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief The geometry of the Adam7 interlace passes.
+     *
+     * Passes are numbered from 0 to 6, as in consumer::reset().
+     */
+    class adam7
+    {
+    public:
+        static size_t const pass_count = 7;
+
+        /**
+         * \brief Returns the column of the first pixel of a \a pass.
+         */
+        static size_t get_x_start(size_t pass)
+        {
+            static size_t const start[pass_count] = { 0, 4, 0, 2, 0, 1, 0 };
+            assert(pass < pass_count);
+            return start[pass];
+        }
+
+        /**
+         * \brief Returns the row of the first pixel of a \a pass.
+         */
+        static size_t get_y_start(size_t pass)
+        {
+            static size_t const start[pass_count] = { 0, 0, 4, 0, 2, 0, 1 };
+            assert(pass < pass_count);
+            return start[pass];
+        }
+
+        /**
+         * \brief Returns the distance between the columns of a \a
+         * pass.
+         */
+        static size_t get_x_step(size_t pass)
+        {
+            static size_t const step[pass_count] = { 8, 8, 4, 4, 2, 2, 1 };
+            assert(pass < pass_count);
+            return step[pass];
+        }
+
+        /**
+         * \brief Returns the distance between the rows of a \a pass.
+         */
+        static size_t get_y_step(size_t pass)
+        {
+            static size_t const step[pass_count] = { 8, 8, 8, 4, 4, 2, 2 };
+            assert(pass < pass_count);
+            return step[pass];
+        }
+
+        /**
+         * \brief Returns the width of the sub-image a \a pass
+         * carries for an image \a width pixels wide.
+         */
+        static size_t get_pass_width(size_t pass, size_t width)
+        {
+            return width > get_x_start(pass)
+                ? (width - get_x_start(pass) + get_x_step(pass) - 1)
+                  / get_x_step(pass)
+                : 0;
+        }
+
+        /**
+         * \brief Returns the height of the sub-image a \a pass
+         * carries for an image \a height pixels high.
+         */
+        static size_t get_pass_height(size_t pass, size_t height)
+        {
+            return height > get_y_start(pass)
+                ? (height - get_y_start(pass) + get_y_step(pass) - 1)
+                  / get_y_step(pass)
+                : 0;
+        }
+
+        /**
+         * \brief Returns the distance between the columns known once
+         * passes 0 to \a pass are complete.
+         */
+        static size_t get_known_x_step(size_t pass)
+        {
+            static size_t const step[pass_count] = { 8, 4, 4, 2, 2, 1, 1 };
+            assert(pass < pass_count);
+            return step[pass];
+        }
+
+        /**
+         * \brief Returns the distance between the rows known once
+         * passes 0 to \a pass are complete.
+         */
+        static size_t get_known_y_step(size_t pass)
+        {
+            static size_t const step[pass_count] = { 8, 8, 4, 4, 2, 2, 1 };
+            assert(pass < pass_count);
+            return step[pass];
+        }
+    };
+
+    /**
+     * \brief A low-resolution view of an interlaced image being
+     * read.
+     *
+     * Once passes 0 to \a pass of an Adam7 image are read into a
+     * full-size pixel buffer, the pixels on a regular grid are
+     * final: every 8th pixel of every 8th row after the first pass,
+     * every 4th of every 8th after the second, and so on.  The
+     * preview presents that grid as an image of its own, e.g. a
+     * 1/8-scale one after the first pass, without copying anything.
+     * For non-interlaced images it covers the whole buffer.
+     *
+     * \see image::read_progressive()
+     */
+    template< typename pixel, class pixbuf >
+    class adam7_preview
+    {
+    public:
+        adam7_preview(pixbuf const& pixels, size_t pass, bool interlaced)
+            : m_pixbuf(pixels),
+              m_pass(pass),
+              m_x_step(interlaced ? adam7::get_known_x_step(pass) : 1),
+              m_y_step(interlaced ? adam7::get_known_y_step(pass) : 1)
+        {
+        }
+
+        /**
+         * \brief Returns the number of the last pass read.
+         */
+        size_t get_pass() const
+        {
+            return m_pass;
+        }
+
+        /**
+         * \brief Returns true if the image is complete.
+         */
+        bool is_complete() const
+        {
+            return m_x_step == 1 && m_y_step == 1;
+        }
+
+        size_t get_width() const
+        {
+            return (m_pixbuf.get_width() + m_x_step - 1) / m_x_step;
+        }
+
+        size_t get_height() const
+        {
+            return (m_pixbuf.get_height() + m_y_step - 1) / m_y_step;
+        }
+
+        size_t get_x_step() const
+        {
+            return m_x_step;
+        }
+
+        size_t get_y_step() const
+        {
+            return m_y_step;
+        }
+
+        /**
+         * \brief Returns the preview pixel at (x,y), i.e. the pixel
+         * at (x * get_x_step(), y * get_y_step()) of the image.
+         */
+        pixel get_pixel(size_t x, size_t y) const
+        {
+            return m_pixbuf.get_pixel(x * m_x_step, y * m_y_step);
+        }
+
+        /**
+         * \brief Returns the full-size pixel buffer being read.
+         */
+        pixbuf const& get_pixbuf() const
+        {
+            return m_pixbuf;
+        }
+
+    private:
+        pixbuf const& m_pixbuf;
+        size_t m_pass;
+        size_t m_x_step;
+        size_t m_y_step;
+    };
+
+} // namespace png
+
+#endif // PNGPP_ADAM7_HPP_INCLUDED
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_ARENA_HPP_INCLUDED
+#define PNGPP_ARENA_HPP_INCLUDED
+
+#include <cstdlib>
+#include <new>
+
+#include "memory_resource.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief A bump allocator serving all the memory of a request
+     * from a few big chunks.
+     *
+     * allocate() hands out consecutive pieces of the current chunk
+     * and deallocate() does nothing; the memory is given back in one
+     * step by reset() or release().  Made current with a
+     * memory_resource::scope it serves a whole decode--libpng and
+     * zlib state as well as the rows of pixel buffers using
+     * png::allocator--without touching the global heap, and thus
+     * without contention between threads each using an arena of
+     * their own:
+     *
+     * \code
+     * png::arena arena;
+     * for (...)
+     * {
+     *     {
+     *         png::memory_resource::scope use_arena(arena);
+     *         png::image< png::rgba_pixel,
+     *                     png::solid_pixel_buffer
+     *                     < png::rgba_pixel,
+     *                       png::allocator< png::rgba_pixel > > >
+     *             image(...);
+     *         ...
+     *     }
+     *     arena.reset();
+     * }
+     * \endcode
+     *
+     * Everything allocated from an arena must be destroyed before
+     * reset() or release() is called.  An arena is not thread-safe.
+     *
+     * \see memory_resource, memory_cache
+     */
+    class arena
+        : public memory_resource
+    {
+    public:
+        /**
+         * \brief Constructs an empty arena allocating chunks of at
+         * least \a chunk_size bytes.
+         */
+        explicit arena(size_t chunk_size = 64 * 1024)
+            : m_chunk_size(chunk_size),
+              m_chunks(0),
+              m_size(0),
+              m_capacity(0)
+        {
+        }
+
+        ~arena()
+        {
+            release();
+        }
+
+        virtual void* allocate(size_t size)
+        {
+            size = align(size);
+            chunk* c = m_chunks;
+            if (!c || c->size - c->used < size)
+            {
+                c = add_chunk(size > m_chunk_size ? size : m_chunk_size);
+            }
+            void* ptr = reinterpret_cast< byte* >(c)
+                + header_size + c->used;
+            c->used += size;
+            m_size += size;
+            return ptr;
+        }
+
+        /**
+         * \brief Does nothing: the memory is reclaimed by reset() or
+         * release().
+         */
+        virtual void deallocate(void*)
+        {
+        }
+
+        /**
+         * \brief Makes all the memory available again, keeping it
+         * for the next request.
+         *
+         * If the last request needed more than one chunk, they are
+         * replaced by one big enough for all, so a following request
+         * of the same shape is served without any call to the system
+         * allocator.
+         */
+        void reset()
+        {
+            if (m_chunks && m_chunks->next)
+            {
+                size_t capacity = m_capacity;
+                release();
+                add_chunk(capacity);
+            }
+            else if (m_chunks)
+            {
+                m_chunks->used = 0;
+            }
+            m_size = 0;
+        }
+
+        /**
+         * \brief Frees all the chunks.
+         */
+        void release()
+        {
+            while (chunk* c = m_chunks)
+            {
+                m_chunks = c->next;
+                std::free(c);
+            }
+            m_size = 0;
+            m_capacity = 0;
+        }
+
+        /**
+         * \brief Returns the number of bytes allocated since the
+         * last reset() or release().
+         */
+        size_t get_size() const
+        {
+            return m_size;
+        }
+
+        /**
+         * \brief Returns the total size of the chunks held.
+         */
+        size_t get_capacity() const
+        {
+            return m_capacity;
+        }
+
+    private:
+        struct chunk
+        {
+            chunk* next;
+            size_t size;
+            size_t used;
+        };
+
+        static size_t const alignment = 2 * sizeof(void*) < 16
+            ? 16 : 2 * sizeof(void*);
+        static size_t const header_size
+            = (sizeof(chunk) + alignment - 1) / alignment * alignment;
+
+        static size_t align(size_t size)
+        {
+            return (size + alignment - 1) / alignment * alignment;
+        }
+
+        chunk* add_chunk(size_t size)
+        {
+            chunk* c = static_cast< chunk* >(std::malloc(header_size + size));
+            if (!c)
+            {
+                throw std::bad_alloc();
+            }
+            c->next = m_chunks;
+            c->size = size;
+            c->used = 0;
+            m_chunks = c;
+            m_capacity += size;
+            return c;
+        }
+
+        size_t m_chunk_size;
+        chunk* m_chunks;
+        size_t m_size;
+        size_t m_capacity;
+    };
+
+} // namespace png
+
+#endif // PNGPP_ARENA_HPP_INCLUDED
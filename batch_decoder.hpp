@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_BATCH_DECODER_HPP_INCLUDED
+#define PNGPP_BATCH_DECODER_HPP_INCLUDED
+
+#include "config.hpp"
+
+#ifdef PNGPP_HAS_STD_THREAD
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "image.hpp"
+#include "memory_stream.hpp"
+#include "thread_pool.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief Decodes many images concurrently.
+     *
+     * Each image is decoded by a separate task (with its own reader)
+     * on a work-stealing thread_pool.  The number of images decoded
+     * at the same time is bounded by the number of threads in the
+     * pool.  Results are delivered either through \c std::future
+     * objects:
+     *
+     * \code
+     * png::batch_decoder< png::rgb_pixel > decoder(4);
+     * std::vector< std::future< png::image< png::rgb_pixel > > > results
+     *     = decoder.decode(filenames);
+     * for (size_t i = 0; i < results.size(); ++i)
+     * {
+     *     try
+     *     {
+     *         png::image< png::rgb_pixel > image = results[i].get();
+     *         ...
+     *     }
+     *     catch (std::exception const& error)
+     *     {
+     *         ...
+     *     }
+     * }
+     * \endcode
+     *
+     * or through a completion callback, which is called on a worker
+     * thread.  A failing image never affects the rest of the batch:
+     * its error is reported through its future (or the callback) and
+     * decoding goes on.
+     *
+     * Images are converted to the \c pixel color space using
+     * convert_color_space.  Memory buffers are not copied and must
+     * stay valid until the corresponding image is decoded.
+     *
+     * Requires C++11 (see \c PNGPP_HAS_STD_THREAD in config.hpp).
+     *
+     * \see thread_pool, image
+     */
+    template< typename pixel,
+              typename pixel_buffer_type = pixel_buffer< pixel > >
+    class batch_decoder
+    {
+    public:
+        typedef image< pixel, pixel_buffer_type > image_type;
+
+        /**
+         * \brief The completion callback type.  On failure the image
+         * passed is empty and \c error holds the exception.
+         */
+        typedef std::function< void (size_t index,
+                                     image_type& image,
+                                     std::exception_ptr error) > callback;
+
+        /**
+         * \brief Constructs a decoder running at most \a
+         * max_threads decoding tasks at a time.  The default of \c
+         * 0 means one per hardware thread.
+         */
+        explicit batch_decoder(size_t max_threads = 0)
+            : m_pool(max_threads)
+        {
+        }
+
+        /**
+         * \brief Schedules decoding of the file \a filename.
+         */
+        std::future< image_type > decode(std::string const& filename)
+        {
+            return submit(file_source(filename));
+        }
+
+        /**
+         * \brief Schedules decoding of \a size bytes of PNG data at
+         * \a data.
+         */
+        std::future< image_type > decode(void const* data, size_t size)
+        {
+            return submit(memory_source(data, size));
+        }
+
+        /**
+         * \brief Schedules decoding of every file in \a filenames.
+         * The futures are returned in the same order.
+         */
+        std::vector< std::future< image_type > >
+        decode(std::vector< std::string > const& filenames)
+        {
+            std::vector< std::future< image_type > > results;
+            results.reserve(filenames.size());
+            for (size_t i = 0; i < filenames.size(); ++i)
+            {
+                results.push_back(decode(filenames[i]));
+            }
+            return results;
+        }
+
+        /**
+         * \brief Schedules decoding of every file in \a filenames,
+         * reporting each result to \a done along with the index of
+         * the file.
+         */
+        void decode(std::vector< std::string > const& filenames,
+                    callback const& done)
+        {
+            for (size_t i = 0; i < filenames.size(); ++i)
+            {
+                submit(file_source(filenames[i]), i, done);
+            }
+        }
+
+        /**
+         * \brief Blocks until all the scheduled images are decoded.
+         */
+        void wait()
+        {
+            m_pool.wait();
+        }
+
+    private:
+        struct file_source
+        {
+            explicit file_source(std::string const& name)
+                : filename(name)
+            {
+            }
+
+            void operator()(image_type& image) const
+            {
+                image.read(filename);
+            }
+
+            std::string filename;
+        };
+
+        struct memory_source
+        {
+            memory_source(void const* ptr, size_t len)
+                : data(ptr),
+                  size(len)
+            {
+            }
+
+            void operator()(image_type& image) const
+            {
+                memory_istream stream(data, size);
+                image.read_stream(stream);
+            }
+
+            void const* data;
+            size_t size;
+        };
+
+        template< class source >
+        std::future< image_type > submit(source const& src)
+        {
+            typedef std::packaged_task< image_type () > task_type;
+            std::shared_ptr< task_type > task(new task_type([src]()
+                {
+                    image_type image;
+                    src(image);
+                    return image;
+                }));
+            std::future< image_type > result = task->get_future();
+            m_pool.submit([task]() { (*task)(); });
+            return result;
+        }
+
+        template< class source >
+        void submit(source const& src, size_t index, callback const& done)
+        {
+            m_pool.submit([src, index, done]()
+                {
+                    image_type image;
+                    std::exception_ptr error;
+                    try
+                    {
+                        src(image);
+                    }
+                    catch (...)
+                    {
+                        error = std::current_exception();
+                        image = image_type();
+                    }
+                    done(index, image, error);
+                });
+        }
+
+        thread_pool m_pool;
+    };
+
+} // namespace png
+
+#endif // PNGPP_HAS_STD_THREAD
+
+#endif // PNGPP_BATCH_DECODER_HPP_INCLUDED
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+#ifdef PNGPP_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+/*
+ * Runs a per-row SIMD kernel (saturating brighten of every byte)
+ * over an rgb image in a packed solid_pixel_buffer, whose rows start
+ * at arbitrary offsets, and in one with 64-byte aligned rows.  The
+ * packed rows need unaligned loads and stores, the aligned ones use
+ * aligned accesses.  The width is odd so that packed rows really are
+ * misaligned.
+ */
+
+template< bool aligned >
+void
+brighten(png::byte* row, size_t size)
+{
+    size_t i = 0;
+#ifdef PNGPP_HAS_SSE2
+    __m128i const add = _mm_set1_epi8(3);
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i* p = reinterpret_cast< __m128i* >(row + i);
+        if (aligned)
+        {
+            _mm_store_si128(p, _mm_adds_epu8(_mm_load_si128(p), add));
+        }
+        else
+        {
+            _mm_storeu_si128(p, _mm_adds_epu8(_mm_loadu_si128(p), add));
+        }
+    }
+#endif
+    for (; i < size; ++i)
+    {
+        row[i] = row[i] > 252 ? 255 : row[i] + 3;
+    }
+}
+
+template< bool aligned, class buffer >
+void
+run(char const* name, size_t width, size_t height, int runs)
+{
+    typedef typename buffer::row_traits row_traits;
+    buffer pixels(width, height);
+    size_t const size = width * sizeof(png::rgb_pixel);
+    // aligned kernels may also run over the padding
+    size_t const span = aligned ? pixels.get_stride() : size;
+
+    bench::timer t;
+    for (int i = 0; i < runs; ++i)
+    {
+        for (size_t y = 0; y < height; ++y)
+        {
+            brighten< aligned >(row_traits::get_data(pixels[y]), span);
+        }
+    }
+    double const seconds = t.elapsed() / runs;
+
+    std::cout << width << "x" << height << " " << name << ": stride "
+              << pixels.get_stride() << ", " << seconds * 1e3 << " ms, "
+              << size * height / seconds / 1e9 << " GB/s" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t width = argc > 1 ? atoi(argv[1]) : 1021;
+    size_t height = argc > 2 ? atoi(argv[2]) : 1024;
+    int runs = argc > 3 ? atoi(argv[3]) : 200;
+
+    run< false, png::solid_pixel_buffer< png::rgb_pixel > >
+        ("packed rows", width, height, runs);
+    run< false, png::solid_pixel_buffer
+         < png::rgb_pixel, png::aligned_allocator< png::rgb_pixel, 64 >,
+           64 > >
+        ("aligned rows, unaligned kernel", width, height, runs);
+    run< true, png::solid_pixel_buffer
+         < png::rgb_pixel, png::aligned_allocator< png::rgb_pixel, 64 >,
+           64 > >
+        ("aligned rows, aligned kernel", width, height, runs);
+}
+catch (std::exception const& error)
+{
+    std::cerr << "aligned_rows: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
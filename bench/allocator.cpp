@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Compares decoding from memory with all the allocations going to
+ * the global heap against serving each decode from a per-thread
+ * arena released after every image: the number of calls to the
+ * system allocator per image and the throughput as threads are
+ * added.
+ */
+
+typedef png::rgba_pixel pixel;
+typedef png::image< pixel,
+                    png::pixel_buffer< pixel, png::allocator< pixel > > >
+    image_type;
+
+/*
+ * Forwards to the global heap, counting the calls: the baseline.
+ * Counts are only read with a single thread running.
+ */
+class counting_heap
+    : public png::memory_resource
+{
+public:
+    counting_heap()
+        : m_count(0)
+    {
+    }
+
+    virtual void* allocate(size_t size)
+    {
+        ++m_count;
+        void* ptr = std::malloc(size);
+        if (!ptr)
+        {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    virtual void deallocate(void* ptr)
+    {
+        std::free(ptr);
+    }
+
+    size_t get_count() const
+    {
+        return m_count;
+    }
+
+private:
+    size_t m_count;
+};
+
+// operator new calls not routed through png::allocator
+static std::atomic< size_t > new_count(0);
+
+void*
+operator new(size_t size)
+{
+    ++new_count;
+    if (void* ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void
+decode(std::vector< png::byte > const& data, int runs, bool use_arena,
+       size_t* allocations)
+{
+    counting_heap heap;
+    png::arena arena;
+    size_t chunks = 0;
+    size_t capacity = 0;
+    size_t new_before = new_count;
+    for (int i = 0; i < runs; ++i)
+    {
+        {
+            png::memory_resource::scope
+                use(use_arena
+                    ? static_cast< png::memory_resource& >(arena)
+                    : heap);
+            png::memory_istream stream(& data[0], data.size());
+            image_type image;
+            image.read_stream(stream);
+        }
+        if (arena.get_capacity() != capacity)
+        {
+            ++chunks;
+            capacity = arena.get_capacity();
+        }
+        arena.reset();
+    }
+    if (allocations)
+    {
+        *allocations = heap.get_count() + chunks
+            + (new_count - new_before);
+    }
+}
+
+double
+run_threads(std::vector< png::byte > const& data, size_t threads,
+            int runs, bool use_arena)
+{
+    bench::timer t;
+    std::vector< std::thread > workers;
+    for (size_t i = 0; i < threads; ++i)
+    {
+        workers.push_back(std::thread(decode, std::cref(data), runs,
+                                      use_arena, (size_t*) 0));
+    }
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
+    return threads * runs / t.elapsed();
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    int runs = argc > 1 ? atoi(argv[1]) : 500;
+    size_t const size = 128;
+
+    std::vector< png::byte > data;
+    {
+        png::image< pixel, png::solid_pixel_buffer< pixel > >
+            source(size, size);
+        bench::fill(source, bench::content_photo);
+        png::memory_ostream stream(data);
+        source.write_stream(stream);
+    }
+
+    std::cout << size << "x" << size << " rgba, "
+              << runs << " decodes per thread" << std::endl;
+
+    size_t heap_allocations = 0;
+    size_t arena_allocations = 0;
+    decode(data, runs, false, & heap_allocations);
+    decode(data, runs, true, & arena_allocations);
+    std::cout << "system allocations per image: heap "
+              << double(heap_allocations) / runs
+              << ", arena " << double(arena_allocations) / runs
+              << std::endl;
+
+    size_t max_threads = std::thread::hardware_concurrency();
+    if (max_threads < 4)
+    {
+        max_threads = 4;
+    }
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        double heap = run_threads(data, threads, runs, false);
+        double arena = run_threads(data, threads, runs, true);
+        std::cout << threads << " thread(s): heap " << heap
+                  << " images/s, arena " << arena << " images/s"
+                  << std::endl;
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "allocator: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
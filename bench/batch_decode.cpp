@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Measures batch_decoder throughput against the thread count.
+ *
+ * usage: batch_decode [FILE...]
+ *
+ * The files given on the command line (e.g. ../test/pngsuite/\*.png)
+ * form one corpus; a set of large synthetic images forms another.
+ * Both are decoded from memory so disk IO does not interfere.
+ */
+
+typedef png::rgba_pixel pixel;
+typedef png::batch_decoder< pixel, png::solid_pixel_buffer< pixel > >
+    decoder_type;
+typedef std::vector< png::byte > buffer;
+
+void
+run(char const* name, std::vector< buffer > const& corpus, int repeat)
+{
+    double bytes = 0;
+    for (size_t i = 0; i < corpus.size(); ++i)
+    {
+        bytes += corpus[i].size();
+    }
+    size_t max_threads = std::thread::hardware_concurrency();
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        decoder_type decoder(threads);
+        bench::timer t;
+        size_t failed = 0;
+        for (int r = 0; r < repeat; ++r)
+        {
+            std::vector< std::future< decoder_type::image_type > > results;
+            for (size_t i = 0; i < corpus.size(); ++i)
+            {
+                results.push_back(decoder.decode(& corpus[i][0],
+                                                 corpus[i].size()));
+            }
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                try
+                {
+                    results[i].get();
+                }
+                catch (std::exception const&)
+                {
+                    ++failed;
+                }
+            }
+        }
+        double s = t.elapsed();
+        std::cout << name << ": " << threads << " threads: "
+                  << corpus.size() * repeat / s << " images/s, "
+                  << bytes * repeat / s / (1024 * 1024) << " MB/s";
+        if (failed)
+        {
+            std::cout << " (" << failed << " failed)";
+        }
+        std::cout << std::endl;
+    }
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    std::vector< buffer > files;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        files.push_back(buffer((std::istreambuf_iterator< char >(file)),
+                               std::istreambuf_iterator< char >()));
+    }
+    if (!files.empty())
+    {
+        run("files", files, 50);
+    }
+
+    std::vector< buffer > large(16);
+    for (size_t i = 0; i < large.size(); ++i)
+    {
+        png::image< pixel, png::solid_pixel_buffer< pixel > >
+            image(2048, 2048);
+        bench::fill(image, bench::content_photo, i + 1);
+        png::memory_ostream stream(large[i]);
+        image.write_stream(stream);
+    }
+    run("synthetic 2048x2048", large, 1);
+}
+catch (std::exception const& error)
+{
+    std::cerr << "batch_decode: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
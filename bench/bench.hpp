@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_BENCH_HPP_INCLUDED
+#define PNGPP_BENCH_HPP_INCLUDED
+
+#include <cstdio>
+#include <cstdlib>
+#include <sys/time.h>
+
+#include <png.hpp>
+
+/*
+ * Helpers shared by the benchmark programs: a wall-clock timer and
+ * synthetic image content.
+ */
+namespace bench
+{
+
+    class timer
+    {
+    public:
+        timer()
+        {
+            restart();
+        }
+
+        void restart()
+        {
+            gettimeofday(& m_start, 0);
+        }
+
+        /**
+         * \brief Returns seconds elapsed since construction or the
+         * last restart().
+         */
+        double elapsed() const
+        {
+            struct timeval now;
+            gettimeofday(& now, 0);
+            return (now.tv_sec - m_start.tv_sec)
+                + (now.tv_usec - m_start.tv_usec) / 1e6;
+        }
+
+    private:
+        struct timeval m_start;
+    };
+
+    enum content
+    {
+        content_noise,      // incompressible
+        content_photo,      // smooth gradients with sensor-like noise
+        content_screenshot, // flat areas, sharp edges, few colors
+        content_line_art    // thin dark lines on white
+    };
+
+    inline char const* content_name(content kind)
+    {
+        switch (kind)
+        {
+        case content_noise: return "noise";
+        case content_photo: return "photo";
+        case content_screenshot: return "screenshot";
+        case content_line_art: return "line-art";
+        }
+        return "?";
+    }
+
+    class random
+    {
+    public:
+        explicit random(unsigned seed = 2463534242u)
+            : m_state(seed ? seed : 1)
+        {
+        }
+
+        unsigned next()
+        {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 17;
+            m_state ^= m_state << 5;
+            return m_state;
+        }
+
+    private:
+        unsigned m_state;
+    };
+
+    /**
+     * \brief Returns the value of the channel \a c of a synthetic
+     * image pixel at (x,y) scaled to 0..255.
+     */
+    inline png::byte sample(content kind, random& rnd,
+                            size_t x, size_t y, size_t c)
+    {
+        switch (kind)
+        {
+        case content_noise:
+            return rnd.next() >> 24;
+        case content_photo:
+            return ((x * (c + 1) + y * (3 - c)) / 8
+                    + (rnd.next() >> 29)) & 0xff;
+        case content_screenshot:
+            if ((x / 64 + y / 24) % 5 == 0)
+            {
+                return (x % 7 == 0 || y % 11 == 0) ? 0 : 40 * c;
+            }
+            return ((x / 200) * 50 + (y / 150) * 30 + c * 60) & 0xff;
+        case content_line_art:
+            return ((x + 2 * y) % 97 < 2 || (3 * x - y) % 131 < 2)
+                ? 0 : 255;
+        }
+        return 0;
+    }
+
+    /**
+     * \brief Fills an image with synthetic content.  Works for the
+     * byte-aligned pixel types.
+     */
+    template< class image >
+    void fill(image& img, content kind, unsigned seed = 1)
+    {
+        typedef typename image::traits traits;
+        random rnd(seed);
+        size_t const channels = traits::get_channels();
+        size_t const bytes = traits::get_bit_depth() / 8;
+        for (size_t y = 0; y < img.get_height(); ++y)
+        {
+            png::byte* row = reinterpret_cast< png::byte* >
+                (& img[y][0]);
+            for (size_t x = 0; x < img.get_width(); ++x)
+            {
+                for (size_t c = 0; c < channels; ++c)
+                {
+                    png::byte v = sample(kind, rnd, x, y, c);
+                    for (size_t b = 0; b < bytes; ++b)
+                    {
+                        *row++ = v;
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * \brief Returns the size of a file in bytes.
+     */
+    inline double file_size(char const* filename)
+    {
+        FILE* file = fopen(filename, "rb");
+        if (!file)
+        {
+            return 0;
+        }
+        fseek(file, 0, SEEK_END);
+        double size = ftell(file);
+        fclose(file);
+        return size;
+    }
+
+} // namespace bench
+
+#endif // PNGPP_BENCH_HPP_INCLUDED
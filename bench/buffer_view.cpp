@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Decodes into a caller-owned frame buffer two ways: into an image
+ * followed by a row-by-row copy, and directly through
+ * pixel_buffer_view.
+ */
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t size = argc > 1 ? atoi(argv[1]) : 1024;
+    int runs = argc > 2 ? atoi(argv[2]) : 10;
+
+    png::image< png::rgba_pixel > source(size, size);
+    bench::fill(source, bench::content_screenshot);
+    std::vector< png::byte > data;
+    png::memory_ostream stream(data);
+    source.write_stream(stream);
+
+    size_t const stride = size * sizeof(png::rgba_pixel);
+    std::vector< png::byte > frame(stride * size);
+
+    bench::timer t;
+    for (int i = 0; i < runs; ++i)
+    {
+        png::memory_istream in(& data[0], data.size());
+        png::image< png::rgba_pixel > image;
+        image.read_stream(in);
+        for (size_t y = 0; y < size; ++y)
+        {
+            std::memcpy(& frame[y * stride], & image[y][0], stride);
+        }
+    }
+    double const copied = t.elapsed() / runs;
+
+    typedef png::pixel_buffer_view< png::rgba_pixel > view;
+    bench::timer t2;
+    for (int i = 0; i < runs; ++i)
+    {
+        png::memory_istream in(& data[0], data.size());
+        png::image< png::rgba_pixel, view > image;
+        image.set_pixbuf(view(reinterpret_cast< png::rgba_pixel* >
+                              (& frame[0]), size, size));
+        image.read_stream(in);
+    }
+    double const direct = t2.elapsed() / runs;
+
+    std::cout << size << "x" << size << " rgba: decode + copy "
+              << copied * 1e3 << " ms, pixel_buffer_view "
+              << direct * 1e3 << " ms (" << (direct * 100 / copied - 100)
+              << "%)" << std::endl;
+}
+catch (std::exception const& error)
+{
+    std::cerr << "buffer_view: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Prints a matrix of encode time against output size for the
+ * compression_profile presets on representative content.
+ */
+
+typedef png::rgb_pixel pixel;
+typedef png::image< pixel, png::solid_pixel_buffer< pixel > > image_type;
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t size = argc > 1 ? atoi(argv[1]) : 1024;
+    int runs = argc > 2 ? atoi(argv[2]) : 3;
+
+    bench::content const kinds[] =
+    {
+        bench::content_photo,
+        bench::content_screenshot,
+        bench::content_line_art
+    };
+    char const* const names[] =
+    {
+        "default", "fastest", "balanced", "smallest"
+    };
+    png::compression_profile const profiles[] =
+    {
+        png::compression_profile(),
+        png::compression_profile::fastest(),
+        png::compression_profile::balanced(),
+        png::compression_profile::smallest()
+    };
+    size_t const count = sizeof(profiles) / sizeof(*profiles);
+
+    std::vector< png::byte > buffer;
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(*kinds); ++k)
+    {
+        image_type image(size, size);
+        bench::fill(image, kinds[k]);
+        for (size_t p = 0; p < count; ++p)
+        {
+            bench::timer t;
+            for (int i = 0; i < runs; ++i)
+            {
+                buffer.clear();
+                png::memory_ostream stream(buffer);
+                image.write_stream(stream, profiles[p]);
+            }
+            double ms = t.elapsed() / runs * 1e3;
+            std::cout << size << "x" << size << " rgb "
+                      << std::setw(12) << std::left
+                      << bench::content_name(kinds[k])
+                      << std::setw(9) << names[p] << std::right
+                      << std::setw(9) << std::fixed << std::setprecision(1)
+                      << ms << " ms " << std::setw(9) << buffer.size()
+                      << " bytes" << std::endl;
+        }
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "compression_profile: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
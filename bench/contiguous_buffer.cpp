@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Compares pixel_buffer, solid_pixel_buffer and
+ * contiguous_pixel_buffer: allocating a buffer, decoding an image
+ * into it and a full traversal summing the pixels.
+ */
+
+template< class buffer >
+void
+run(char const* name, std::vector< png::byte > const& data,
+    size_t size, int runs)
+{
+    bench::timer t;
+    for (int i = 0; i < runs; ++i)
+    {
+        buffer pixels(size, size);
+    }
+    double const alloc = t.elapsed() / runs;
+
+    png::image< png::rgba_pixel, buffer > image;
+    bench::timer t2;
+    for (int i = 0; i < runs; ++i)
+    {
+        png::memory_istream stream(& data[0], data.size());
+        image.read_stream(stream);
+    }
+    double const decode = t2.elapsed() / runs;
+
+    buffer const& pixels = image.get_pixbuf();
+    unsigned long sum = 0;
+    bench::timer t3;
+    for (int i = 0; i < runs * 10; ++i)
+    {
+        for (size_t y = 0; y < pixels.get_height(); ++y)
+        {
+            typename buffer::row_const_access row = pixels[y];
+            for (size_t x = 0; x < pixels.get_width(); ++x)
+            {
+                sum += row[x].red + row[x].green + row[x].blue
+                    + row[x].alpha;
+            }
+        }
+    }
+    double const traverse = t3.elapsed() / (runs * 10);
+
+    std::cout << size << "x" << size << " " << name << ": alloc "
+              << alloc * 1e3 << " ms, decode " << decode * 1e3
+              << " ms, traverse " << traverse * 1e3 << " ms (" << sum
+              << ")" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t size = argc > 1 ? atoi(argv[1]) : 1024;
+    int runs = argc > 2 ? atoi(argv[2]) : 5;
+
+    png::image< png::rgba_pixel > source(size, size);
+    bench::fill(source, bench::content_photo);
+    std::vector< png::byte > data;
+    png::memory_ostream stream(data);
+    source.write_stream(stream);
+
+    run< png::pixel_buffer< png::rgba_pixel > >
+        ("pixel_buffer", data, size, runs);
+    run< png::solid_pixel_buffer< png::rgba_pixel > >
+        ("solid_pixel_buffer", data, size, runs);
+    run< png::contiguous_pixel_buffer< png::rgba_pixel > >
+        ("contiguous_pixel_buffer", data, size, runs);
+}
+catch (std::exception const& error)
+{
+    std::cerr << "contiguous_buffer: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Compares making a thumbnail by decoding the full image and then
+ * box-filtering it with downscale_consumer, which filters the rows as
+ * they are decoded: time, memory held besides the thumbnail and the
+ * largest difference between the two results.
+ */
+
+typedef png::rgb_pixel pixel;
+typedef png::solid_pixel_buffer< pixel > buffer_type;
+
+void
+resize(buffer_type const& src, buffer_type& dst, size_t factor)
+{
+    size_t const width = src.get_width();
+    size_t const height = src.get_height();
+    dst.resize((width + factor - 1) / factor,
+               (height + factor - 1) / factor);
+    std::vector< unsigned > sums(dst.get_width() * 3);
+    for (size_t oy = 0; oy < dst.get_height(); ++oy)
+    {
+        size_t const y_end = (oy + 1) * factor < height
+            ? (oy + 1) * factor : height;
+        for (size_t y = oy * factor; y < y_end; ++y)
+        {
+            pixel const* row = src[y];
+            for (size_t x = 0; x < width; ++x)
+            {
+                unsigned* sum = & sums[x / factor * 3];
+                sum[0] += row[x].red;
+                sum[1] += row[x].green;
+                sum[2] += row[x].blue;
+            }
+        }
+        pixel* out = dst[oy];
+        for (size_t ox = 0; ox < dst.get_width(); ++ox)
+        {
+            size_t const x_end = (ox + 1) * factor < width
+                ? (ox + 1) * factor : width;
+            unsigned count = (y_end - oy * factor) * (x_end - ox * factor);
+            unsigned* sum = & sums[ox * 3];
+            out[ox] = pixel((sum[0] + count / 2) / count,
+                            (sum[1] + count / 2) / count,
+                            (sum[2] + count / 2) / count);
+            sum[0] = sum[1] = sum[2] = 0;
+        }
+    }
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t width = argc > 1 ? atoi(argv[1]) : 4000;
+    size_t height = argc > 2 ? atoi(argv[2]) : 3000;
+    size_t factor = argc > 3 ? atoi(argv[3]) : 8;
+    int runs = argc > 4 ? atoi(argv[4]) : 3;
+
+    std::vector< png::byte > data;
+    {
+        png::image< pixel, buffer_type > source(width, height);
+        bench::fill(source, bench::content_photo);
+        png::memory_ostream stream(data);
+        source.write_stream(stream);
+    }
+
+    buffer_type full;
+    buffer_type reference;
+    bench::timer t;
+    for (int i = 0; i < runs; ++i)
+    {
+        png::image< pixel, buffer_type > image;
+        png::memory_istream stream(& data[0], data.size());
+        image.read_stream(stream);
+        resize(image.get_pixbuf(), reference, factor);
+    }
+    double two_step = t.elapsed() / runs;
+
+    buffer_type thumbnail;
+    t.restart();
+    for (int i = 0; i < runs; ++i)
+    {
+        png::image_info info;
+        png::memory_istream stream(& data[0], data.size());
+        png::downscale_consumer< pixel, buffer_type >
+            con(info, thumbnail, factor);
+        con.read(stream);
+    }
+    double streaming = t.elapsed() / runs;
+
+    int max_diff = 0;
+    for (size_t y = 0; y < thumbnail.get_height(); ++y)
+    {
+        for (size_t x = 0; x < thumbnail.get_width(); ++x)
+        {
+            pixel a = thumbnail[y][x];
+            pixel b = reference[y][x];
+            int d[] = { a.red - b.red, a.green - b.green, a.blue - b.blue };
+            for (int c = 0; c < 3; ++c)
+            {
+                int diff = d[c] < 0 ? -d[c] : d[c];
+                max_diff = diff > max_diff ? diff : max_diff;
+            }
+        }
+    }
+
+    std::cout << width << "x" << height << " rgb, 1/" << factor << std::endl
+              << "decode then resize: " << two_step * 1e3 << " ms, "
+              << width * height * 3 / 1024 << " KB buffered" << std::endl
+              << "downscale_consumer: " << streaming * 1e3 << " ms, "
+              << (width * 3 + (width + factor - 1) / factor * 3 * 4) / 1024
+              << " KB buffered" << std::endl
+              << "max difference: " << max_diff << std::endl;
+}
+catch (std::exception const& error)
+{
+    std::cerr << "downscale: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Reports encode time and output size of write_fast() for every
+ * filter strategy, next to libpng's encoder with its built-in
+ * minimum-sum heuristic over all filters.
+ */
+
+template< typename pixel >
+void
+run(char const* name, bench::content kind, size_t size, int runs)
+{
+    typedef png::image< pixel, png::solid_pixel_buffer< pixel > > image_type;
+    image_type image(size, size);
+    bench::fill(image, kind);
+
+    std::cout << size << "x" << size << " " << name << " "
+              << bench::content_name(kind) << ":" << std::endl;
+
+    std::vector< png::byte > buffer;
+    png::compression_profile profile;
+    profile.set_filters(PNG_ALL_FILTERS);
+    bench::timer t;
+    for (int i = 0; i < runs; ++i)
+    {
+        buffer.clear();
+        png::memory_ostream stream(buffer);
+        image.write_stream(stream, profile);
+    }
+    std::cout << "  libpng all filters  " << t.elapsed() / runs * 1e3
+              << " ms, " << buffer.size() << " bytes" << std::endl;
+
+    struct
+    {
+        char const* name;
+        png::filter_strategy strategy;
+    } const strategies[] =
+    {
+        { "fixed none         ", png::filter_strategy::fixed(PNG_FILTER_VALUE_NONE) },
+        { "fixed up           ", png::filter_strategy::fixed(PNG_FILTER_VALUE_UP) },
+        { "fixed paeth        ", png::filter_strategy::fixed(PNG_FILTER_VALUE_PAETH) },
+        { "min sum            ", png::filter_strategy::min_sum() },
+        { "entropy            ", png::filter_strategy::entropy() },
+        { "reuse previous     ", png::filter_strategy::reuse_previous() }
+    };
+    for (size_t s = 0; s < sizeof(strategies) / sizeof(*strategies); ++s)
+    {
+        bench::timer t;
+        for (int i = 0; i < runs; ++i)
+        {
+            buffer.clear();
+            png::memory_ostream stream(buffer);
+            image.write_fast_stream(stream, strategies[s].strategy);
+        }
+        std::cout << "  " << strategies[s].name << " "
+                  << t.elapsed() / runs * 1e3 << " ms, "
+                  << buffer.size() << " bytes" << std::endl;
+    }
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t size = argc > 1 ? atoi(argv[1]) : 1024;
+    int runs = argc > 2 ? atoi(argv[2]) : 5;
+
+    bench::content const kinds[] =
+    {
+        bench::content_photo,
+        bench::content_screenshot,
+        bench::content_line_art
+    };
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(*kinds); ++k)
+    {
+        run< png::rgb_pixel >("rgb", kinds[k], size, runs);
+        run< png::rgba_pixel >("rgba", kinds[k], size, runs);
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "filter_strategy: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Compares decode throughput of libpng and native_decoder for every
+ * byte-aligned color type and bit depth.
+ */
+
+template< typename pixel >
+void
+run(char const* name, size_t size, int runs)
+{
+    typedef png::image< pixel, png::solid_pixel_buffer< pixel > > image_type;
+
+    std::vector< png::byte > data;
+    {
+        image_type source(size, size);
+        bench::fill(source, bench::content_photo);
+        png::memory_ostream stream(data);
+        source.write_stream(stream);
+    }
+
+    // allocate the pixel buffer outside the timed loops
+    image_type image(size, size);
+    double seconds[2];
+    for (int native = 0; native < 2; ++native)
+    {
+        bench::timer t;
+        for (int i = 0; i < runs; ++i)
+        {
+            png::memory_istream stream(& data[0], data.size());
+            if (native)
+            {
+                image.read_stream(stream, png::native_decoding<>());
+            }
+            else
+            {
+                image.read_stream(stream,
+                                  typename image_type::transform_identity());
+            }
+        }
+        seconds[native] = t.elapsed() / runs;
+    }
+    double const mpixels = size * size / 1e6;
+    std::cout << size << "x" << size << " " << name << ": libpng "
+              << mpixels / seconds[0] << " Mpixel/s, native "
+              << mpixels / seconds[1] << " Mpixel/s" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t size = argc > 1 ? atoi(argv[1]) : 2048;
+    int runs = argc > 2 ? atoi(argv[2]) : 5;
+
+    run< png::gray_pixel >("gray", size, runs);
+    run< png::ga_pixel >("ga", size, runs);
+    run< png::rgb_pixel >("rgb", size, runs);
+    run< png::rgba_pixel >("rgba", size, runs);
+    run< png::gray_pixel_16 >("gray-16", size, runs);
+    run< png::ga_pixel_16 >("ga-16", size, runs);
+    run< png::rgb_pixel_16 >("rgb-16", size, runs);
+    run< png::rgba_pixel_16 >("rgba-16", size, runs);
+}
+catch (std::exception const& error)
+{
+    std::cerr << "native_decode: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
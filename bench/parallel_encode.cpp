@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Measures how write_parallel() scales from one thread up to the
+ * number of hardware threads, compared with libpng's encoder at the
+ * same compression profile.
+ */
+
+template< typename pixel >
+void
+run(char const* name, bench::content kind, size_t size, int runs,
+    size_t max_threads, png::compression_profile const& profile)
+{
+    typedef png::image< pixel, png::solid_pixel_buffer< pixel > > image_type;
+    image_type image(size, size);
+    bench::fill(image, kind);
+
+    std::vector< png::byte > buffer;
+    bench::timer t;
+    for (int i = 0; i < runs; ++i)
+    {
+        buffer.clear();
+        png::memory_ostream stream(buffer);
+        image.write_stream(stream, profile);
+    }
+    double const base = t.elapsed() / runs;
+    std::cout << size << "x" << size << " " << name << " "
+              << bench::content_name(kind) << ": libpng "
+              << base * 1e3 << " ms, " << buffer.size() << " bytes"
+              << std::endl;
+
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        bench::timer t;
+        for (int i = 0; i < runs; ++i)
+        {
+            buffer.clear();
+            png::memory_ostream stream(buffer);
+            image.write_parallel_stream(stream, threads, profile);
+        }
+        double const seconds = t.elapsed() / runs;
+        std::cout << "  " << threads << " thread(s): "
+                  << seconds * 1e3 << " ms, " << buffer.size() << " bytes ("
+                  << base / seconds << "x)" << std::endl;
+    }
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t size = argc > 1 ? atoi(argv[1]) : 2048;
+    int runs = argc > 2 ? atoi(argv[2]) : 3;
+    size_t max_threads = argc > 3 ? atoi(argv[3])
+        : png::thread_pool().get_thread_count();
+
+    png::compression_profile const profile
+        = png::compression_profile::balanced();
+    run< png::rgb_pixel >("rgb", bench::content_photo, size, runs,
+                          max_threads, profile);
+    run< png::rgba_pixel >("rgba", bench::content_screenshot, size, runs,
+                           max_threads, profile);
+}
+catch (std::exception const& error)
+{
+    std::cerr << "parallel_encode: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
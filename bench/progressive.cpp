@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Measures the time to the preview after each Adam7 pass of a large
+ * interlaced image, i.e. what stopping there saves over a full
+ * decode.
+ */
+
+typedef png::rgb_pixel pixel;
+typedef png::image< pixel, png::solid_pixel_buffer< pixel > > image_type;
+
+struct stop_after
+{
+    explicit stop_after(size_t last)
+        : m_last(last)
+    {
+    }
+
+    bool operator()(image_type::preview const& preview) const
+    {
+        return preview.get_pass() < m_last;
+    }
+
+    size_t m_last;
+};
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t size = argc > 1 ? atoi(argv[1]) : 2048;
+    int runs = argc > 2 ? atoi(argv[2]) : 3;
+
+    std::vector< png::byte > data;
+    {
+        image_type source(size, size);
+        bench::fill(source, bench::content_photo);
+        source.set_interlace_type(png::interlace_adam7);
+        png::memory_ostream stream(data);
+        source.write_stream(stream);
+    }
+
+    std::cout << size << "x" << size << " rgb, interlaced" << std::endl;
+    for (size_t pass = 0; pass < png::adam7::pass_count; ++pass)
+    {
+        stop_after callback(pass);
+        image_type image;
+        bench::timer t;
+        for (int i = 0; i < runs; ++i)
+        {
+            png::memory_istream stream(& data[0], data.size());
+            image.read_progressive_stream(stream, callback);
+        }
+        std::cout << "preview after pass " << pass + 1 << ": "
+                  << t.elapsed() / runs * 1e3 << " ms" << std::endl;
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "progressive: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Measures quantizer speed and quality (PSNR over the four
+ * channels) against image size, with and without dithering, and
+ * compares the size of the written files with the truecolor ones.
+ */
+
+typedef png::image< png::rgba_pixel, png::solid_pixel_buffer< png::rgba_pixel > >
+    rgba_image;
+typedef png::image< png::index_pixel > index_image;
+
+double
+get_psnr(rgba_image const& src, index_image const& dst)
+{
+    png::palette const& plte = dst.get_palette();
+    png::tRNS const& trns = dst.get_tRNS();
+    double error = 0;
+    for (size_t y = 0; y < src.get_height(); ++y)
+    {
+        for (size_t x = 0; x < src.get_width(); ++x)
+        {
+            png::rgba_pixel const p = src.get_pixel(x, y);
+            size_t const i = dst.get_pixel(x, y);
+            int const a = i < trns.size() ? trns[i] : 255;
+            int const d[4] = { p.red - plte[i].red, p.green - plte[i].green,
+                               p.blue - plte[i].blue, p.alpha - a };
+            for (size_t k = 0; k < 4; ++k)
+            {
+                error += d[k] * d[k];
+            }
+        }
+    }
+    error /= 4.0 * src.get_width() * src.get_height();
+    return error == 0 ? INFINITY : 10 * std::log10(255.0 * 255.0 / error);
+}
+
+void
+run(bench::content kind, size_t size, size_t threads, bool dither)
+{
+    rgba_image src(size, size);
+    bench::fill(src, kind);
+    // opaque, as most UI assets and photos are
+    for (size_t y = 0; y < size; ++y)
+    {
+        for (size_t x = 0; x < size; ++x)
+        {
+            src[y][x].alpha = 255;
+        }
+    }
+
+    png::quantizer quant;
+    quant.set_thread_count(threads);
+    quant.set_dither(dither);
+    index_image dst;
+    bench::timer t;
+    quant.quantize(src, dst);
+    double const seconds = t.elapsed();
+
+    std::vector< png::byte > truecolor;
+    png::memory_ostream truecolor_out(truecolor);
+    bench::timer t_rgba;
+    src.write_stream(truecolor_out);
+    double const rgba_seconds = t_rgba.elapsed();
+    std::vector< png::byte > indexed;
+    png::memory_ostream indexed_out(indexed);
+    bench::timer t_index;
+    dst.write_stream(indexed_out);
+    double const index_seconds = t_index.elapsed();
+
+    std::cout << size << "x" << size << " " << bench::content_name(kind)
+              << " threads " << threads << (dither ? " dither" : "")
+              << ": " << seconds * 1e3 << " ms, PSNR " << get_psnr(src, dst)
+              << " dB, " << dst.get_palette().size() << " colors; rgba "
+              << truecolor.size() << " bytes in " << rgba_seconds * 1e3
+              << " ms, indexed " << indexed.size() << " bytes in "
+              << index_seconds * 1e3 << " ms" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t max_size = argc > 1 ? atoi(argv[1]) : 2048;
+    size_t threads = argc > 2 ? atoi(argv[2]) : 0;
+
+    bench::content const kinds[] =
+    {
+        bench::content_photo,
+        bench::content_screenshot
+    };
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(*kinds); ++k)
+    {
+        for (size_t size = 256; size <= max_size; size *= 2)
+        {
+            run(kinds[k], size, 1, false);
+            run(kinds[k], size, 1, true);
+            if (threads != 1)
+            {
+                run(kinds[k], size, threads, true);
+            }
+        }
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "quantize: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
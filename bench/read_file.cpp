@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Compares image::read() through std::ifstream with the
+ * memory-mapped file path.  The test image is generated once and
+ * reused by subsequent runs.
+ */
+
+typedef png::image< png::rgba_pixel, png::solid_pixel_buffer< png::rgba_pixel > >
+    image_type;
+
+void
+read_ifstream(char const* filename, image_type& image)
+{
+    std::ifstream stream(filename, std::ios::binary);
+    if (!stream.is_open())
+    {
+        throw png::std_error(filename);
+    }
+    stream.exceptions(std::ios::badbit);
+    image.read_stream(stream);
+}
+
+#ifdef PNGPP_HAS_MMAP
+void
+read_mapped(char const* filename, image_type& image)
+{
+    png::mapped_file file(filename);
+    png::memory_istream stream(file.get_data(), file.get_size());
+    image.read_stream(stream);
+}
+#endif
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t width = argc > 1 ? atoi(argv[1]) : 8192;
+    size_t height = argc > 2 ? atoi(argv[2]) : 8192;
+    int runs = argc > 3 ? atoi(argv[3]) : 3;
+    char const* filename = "read_file.png.out";
+
+    if (bench::file_size(filename) == 0)
+    {
+        image_type image(width, height);
+        bench::fill(image, bench::content_noise);
+        image.write(filename);
+    }
+    double mb = bench::file_size(filename) / (1024 * 1024);
+    std::cout << "file: " << filename << ", " << mb << " MB" << std::endl;
+
+    image_type image;
+    for (int i = 0; i < runs; ++i)
+    {
+        bench::timer t;
+        read_ifstream(filename, image);
+        double s = t.elapsed();
+        std::cout << "ifstream: " << s << " s, "
+                  << mb / s << " MB/s" << std::endl;
+#ifdef PNGPP_HAS_MMAP
+        t.restart();
+        read_mapped(filename, image);
+        s = t.elapsed();
+        std::cout << "mmap:     " << s << " s, "
+                  << mb / s << " MB/s" << std::endl;
+#endif
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "read_file: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Compares reading and writing an image one row per call
+ * (get_next_row), in blocks of rows (get_next_rows, handed to
+ * png_read_rows()/png_write_rows()) and all at once (get_image_rows,
+ * handed to png_read_image()/png_write_image()).
+ */
+
+typedef png::gray_pixel pixel;
+
+enum
+{
+    mode_rows,
+    mode_blocks,
+    mode_image
+};
+typedef png::solid_pixel_buffer< pixel > buffer_type;
+
+template< int mode >
+class row_consumer
+    : public png::consumer< pixel, row_consumer< mode > >
+{
+public:
+    row_consumer(png::image_info& info, buffer_type& pixels)
+        : png::consumer< pixel, row_consumer< mode > >(info),
+          m_pixels(pixels)
+    {
+    }
+
+    void reset(size_t)
+    {
+        m_pixels.resize(this->get_info().get_width(),
+                        this->get_info().get_height());
+    }
+
+    png::byte* get_next_row(size_t pos)
+    {
+        return reinterpret_cast< png::byte* >(m_pixels[pos]);
+    }
+
+    size_t get_next_rows(size_t pos, size_t count, png::byte** rows)
+    {
+        if (mode != mode_blocks)
+        {
+            return 0;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            rows[i] = reinterpret_cast< png::byte* >(m_pixels[pos + i]);
+        }
+        return count;
+    }
+
+    png::byte** get_image_rows()
+    {
+        if (mode != mode_image)
+        {
+            return 0;
+        }
+        m_rows.resize(m_pixels.get_height());
+        for (size_t i = 0; i < m_rows.size(); ++i)
+        {
+            m_rows[i] = reinterpret_cast< png::byte* >(m_pixels[i]);
+        }
+        return & m_rows[0];
+    }
+
+private:
+    buffer_type& m_pixels;
+    std::vector< png::byte* > m_rows;
+};
+
+template< int mode >
+class row_generator
+    : public png::generator< pixel, row_generator< mode > >
+{
+public:
+    explicit row_generator(buffer_type& pixels)
+        : png::generator< pixel, row_generator< mode > >
+              (pixels.get_width(), pixels.get_height()),
+          m_pixels(pixels)
+    {
+    }
+
+    png::byte* get_next_row(size_t pos)
+    {
+        return reinterpret_cast< png::byte* >(m_pixels[pos]);
+    }
+
+    size_t get_next_rows(size_t pos, size_t count, png::byte** rows)
+    {
+        if (mode != mode_blocks)
+        {
+            return 0;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            rows[i] = reinterpret_cast< png::byte* >(m_pixels[pos + i]);
+        }
+        return count;
+    }
+
+    png::byte** get_image_rows()
+    {
+        if (mode != mode_image)
+        {
+            return 0;
+        }
+        m_rows.resize(m_pixels.get_height());
+        for (size_t i = 0; i < m_rows.size(); ++i)
+        {
+            m_rows[i] = reinterpret_cast< png::byte* >(m_pixels[i]);
+        }
+        return & m_rows[0];
+    }
+
+private:
+    buffer_type& m_pixels;
+    std::vector< png::byte* > m_rows;
+};
+
+template< int mode >
+void
+run(png::image< pixel, buffer_type >& image, int runs)
+{
+    std::vector< png::byte > data;
+    buffer_type pixels;
+    png::image_info info;
+
+    bench::timer t;
+    for (int i = 0; i < runs; ++i)
+    {
+        data.clear();
+        png::memory_ostream stream(data);
+        row_generator< mode > gen(image.get_pixbuf());
+        gen.write(stream);
+    }
+    double write = t.elapsed() / runs;
+
+    t.restart();
+    for (int i = 0; i < runs; ++i)
+    {
+        png::memory_istream stream(& data[0], data.size());
+        row_consumer< mode > con(info, pixels);
+        con.read(stream);
+    }
+    double read = t.elapsed() / runs;
+
+    char const* const names[] = { "rows:   ", "blocks: ", "image:  " };
+    std::cout << names[mode]
+              << "write " << write * 1e3 << " ms, "
+              << "read " << read * 1e3 << " ms" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t width = argc > 1 ? atoi(argv[1]) : 16;
+    size_t height = argc > 2 ? atoi(argv[2]) : 65536;
+    int runs = argc > 3 ? atoi(argv[3]) : 20;
+
+    png::image< pixel, buffer_type > image(width, height);
+    bench::fill(image, bench::content_photo);
+
+    std::cout << width << "x" << height << " gray" << std::endl;
+    run< mode_rows >(image, runs);
+    run< mode_blocks >(image, runs);
+    run< mode_image >(image, runs);
+}
+catch (std::exception const& error)
+{
+    std::cerr << "row_blocks: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Measures the per-image cost of encoding and decoding icon-sized
+ * images with and without a memory_cache recycling libpng and zlib
+ * memory between images.
+ */
+
+typedef png::rgba_pixel pixel;
+typedef png::image< pixel, png::solid_pixel_buffer< pixel > > image_type;
+
+void
+run(size_t size, int runs, bool cached)
+{
+    image_type image(size, size);
+    bench::fill(image, bench::content_screenshot);
+    std::vector< png::byte > buffer;
+
+    png::memory_cache cache;
+
+    bench::timer t;
+    for (int i = 0; i < runs; ++i)
+    {
+        buffer.clear();
+        png::memory_ostream stream(buffer);
+        if (cached)
+        {
+            png::memory_cache::scope use_cache(cache);
+            image.write_stream(stream);
+        }
+        else
+        {
+            image.write_stream(stream);
+        }
+    }
+    double encode = t.elapsed() / runs;
+
+    image_type decoded;
+    t.restart();
+    for (int i = 0; i < runs; ++i)
+    {
+        png::memory_istream stream(& buffer[0], buffer.size());
+        if (cached)
+        {
+            png::memory_cache::scope use_cache(cache);
+            decoded.read_stream(stream);
+        }
+        else
+        {
+            decoded.read_stream(stream);
+        }
+    }
+    double decode = t.elapsed() / runs;
+
+    std::cout << size << "x" << size
+              << (cached ? " cached:   " : " uncached: ")
+              << "encode " << encode * 1e6 << " us, "
+              << "decode " << decode * 1e6 << " us" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    int runs = argc > 1 ? atoi(argv[1]) : 2000;
+    for (size_t size = 32; size <= 256; size *= 2)
+    {
+        run(size, runs, false);
+        run(size, runs, true);
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "small_images: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
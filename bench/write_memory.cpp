@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Compares encoding into std::ostringstream (plus the final str()
+ * copy) with encoding into a reused vector through memory_ostream.
+ */
+
+typedef png::image< png::rgb_pixel, png::solid_pixel_buffer< png::rgb_pixel > >
+    image_type;
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t size = argc > 1 ? atoi(argv[1]) : 256;
+    int runs = argc > 2 ? atoi(argv[2]) : 200;
+
+    image_type image(size, size);
+    bench::fill(image, bench::content_screenshot);
+
+    size_t bytes = 0;
+    bench::timer t;
+    for (int i = 0; i < runs; ++i)
+    {
+        std::ostringstream stream;
+        image.write_stream(stream);
+        std::string data = stream.str();
+        bytes = data.size();
+    }
+    double s = t.elapsed();
+    std::cout << "ostringstream: " << s / runs * 1e3 << " ms/image, "
+              << bytes << " bytes" << std::endl;
+
+    std::vector< png::byte > buffer;
+    t.restart();
+    for (int i = 0; i < runs; ++i)
+    {
+        buffer.clear();
+        png::memory_ostream stream(buffer);
+        image.write_stream(stream);
+    }
+    s = t.elapsed();
+    std::cout << "memory_ostream: " << s / runs * 1e3 << " ms/image, "
+              << buffer.size() << " bytes" << std::endl;
+}
+catch (std::exception const& error)
+{
+    std::cerr << "write_memory: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Compares write_optimized() with a default write() in time and
+ * output size, with and without a time budget, and prints the
+ * chosen compression parameters.
+ */
+
+template< typename pixel >
+void
+run(char const* name, bench::content kind, size_t size,
+    png::optimize_options const& options)
+{
+    typedef png::image< pixel, png::solid_pixel_buffer< pixel > > image_type;
+    image_type image(size, size);
+    bench::fill(image, kind);
+
+    std::vector< png::byte > buffer;
+    bench::timer t;
+    {
+        png::memory_ostream stream(buffer);
+        image.write_stream(stream);
+    }
+    double const base = t.elapsed();
+    size_t const base_size = buffer.size();
+
+    buffer.clear();
+    bench::timer t2;
+    png::memory_ostream stream(buffer);
+    png::optimize_report report
+        = image.write_optimized_stream(stream, options);
+    double const seconds = t2.elapsed();
+
+    std::cout << size << "x" << size << " " << name << " "
+              << bench::content_name(kind) << ": default "
+              << base * 1e3 << " ms, " << base_size << " bytes; optimized "
+              << seconds * 1e3 << " ms, " << report.size << " bytes ("
+              << (report.size * 100.0 / base_size - 100) << "%), "
+              << report.trials << " trials, " << report.skipped
+              << " skipped; level " << report.profile.get_level()
+              << " strategy " << report.profile.get_strategy()
+              << " filters 0x" << std::hex << report.profile.get_filters()
+              << std::dec << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t size = argc > 1 ? atoi(argv[1]) : 512;
+    size_t threads = argc > 2 ? atoi(argv[2]) : 0;
+    size_t budget = argc > 3 ? atoi(argv[3]) : 0;
+
+    png::optimize_options options;
+    options.set_thread_count(threads);
+    options.set_time_budget(budget);
+
+    bench::content const kinds[] =
+    {
+        bench::content_photo,
+        bench::content_screenshot,
+        bench::content_line_art
+    };
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(*kinds); ++k)
+    {
+        run< png::rgb_pixel >("rgb", kinds[k], size, options);
+        run< png::rgba_pixel >("rgba", kinds[k], size, options);
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "write_optimized: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+#include "bench.hpp"
+
+/*
+ * Compares write() with write_reduced() in time and output size and
+ * prints the reduced color type and bit depth.
+ */
+
+template< typename pixel >
+void
+run(char const* name, bench::content kind, size_t size, int runs)
+{
+    typedef png::image< pixel, png::solid_pixel_buffer< pixel > > image_type;
+    image_type image(size, size);
+    bench::fill(image, kind);
+
+    std::vector< png::byte > buffer;
+    bench::timer t;
+    for (int i = 0; i < runs; ++i)
+    {
+        buffer.clear();
+        png::memory_ostream stream(buffer);
+        image.write_stream(stream);
+    }
+    double const base = t.elapsed() / runs;
+    size_t const base_size = buffer.size();
+
+    png::image_info info;
+    bench::timer t2;
+    for (int i = 0; i < runs; ++i)
+    {
+        buffer.clear();
+        png::memory_ostream stream(buffer);
+        info = image.write_reduced_stream(stream);
+    }
+    double const seconds = t2.elapsed() / runs;
+
+    std::cout << size << "x" << size << " " << name << " "
+              << bench::content_name(kind) << ": write "
+              << base * 1e3 << " ms, " << base_size << " bytes; reduced "
+              << seconds * 1e3 << " ms, " << buffer.size() << " bytes ("
+              << (buffer.size() * 100.0 / base_size - 100) << "%) as color "
+              << info.get_color_type() << " depth " << info.get_bit_depth()
+              << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    size_t size = argc > 1 ? atoi(argv[1]) : 1024;
+    int runs = argc > 2 ? atoi(argv[2]) : 3;
+
+    bench::content const kinds[] =
+    {
+        bench::content_photo,
+        bench::content_screenshot,
+        bench::content_line_art
+    };
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(*kinds); ++k)
+    {
+        run< png::rgb_pixel >("rgb", kinds[k], size, runs);
+        run< png::rgba_pixel >("rgba", kinds[k], size, runs);
+        run< png::rgba_pixel_16 >("rgba16", kinds[k], size, runs);
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "write_reduced: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_COMPRESSION_PROFILE_HPP_INCLUDED
+#define PNGPP_COMPRESSION_PROFILE_HPP_INCLUDED
+
+#include <cstddef>
+#include <zlib.h>
+#include <png.h>
+
+namespace png
+{
+
+    /**
+     * \brief zlib compression strategies, see deflateInit2().
+     */
+    enum compression_strategy
+    {
+        strategy_default      = Z_DEFAULT_STRATEGY,
+        strategy_filtered     = Z_FILTERED,
+        strategy_huffman_only = Z_HUFFMAN_ONLY,
+        strategy_rle          = Z_RLE,
+        strategy_fixed        = Z_FIXED
+    };
+
+    /**
+     * \brief Compression settings for writing PNG images.
+     *
+     * Bundles the zlib compression level, strategy, window size and
+     * memory level, the size of the IDAT buffer and the set of row
+     * filters libpng chooses from (a combination of the \c
+     * PNG_FILTER_* flags).  A default-constructed profile changes
+     * nothing; set the fields you care about, or start from one of
+     * the presets:
+     *
+     * \code
+     * image.write("thumb.png", png::compression_profile::fastest());
+     *
+     * png::compression_profile profile
+     *     = png::compression_profile::smallest();
+     * profile.set_filters(PNG_FILTER_PAETH);
+     * image.write("archive.png", profile);
+     * \endcode
+     *
+     * \see writer::set_compression_profile(), generator::write(),
+     * image::write()
+     */
+    class compression_profile
+    {
+    public:
+        /**
+         * \brief Marks a field left at the libpng default.
+         */
+        static int const keep_default = -1;
+
+        compression_profile()
+            : m_level(keep_default),
+              m_strategy(keep_default),
+              m_window_bits(keep_default),
+              m_mem_level(keep_default),
+              m_filters(keep_default),
+              m_buffer_size(0)
+        {
+        }
+
+        /**
+         * \brief Favours speed: zlib level 1 with run-length
+         * matching and the Up filter for every row, which leaves
+         * libpng nothing to choose.
+         */
+        static compression_profile fastest()
+        {
+            compression_profile profile;
+            profile.set_level(1);
+            profile.set_strategy(strategy_rle);
+            profile.set_filters(PNG_FILTER_UP);
+            profile.set_buffer_size(64 * 1024);
+            return profile;
+        }
+
+        /**
+         * \brief A compromise between speed and size: zlib level 4
+         * and a per-row choice between the Sub, Up and Paeth filters.
+         */
+        static compression_profile balanced()
+        {
+            compression_profile profile;
+            profile.set_level(4);
+            profile.set_strategy(strategy_filtered);
+            profile.set_filters(PNG_FILTER_SUB | PNG_FILTER_UP
+                                | PNG_FILTER_PAETH);
+            profile.set_buffer_size(64 * 1024);
+            return profile;
+        }
+
+        /**
+         * \brief Favours size: zlib level 9 with the largest window
+         * and memory level, and all filters.
+         */
+        static compression_profile smallest()
+        {
+            compression_profile profile;
+            profile.set_level(9);
+            profile.set_strategy(strategy_filtered);
+            profile.set_window_bits(15);
+            profile.set_mem_level(9);
+            profile.set_filters(PNG_ALL_FILTERS);
+            profile.set_buffer_size(64 * 1024);
+            return profile;
+        }
+
+        /**
+         * \brief Returns the zlib compression level (0 to 9).
+         */
+        int get_level() const
+        {
+            return m_level;
+        }
+
+        void set_level(int level)
+        {
+            m_level = level;
+        }
+
+        /**
+         * \brief Returns the zlib strategy, a compression_strategy.
+         */
+        int get_strategy() const
+        {
+            return m_strategy;
+        }
+
+        void set_strategy(int strategy)
+        {
+            m_strategy = strategy;
+        }
+
+        /**
+         * \brief Returns the base two logarithm of the zlib window
+         * size (8 to 15).
+         */
+        int get_window_bits() const
+        {
+            return m_window_bits;
+        }
+
+        void set_window_bits(int bits)
+        {
+            m_window_bits = bits;
+        }
+
+        /**
+         * \brief Returns the zlib memory level (1 to 9).
+         */
+        int get_mem_level() const
+        {
+            return m_mem_level;
+        }
+
+        void set_mem_level(int level)
+        {
+            m_mem_level = level;
+        }
+
+        /**
+         * \brief Returns the row filters libpng may use, a
+         * combination of the \c PNG_FILTER_* flags.
+         */
+        int get_filters() const
+        {
+            return m_filters;
+        }
+
+        void set_filters(int filters)
+        {
+            m_filters = filters;
+        }
+
+        /**
+         * \brief Returns the size of the buffer collecting
+         * compressed data for IDAT chunks, 0 for the default.
+         */
+        size_t get_buffer_size() const
+        {
+            return m_buffer_size;
+        }
+
+        void set_buffer_size(size_t size)
+        {
+            m_buffer_size = size;
+        }
+
+    private:
+        int m_level;
+        int m_strategy;
+        int m_window_bits;
+        int m_mem_level;
+        int m_filters;
+        size_t m_buffer_size;
+    };
+
+} // namespace png
+
+#endif // PNGPP_COMPRESSION_PROFILE_HPP_INCLUDED
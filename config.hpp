@@ -62,6 +62,29 @@
 
 #endif
 
+// POSIX file descriptors and memory-mapped files (mmap/madvise)
+#if defined(__unix__) || defined(__APPLE__)
+#define PNGPP_HAS_POSIX_IO
+#define PNGPP_HAS_MMAP
+#endif
+
+// Thread-local storage for plain (POD) variables
+#if defined(__GNUC__)
+#define PNGPP_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define PNGPP_THREAD_LOCAL __declspec(thread)
+#elif __cplusplus >= 201103L
+#define PNGPP_THREAD_LOCAL thread_local
+#else
+#error Thread-local storage could not be detected.
+#endif
+
+// SSE2 intrinsics (define PNGPP_NO_SIMD to use plain C++ code only)
+#if !defined(PNGPP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PNGPP_HAS_SSE2
+#endif
+
 // Determine C++11 features
 #if defined(__GNUC__) && defined(__GNUC_MINOR__) && defined(__GNUC_PATCHLEVEL__) && defined(__GXX_EXPERIMENTAL_CXX0X__)
 
@@ -79,6 +102,11 @@
 #define PNGPP_HAS_STD_MOVE
 #endif
 
+// gcc supports std::thread, std::future and lambdas since 4.7
+#if (PNGPP_GCC_VERSION >= 40700)
+#define PNGPP_HAS_STD_THREAD
+#endif
+
 #undef PNGPP_GCC_VERSION
 
 #elif defined(_MSC_VER)
@@ -90,6 +118,11 @@
 #define PNGPP_HAS_STD_MOVE
 #endif
 
+// ...and std::thread since VS2012
+#if (_MSC_VER >= 1700)
+#define PNGPP_HAS_STD_THREAD
+#endif
+
 #endif
 
 
@@ -40,6 +40,8 @@
 #include "error.hpp"
 #include "streaming_base.hpp"
 #include "reader.hpp"
+#include "trusted_input.hpp"
+#include "native_decoder.hpp"
 #include "pixel_buffer.hpp"
 
 namespace png
@@ -89,6 +91,58 @@ namespace png
      * any calls to \c get_next_row().  The value of \c 0 is passed
      * for the \c pass number.
      *
+     * To save the per-call overhead (a \c setjmp() and a call into
+     * libpng for every row) a %consumer may also implement the
+     * optional \c get_next_rows() method:
+     *
+     * \code
+     * size_t get_next_rows(size_t pos, size_t count, png::byte** rows);
+     * \endcode
+     *
+     * It is asked for up to \c count rows starting at \c pos and
+     * should store their addresses into \c rows and return the
+     * number of rows stored, all of which are then read in one go.
+     * Returning \c 0 makes the %consumer fall back to \c
+     * get_next_row() for the row at \c pos; the default
+     * implementation always does.
+     *
+     * A %consumer that can list the rows of the whole %image at once
+     * may implement the optional \c get_image_rows() method, which
+     * is called after \c reset(0) and returns a table of the
+     * starting addresses of all rows, or \c NULL to read row by row:
+     *
+     * \code
+     * png::byte** get_image_rows();
+     * \endcode
+     *
+     * With a table the whole %image, interlace passes included, is
+     * read by a single call to libpng, and \c get_next_row(), \c
+     * get_next_rows(), \c finish_row(), \c finish_pass() and \c
+     * reset() for passes other than 0 are not called at all.
+     *
+     * The optional \c finish_row() method is called once the row at
+     * \c pos has been read (for rows read in a block, after the
+     * whole block):
+     *
+     * \code
+     * bool finish_row(size_t pos);
+     * \endcode
+     *
+     * Returning \c false stops reading: the rest of the %image data,
+     * including any further interlace passes and the chunks after
+     * it, is neither inflated nor checked.  The default
+     * implementation always returns \c true.
+     *
+     * Likewise, the optional \c finish_pass() method is called at
+     * the end of every pass--once for non-interlaced images, seven
+     * times for Adam7 ones--and may return \c false to stop reading,
+     * e.g. once a preview of an interlaced %image is good enough
+     * (see adam7_preview):
+     *
+     * \code
+     * bool finish_pass(size_t pass);
+     * \endcode
+     *
      * An optional template parameter \c info_holder encapsulates
      * image_info storage policy.  Using def_image_info_holder results
      * in image_info object stored as a sub-object of the consumer
@@ -158,6 +212,7 @@ namespace png
         void read(istream& stream, transformation const& transform)
         {
             reader< istream > rd(stream);
+            detail::prepare_reader(rd, transform);
             rd.read_info();
             transform(rd);
 
@@ -203,9 +258,40 @@ namespace png
                 skip_interlaced_rows(rd, pass_count);
                 pass_count = 1;
             }
-            read_rows(rd, pass_count, pixel_con);
+            if (read_rows(rd, pass_count, pixel_con))
+            {
+                rd.read_end_info();
+            }
+        }
 
-            rd.read_end_info();
+        /**
+         * \brief Reads an image from the stream with native_decoder
+         * if the image is not interlaced and already has the %color
+         * type and bit depth of \c pixel, with libpng and the wrapped
+         * transformation otherwise.
+         *
+         * \see native_decoding
+         */
+        template< typename istream, class transformation >
+        void read(istream& stream,
+                  native_decoding< transformation > const& transform)
+        {
+            native_decoder< istream > decoder(stream);
+            if (decoder.read_info()
+                && decoder.can_decode(traits::get_color_type(),
+                                      traits::get_bit_depth()))
+            {
+                this->get_info() = decoder.get_image_info();
+                if (read_rows(decoder, 1, static_cast< pixcon* >(this)))
+                {
+                    decoder.read_end_info();
+                }
+                return;
+            }
+            detail::replay_istream< istream >
+                replay(decoder.get_header_data(), decoder.get_header_size(),
+                       stream);
+            read(replay, transform.get_transformation());
         }
 
     protected:
@@ -234,19 +320,60 @@ namespace png
             }
         }
 
-        template< typename istream >
-        void read_rows(reader< istream >& rd, size_t pass_count,
+        /*
+         * Returns false if the consumer stopped reading early.  Works
+         * with both reader and native_decoder.
+         */
+        template< class reader_type >
+        bool read_rows(reader_type& rd, size_t pass_count,
                        pixcon* pixel_con)
         {
+            size_t const height = this->get_info().get_height();
+            byte* rows[base::rows_per_block];
             for (size_t pass = 0; pass < pass_count; ++pass)
             {
                 pixel_con->reset(pass);
 
-                for (size_t pos = 0; pos < this->get_info().get_height(); ++pos)
+                if (pass == 0)
+                {
+                    if (byte** image_rows = pixel_con->get_image_rows())
+                    {
+                        rd.read_image(image_rows);
+                        return true;
+                    }
+                }
+
+                for (size_t pos = 0; pos < height; )
+                {
+                    size_t count = height - pos < base::rows_per_block
+                        ? height - pos : base::rows_per_block;
+                    count = pixel_con->get_next_rows(pos, count, rows);
+                    if (count)
+                    {
+                        rd.read_rows(rows, count);
+                    }
+                    else
+                    {
+                        rd.read_row(pixel_con->get_next_row(pos));
+                        count = 1;
+                    }
+                    bool more = true;
+                    for (size_t end = pos + count; pos < end; ++pos)
+                    {
+                        more = pixel_con->finish_row(pos) && more;
+                    }
+                    if (!more)
+                    {
+                        return false;
+                    }
+                }
+
+                if (!pixel_con->finish_pass(pass))
                 {
-                    rd.read_row(pixel_con->get_next_row(pos));
+                    return false;
                 }
             }
+            return true;
         }
     };
 
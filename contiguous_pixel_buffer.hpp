@@ -0,0 +1,412 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_CONTIGUOUS_PIXEL_BUFFER_HPP_INCLUDED
+#define PNGPP_CONTIGUOUS_PIXEL_BUFFER_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "config.hpp"
+#include "memory_resource.hpp"
+#include "packed_pixel.hpp"
+#include "pixel_traits.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief A non-owning view of a row of pixels.
+     *
+     * Offers the element access and iteration interface of
+     * std::vector (size(), operator[], at(), begin(), end(), data(),
+     * ...) without owning the pixels, so code written for the rows
+     * of pixel_buffer works unchanged.  Use \c row_view< pixel const
+     * > for read-only access.
+     */
+    template< typename pixel >
+    class row_view
+    {
+    public:
+        typedef pixel value_type;
+        typedef pixel& reference;
+        typedef pixel const& const_reference;
+        typedef pixel* pointer;
+        typedef pixel* iterator;
+        typedef pixel const* const_iterator;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        row_view()
+            : m_data(0),
+              m_size(0)
+        {
+        }
+
+        row_view(pixel* data, size_t size)
+            : m_data(data),
+              m_size(size)
+        {
+        }
+
+        /**
+         * \brief Converts a mutable view to a read-only one.
+         */
+        template< typename other >
+        row_view(row_view< other > const& view)
+            : m_data(view.data()),
+              m_size(view.size())
+        {
+        }
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        pixel* data() const
+        {
+            return m_data;
+        }
+
+        pixel& operator[](size_t index) const
+        {
+            return m_data[index];
+        }
+
+        /**
+         * \brief The checking version of operator[]: throws
+         * std::out_of_range if \a index is not less than size().
+         */
+        pixel& at(size_t index) const
+        {
+            if (index >= m_size)
+            {
+                throw std::out_of_range("row_view::at");
+            }
+            return m_data[index];
+        }
+
+        pixel& front() const
+        {
+            return m_data[0];
+        }
+
+        pixel& back() const
+        {
+            return m_data[m_size - 1];
+        }
+
+        pixel* begin() const
+        {
+            return m_data;
+        }
+
+        pixel* end() const
+        {
+            return m_data + m_size;
+        }
+
+    private:
+        pixel* m_data;
+        size_t m_size;
+    };
+
+    /**
+     * \brief Pixel buffer keeping all rows in one contiguous
+     * allocation.
+     *
+     * Rows start every get_stride() bytes, the row size rounded up to
+     * a multiple of \c row_alignment (16) bytes, so each row begins
+     * on a SIMD-friendly boundary relative to get_data().  Indexing
+     * returns a row_view, which behaves like the \c std::vector rows
+     * of pixel_buffer.  Resizing does a single allocation regardless
+     * of the height, and the whole image can be handed to other
+     * libraries through get_data() and get_stride().
+     *
+     * The bytes are allocated with \a allocator rebound to byte.
+     * Pass png::allocator< pixel > to allocate from the current
+     * memory_resource.
+     *
+     * \code
+     * png::image< png::rgba_pixel,
+     *             png::contiguous_pixel_buffer< png::rgba_pixel > >
+     *     image("input.png");
+     * upload_texture(image.get_pixbuf().get_data(),
+     *                image.get_pixbuf().get_stride());
+     * \endcode
+     */
+    template< typename pixel, class allocator = std::allocator< pixel > >
+    class contiguous_pixel_buffer
+    {
+    public:
+        typedef std::vector< byte,
+                             typename detail::rebind_allocator
+                             < allocator, byte >::type > byte_vector;
+
+        struct row_traits
+        {
+            typedef row_view< pixel > row_access;
+            typedef row_view< pixel const > row_const_access;
+
+            static byte* get_data(row_access row)
+            {
+                return reinterpret_cast< byte* >(row.data());
+            }
+        };
+
+        /**
+         * \brief A row of pixel data.
+         */
+        typedef typename row_traits::row_access row_access;
+        typedef typename row_traits::row_const_access row_const_access;
+        typedef row_access row_type;
+
+        static size_t const row_alignment = 16;
+
+        /**
+         * \brief Constructs an empty 0x0 pixel buffer object.
+         */
+        contiguous_pixel_buffer()
+            : m_width(0),
+              m_height(0),
+              m_stride(0)
+        {
+        }
+
+        /**
+         * \brief Constructs an empty pixel buffer object.
+         */
+        contiguous_pixel_buffer(size_t width, size_t height)
+            : m_width(0),
+              m_height(0),
+              m_stride(0)
+        {
+            resize(width, height);
+        }
+
+        size_t get_width() const
+        {
+            return m_width;
+        }
+
+        size_t get_height() const
+        {
+            return m_height;
+        }
+
+        /**
+         * \brief Returns the distance between the starts of two
+         * consecutive rows in bytes.
+         */
+        size_t get_stride() const
+        {
+            return m_stride;
+        }
+
+        /**
+         * \brief Returns the start of the first row.
+         */
+        byte* get_data()
+        {
+            return m_bytes.empty() ? 0 : & m_bytes[0];
+        }
+
+        byte const* get_data() const
+        {
+            return m_bytes.empty() ? 0 : & m_bytes[0];
+        }
+
+        /**
+         * \brief Resizes the pixel buffer.
+         *
+         * The pixels that remain inside the new size are kept.  If
+         * new width or height is greater than the original, expanded
+         * pixels are filled with value of \a pixel().
+         */
+        void resize(size_t width, size_t height)
+        {
+            size_t const stride = (width * sizeof(pixel) + row_alignment - 1)
+                / row_alignment * row_alignment;
+            if (stride == m_stride)
+            {
+                m_bytes.resize(height * stride);
+            }
+            else
+            {
+                byte_vector bytes(height * stride);
+                // nothing to copy if either row size is zero
+                size_t const size
+                    = std::min(width, m_width) * sizeof(pixel);
+                size_t const rows = size ? std::min(height, m_height) : 0;
+                for (size_t y = 0; y < rows; ++y)
+                {
+                    std::memcpy(& bytes[y * stride], row_data(y), size);
+                }
+                m_bytes.swap(bytes);
+            }
+            size_t const kept = std::min(height, m_height);
+            size_t const old_width = m_width;
+            m_width = width;
+            m_height = height;
+            m_stride = stride;
+            for (size_t y = 0; y < height; ++y)
+            {
+                fill(y, y < kept ? std::min(width, old_width) : 0, width);
+            }
+        }
+
+        /**
+         * \brief Returns a view of the row of image data at
+         * specified index.
+         *
+         * Checks the index before returning a row: an instance of
+         * std::out_of_range is thrown if \c index is greater than \c
+         * height.
+         */
+        row_access get_row(size_t index)
+        {
+            if (index >= m_height)
+            {
+                throw std::out_of_range("contiguous_pixel_buffer::get_row");
+            }
+            return (*this)[index];
+        }
+
+        /**
+         * \brief Returns a read-only view of the row of image data
+         * at specified index.
+         *
+         * The checking version.
+         */
+        row_const_access get_row(size_t index) const
+        {
+            if (index >= m_height)
+            {
+                throw std::out_of_range("contiguous_pixel_buffer::get_row");
+            }
+            return (*this)[index];
+        }
+
+        /**
+         * \brief The non-checking version of get_row() method.
+         */
+        row_access operator[](size_t index)
+        {
+            return row_access(reinterpret_cast< pixel* >(row_data(index)),
+                              m_width);
+        }
+
+        /**
+         * \brief The non-checking version of get_row() method.
+         */
+        row_const_access operator[](size_t index) const
+        {
+            return row_const_access(reinterpret_cast< pixel const* >
+                                    (row_data(index)), m_width);
+        }
+
+        /**
+         * \brief Replaces the row at specified index.
+         *
+         * Throws std::out_of_range if \c index is not less than the
+         * height or \a r holds fewer pixels than the width.
+         */
+        void put_row(size_t index, row_const_access r)
+        {
+            row_access row = get_row(index);
+            if (r.size() < m_width)
+            {
+                throw std::out_of_range("contiguous_pixel_buffer::put_row");
+            }
+            std::copy(r.begin(), r.begin() + m_width, row.begin());
+        }
+
+        /**
+         * \brief Returns a pixel at (x,y) position.
+         */
+        pixel get_pixel(size_t x, size_t y) const
+        {
+            return get_row(y).at(x);
+        }
+
+        /**
+         * \brief Replaces a pixel at (x,y) position.
+         */
+        void set_pixel(size_t x, size_t y, pixel p)
+        {
+            get_row(y).at(x) = p;
+        }
+
+    protected:
+        /*
+         * Returns the start of row \c y; unlike & m_bytes[...] this
+         * is also valid when a zero width leaves m_bytes empty.
+         */
+        byte* row_data(size_t y)
+        {
+            return get_data() + y * m_stride;
+        }
+
+        byte const* row_data(size_t y) const
+        {
+            return get_data() + y * m_stride;
+        }
+
+        void fill(size_t y, size_t begin, size_t end)
+        {
+            pixel* row = reinterpret_cast< pixel* >(row_data(y));
+            std::fill(row + begin, row + end, pixel());
+        }
+
+        size_t m_width;
+        size_t m_height;
+        size_t m_stride;
+        byte_vector m_bytes;
+    };
+
+    /**
+     * \brief contiguous_pixel_buffer for packed_pixel is not
+     * implemented, see solid_pixel_buffer.
+     */
+    template< size_t bits, class allocator >
+    class contiguous_pixel_buffer< packed_pixel< bits >, allocator >;
+
+} // namespace png
+
+#endif // PNGPP_CONTIGUOUS_PIXEL_BUFFER_HPP_INCLUDED
@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_DOWNSCALE_CONSUMER_HPP_INCLUDED
+#define PNGPP_DOWNSCALE_CONSUMER_HPP_INCLUDED
+
+#include <stdexcept>
+#include <vector>
+
+#include "consumer.hpp"
+#include "pixel_buffer.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief Reads an image shrunk by an integer factor, e.g. for
+     * thumbnails, without ever holding it at full size.
+     *
+     * Every \a factor x \a factor block of source pixels becomes one
+     * pixel of the box-filtered average (blocks at the right and
+     * bottom edges may be smaller and are averaged over the pixels
+     * they have).  Rows are folded into one row of accumulators as
+     * they are read, so for non-interlaced images the memory needed
+     * beyond the output buffer is a source row and the
+     * accumulators--O(width) instead of O(width x height).
+     *
+     * Interlaced images are only complete in the last pass, so for
+     * them the source rows are kept at full size until then.
+     *
+     * Averaging palette indices makes no sense: for index pixels
+     * the top-left pixel of every block is taken instead.
+     *
+     * \code
+     * png::image_info info;
+     * png::pixel_buffer< png::rgba_pixel > thumbnail;
+     * png::downscale_consumer< png::rgba_pixel > con(info, thumbnail, 8);
+     * con.read(stream, png::convert_color_space< png::rgba_pixel >());
+     * \endcode
+     *
+     * The pixel buffer is resized to ceil(width / factor) x
+     * ceil(height / factor).  \a info receives the source image
+     * information.
+     */
+    template< typename pixel,
+              typename pixel_buffer_type = pixel_buffer< pixel > >
+    class downscale_consumer
+        : public consumer< pixel,
+                           downscale_consumer< pixel, pixel_buffer_type >,
+                           image_info_ref_holder,
+                           /* interlacing = */ true >
+    {
+    public:
+        typedef pixel_traits< pixel > traits;
+        typedef pixel_buffer_type pixbuf;
+
+        /**
+         * \brief The largest supported factor: the sums of 16-bit
+         * samples still fit into 32 bits.
+         */
+        static size_t const max_factor = 256;
+
+        /**
+         * \brief Constructs a consumer reading into \a pixels
+         * downscaled by \a factor, which must be within 1 and
+         * max_factor.
+         */
+        downscale_consumer(image_info& info, pixbuf& pixels, size_t factor)
+            : consumer< pixel,
+                        downscale_consumer,
+                        image_info_ref_holder,
+                        true >(info),
+              m_pixbuf(pixels),
+              m_factor(factor),
+              m_pass(0),
+              m_last_pass(0),
+              m_row_bytes(0)
+        {
+            if (factor < 1 || factor > max_factor)
+            {
+                throw std::invalid_argument("png::downscale_consumer:"
+                                            " factor out of range");
+            }
+        }
+
+        void reset(size_t pass)
+        {
+            m_pass = pass;
+            if (pass != 0)
+            {
+                return;
+            }
+            size_t const width = this->get_info().get_width();
+            size_t const height = this->get_info().get_height();
+            bool const interlaced
+                = this->get_info().get_interlace_type() != interlace_none;
+            m_last_pass = interlaced ? 6 : 0;
+
+            m_pixbuf.resize((width + m_factor - 1) / m_factor,
+                            (height + m_factor - 1) / m_factor);
+            m_row_bytes = (width * traits::channels * traits::bit_depth + 7)
+                / 8;
+            m_rows.assign(m_row_bytes * (interlaced ? height : 1), 0);
+            m_sums.assign(m_pixbuf.get_width() * traits::channels, 0);
+        }
+
+        byte* get_next_row(size_t pos)
+        {
+            return & m_rows[m_last_pass ? pos * m_row_bytes : 0];
+        }
+
+        bool finish_row(size_t pos)
+        {
+            if (m_pass == m_last_pass)
+            {
+                add_row(get_next_row(pos), pos);
+            }
+            return true;
+        }
+
+    private:
+        static bool is_palette()
+        {
+            return traits::get_color_type() == color_type_palette;
+        }
+
+        /*
+         * Returns the channel c of the pixel x of a row in libpng's
+         * format (16-bit samples already in host byte order).
+         */
+        static uint_32 get_sample(byte const* row, size_t x, size_t c)
+        {
+            if (traits::bit_depth == 16)
+            {
+                return reinterpret_cast< uint_16 const* >(row)
+                    [x * traits::channels + c];
+            }
+            if (traits::bit_depth == 8)
+            {
+                return row[x * traits::channels + c];
+            }
+            size_t const bit = x * traits::bit_depth;
+            return (row[bit / 8] >> (8 - traits::bit_depth - bit % 8))
+                & ((1 << traits::bit_depth) - 1);
+        }
+
+        static void set_sample(byte* row, size_t x, size_t c, uint_32 value)
+        {
+            if (traits::bit_depth == 16)
+            {
+                reinterpret_cast< uint_16* >(row)[x * traits::channels + c]
+                    = static_cast< uint_16 >(value);
+            }
+            else if (traits::bit_depth == 8)
+            {
+                row[x * traits::channels + c] = static_cast< byte >(value);
+            }
+            else
+            {
+                size_t const bit = x * traits::bit_depth;
+                size_t const shift = 8 - traits::bit_depth - bit % 8;
+                byte const mask = static_cast< byte >
+                    (((1 << traits::bit_depth) - 1) << shift);
+                row[bit / 8] = static_cast< byte >
+                    ((row[bit / 8] & ~mask) | ((value << shift) & mask));
+            }
+        }
+
+        void add_row(byte const* row, size_t pos)
+        {
+            size_t const width = this->get_info().get_width();
+            size_t const height = this->get_info().get_height();
+            size_t const out_width = m_pixbuf.get_width();
+            size_t const channels = traits::channels;
+
+            if (is_palette())
+            {
+                if (pos % m_factor == 0)
+                {
+                    byte* out = get_out_row(pos / m_factor);
+                    for (size_t x = 0; x < out_width; ++x)
+                    {
+                        set_sample(out, x, 0, get_sample(row, x * m_factor, 0));
+                    }
+                }
+                return;
+            }
+
+            uint_32* sums = & m_sums[0];
+            for (size_t ox = 0, x = 0; ox < out_width; ++ox)
+            {
+                size_t const end = x + m_factor < width ? x + m_factor : width;
+                for (; x < end; ++x)
+                {
+                    for (size_t c = 0; c < channels; ++c)
+                    {
+                        sums[c] += get_sample(row, x, c);
+                    }
+                }
+                sums += channels;
+            }
+
+            if ((pos + 1) % m_factor != 0 && pos + 1 != height)
+            {
+                return;
+            }
+
+            size_t const rows = pos % m_factor + 1;
+            byte* out = get_out_row(pos / m_factor);
+            for (size_t ox = 0; ox < out_width; ++ox)
+            {
+                size_t const cols = ox + 1 < out_width
+                    ? m_factor : width - ox * m_factor;
+                uint_32 const count = static_cast< uint_32 >(rows * cols);
+                for (size_t c = 0; c < channels; ++c)
+                {
+                    uint_32& sum = m_sums[ox * channels + c];
+                    set_sample(out, ox, c, (sum + count / 2) / count);
+                    sum = 0;
+                }
+            }
+        }
+
+        byte* get_out_row(size_t y)
+        {
+            typedef typename pixbuf::row_traits row_traits;
+            return reinterpret_cast< byte* >
+                (row_traits::get_data(m_pixbuf[y]));
+        }
+
+        pixbuf& m_pixbuf;
+        size_t m_factor;
+        size_t m_pass;
+        size_t m_last_pass;
+        size_t m_row_bytes;
+        std::vector< byte > m_rows;
+        std::vector< uint_32 > m_sums;
+    };
+
+    template< typename pixel, typename pixel_buffer_type >
+    size_t const downscale_consumer< pixel, pixel_buffer_type >::max_factor;
+
+} // namespace png
+
+#endif // PNGPP_DOWNSCALE_CONSUMER_HPP_INCLUDED
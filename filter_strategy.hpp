@@ -0,0 +1,410 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_FILTER_STRATEGY_HPP_INCLUDED
+#define PNGPP_FILTER_STRATEGY_HPP_INCLUDED
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "config.hpp"
+#include "types.hpp"
+#include "error.hpp"
+#include "image_info.hpp"
+#include "row_filter.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief The ways of choosing a filter for every row, see
+     * filter_strategy.
+     */
+    enum filter_selection
+    {
+        filter_select_fixed,
+        filter_select_min_sum,
+        filter_select_entropy,
+        filter_select_reuse
+    };
+
+    /**
+     * \brief Selects the row filters used by the encoders which
+     * filter rows themselves (native_encoder and parallel_encoder).
+     *
+     * - fixed() applies the same filter to every row, the cheapest
+     *   choice.
+     * - min_sum() tries every allowed filter and keeps the one with
+     *   the smallest sum of absolute values of the filtered bytes
+     *   taken as signed, the heuristic recommended by the PNG
+     *   specification and used by libpng.  The sums are computed
+     *   with SSE2 where available.
+     * - entropy() keeps the filter whose output has the smallest
+     *   order-0 entropy, which predicts the deflate output better on
+     *   synthetic images but costs a histogram per candidate.
+     * - reuse_previous() keeps the filter chosen for the previous
+     *   row while its minimum-sum cost stays within \c drift percent
+     *   of the cost measured when it was chosen, and searches all
+     *   filters again otherwise or after 8 rows.  This costs little
+     *   more than a fixed filter for nearly the size of min_sum().
+     *
+     * The adaptive strategies use the None filter for %color-mapped
+     * images and bit depths below 8, as the specification suggests.
+     */
+    class filter_strategy
+    {
+    public:
+        /**
+         * \brief Constructs a fixed strategy, see fixed().
+         */
+        explicit filter_strategy(int filter = PNG_FILTER_VALUE_UP)
+            : m_selection(filter_select_fixed),
+              m_filter(filter),
+              m_filters(PNG_ALL_FILTERS),
+              m_drift(0)
+        {
+            if (filter < PNG_FILTER_VALUE_NONE
+                || filter > PNG_FILTER_VALUE_PAETH)
+            {
+                throw error("filter_strategy: invalid filter type");
+            }
+        }
+
+        /**
+         * \brief Applies \a filter (one of the \c PNG_FILTER_VALUE_*
+         * constants) to every row.  Throws error if \a filter is
+         * not one of them.
+         */
+        static filter_strategy fixed(int filter)
+        {
+            return filter_strategy(filter);
+        }
+
+        /**
+         * \brief Chooses the filter with the smallest sum of
+         * absolute differences among \a filters (a combination of
+         * the \c PNG_FILTER_* flags).
+         */
+        static filter_strategy min_sum(int filters = PNG_ALL_FILTERS)
+        {
+            return filter_strategy(filter_select_min_sum, filters, 0);
+        }
+
+        /**
+         * \brief Chooses the filter with the smallest entropy
+         * estimate among \a filters.
+         */
+        static filter_strategy entropy(int filters = PNG_ALL_FILTERS)
+        {
+            return filter_strategy(filter_select_entropy, filters, 0);
+        }
+
+        /**
+         * \brief Keeps the previous row's filter until its cost
+         * drifts by more than \a drift percent.
+         */
+        static filter_strategy reuse_previous(int drift = 20,
+                                              int filters = PNG_ALL_FILTERS)
+        {
+            return filter_strategy(filter_select_reuse, filters, drift);
+        }
+
+        filter_selection get_selection() const
+        {
+            return m_selection;
+        }
+
+        /**
+         * \brief Returns the filter of a fixed strategy.
+         */
+        int get_filter() const
+        {
+            return m_filter;
+        }
+
+        /**
+         * \brief Returns the filters an adaptive strategy chooses
+         * from, a combination of the \c PNG_FILTER_* flags.
+         */
+        int get_filters() const
+        {
+            return m_filters;
+        }
+
+        int get_drift() const
+        {
+            return m_drift;
+        }
+
+    private:
+        filter_strategy(filter_selection selection, int filters, int drift)
+            : m_selection(selection),
+              m_filter(PNG_FILTER_VALUE_NONE),
+              m_filters(filters),
+              m_drift(drift)
+        {
+        }
+
+        filter_selection m_selection;
+        int m_filter;
+        int m_filters;
+        int m_drift;
+    };
+
+    namespace detail
+    {
+
+        /*
+         * Returns the sum of the bytes of \c data taken as signed
+         * values, the minimum-sum filter cost.
+         */
+        inline size_t sum_abs_signed(byte const* data, size_t size)
+        {
+            size_t sum = 0;
+            size_t i = 0;
+#ifdef PNGPP_HAS_SSE2
+            __m128i const zero = _mm_setzero_si128();
+            __m128i acc = zero;
+            for (; i + 16 <= size; i += 16)
+            {
+                __m128i x = _mm_loadu_si128(
+                    reinterpret_cast< __m128i const* >(data + i));
+                // |x| as signed is min(x, 256 - x) as unsigned
+                x = _mm_min_epu8(x, _mm_sub_epi8(zero, x));
+                acc = _mm_add_epi64(acc, _mm_sad_epu8(x, zero));
+            }
+            __m128i const high = _mm_srli_si128(acc, 8);
+#if defined(__x86_64__) || defined(_M_X64)
+            sum = size_t(_mm_cvtsi128_si64(acc))
+                + size_t(_mm_cvtsi128_si64(high));
+#else
+            // a 32-bit size_t keeps only the low half of each lane
+            sum = size_t(uint_32(_mm_cvtsi128_si32(acc)))
+                + size_t(uint_32(_mm_cvtsi128_si32(high)));
+#endif
+#endif
+            for (; i < size; ++i)
+            {
+                sum += data[i] < 128 ? data[i] : 256 - data[i];
+            }
+            return sum;
+        }
+
+        /*
+         * Filters rows as directed by a filter_strategy.  filter()
+         * returns the filter type byte followed by the filtered row,
+         * valid until the next call.
+         */
+        class filter_selector
+        {
+        public:
+            filter_selector(filter_strategy const& strategy,
+                            image_info const& info)
+                : m_selection(strategy.get_selection()),
+                  m_drift(strategy.get_drift()),
+                  m_last(-1),
+                  m_last_cost(0),
+                  m_reused(0)
+            {
+                size_t const bits = get_color_channels(info.get_color_type())
+                    * info.get_bit_depth();
+                m_row_size = (info.get_width() * bits + 7) / 8;
+                m_bpp = bits < 8 ? 1 : bits / 8;
+
+                int filters = strategy.get_filters();
+                if (m_selection == filter_select_fixed)
+                {
+                    filters = 0;
+                    m_last = strategy.get_filter();
+                }
+                else if (bits < 8
+                         || info.get_color_type() == color_type_palette)
+                {
+                    m_selection = filter_select_fixed;
+                    filters = 0;
+                    m_last = PNG_FILTER_VALUE_NONE;
+                }
+                static int const flags[] =
+                {
+                    PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP,
+                    PNG_FILTER_AVG, PNG_FILTER_PAETH
+                };
+                for (int f = 0; f < 5; ++f)
+                {
+                    if (filters & flags[f])
+                    {
+                        m_candidates.push_back(f);
+                    }
+                }
+                if (m_selection != filter_select_fixed
+                    && m_candidates.empty())
+                {
+                    m_selection = filter_select_fixed;
+                    m_last = PNG_FILTER_VALUE_NONE;
+                }
+                for (int f = 0; f < 5; ++f)
+                {
+                    m_rows[f].resize(m_row_size + 1);
+                    m_rows[f][0] = byte(f);
+                }
+                if (m_selection == filter_select_entropy)
+                {
+                    // n * log2(n) for every possible byte count
+                    m_nlogn.resize(m_row_size + 1);
+                    for (size_t n = 1; n <= m_row_size; ++n)
+                    {
+                        m_nlogn[n] = n * std::log(double(n)) / std::log(2.0);
+                    }
+                }
+            }
+
+            size_t get_row_size() const
+            {
+                return m_row_size;
+            }
+
+            byte const* filter(byte const* row, byte const* prev)
+            {
+                switch (m_selection)
+                {
+                case filter_select_fixed:
+                    return apply(m_last, row, prev);
+
+                case filter_select_entropy:
+                    return search_entropy(row, prev);
+
+                case filter_select_reuse:
+                    if (m_last >= 0 && ++m_reused < max_reused)
+                    {
+                        byte const* out = apply(m_last, row, prev);
+                        size_t const cost = sum_abs_signed(out + 1,
+                                                           m_row_size);
+                        if (cost * 100 <= m_last_cost * (100 + m_drift))
+                        {
+                            return out;
+                        }
+                    }
+                    return search_min_sum(row, prev);
+
+                default:
+                    return search_min_sum(row, prev);
+                }
+            }
+
+        private:
+            byte const* apply(int f, byte const* row, byte const* prev)
+            {
+                filter_row(f, & m_rows[f][1], row, prev, m_row_size, m_bpp);
+                return & m_rows[f][0];
+            }
+
+            byte const* search_min_sum(byte const* row, byte const* prev)
+            {
+                int best = -1;
+                size_t best_cost = 0;
+                for (size_t i = 0; i < m_candidates.size(); ++i)
+                {
+                    int const f = m_candidates[i];
+                    apply(f, row, prev);
+                    size_t const cost = sum_abs_signed(& m_rows[f][1],
+                                                       m_row_size);
+                    if (best < 0 || cost < best_cost)
+                    {
+                        best = f;
+                        best_cost = cost;
+                    }
+                }
+                m_last = best;
+                m_last_cost = best_cost;
+                m_reused = 0;
+                return & m_rows[best][0];
+            }
+
+            byte const* search_entropy(byte const* row, byte const* prev)
+            {
+                int best = -1;
+                double best_cost = 0;
+                for (size_t i = 0; i < m_candidates.size(); ++i)
+                {
+                    int const f = m_candidates[i];
+                    apply(f, row, prev);
+                    // four interleaved histograms keep runs of equal
+                    // bytes from serialising on one counter
+                    size_t counts[4][256] = { { 0 } };
+                    byte const* data = & m_rows[f][1];
+                    size_t j = 0;
+                    for (; j + 4 <= m_row_size; j += 4)
+                    {
+                        ++counts[0][data[j]];
+                        ++counts[1][data[j + 1]];
+                        ++counts[2][data[j + 2]];
+                        ++counts[3][data[j + 3]];
+                    }
+                    for (; j < m_row_size; ++j)
+                    {
+                        ++counts[0][data[j]];
+                    }
+                    // N * entropy = N log N - sum n log n
+                    double cost = m_nlogn[m_row_size];
+                    for (size_t c = 0; c < 256; ++c)
+                    {
+                        cost -= m_nlogn[counts[0][c] + counts[1][c]
+                                        + counts[2][c] + counts[3][c]];
+                    }
+                    if (best < 0 || cost < best_cost)
+                    {
+                        best = f;
+                        best_cost = cost;
+                    }
+                }
+                m_last = best;
+                return & m_rows[best][0];
+            }
+
+            // rows filtered by reuse_previous() between searches
+            static size_t const max_reused = 8;
+
+            filter_selection m_selection;
+            int m_drift;
+            size_t m_row_size;
+            size_t m_bpp;
+            std::vector< int > m_candidates;
+            std::vector< byte > m_rows[5];
+            std::vector< double > m_nlogn;
+            int m_last;
+            size_t m_last_cost;
+            size_t m_reused;
+        };
+
+    } // namespace detail
+
+} // namespace png
+
+#endif // PNGPP_FILTER_STRATEGY_HPP_INCLUDED
@@ -40,6 +40,8 @@
 #include "error.hpp"
 #include "streaming_base.hpp"
 #include "writer.hpp"
+#include "native_encoder.hpp"
+#include "parallel_encoder.hpp"
 
 namespace png
 {
@@ -92,6 +94,23 @@ namespace png
      * method unless you are going to support interlaced %image
      * generation.
      *
+     * Like a %consumer, a %generator may implement the optional \c
+     * get_next_rows() method to hand over blocks of rows, written in
+     * one go:
+     *
+     * \code
+     * size_t get_next_rows(size_t pos, size_t count, png::byte** rows);
+     * \endcode
+     *
+     * Or it may implement \c get_image_rows() to have the whole
+     * %image written by a single call to libpng:
+     *
+     * \code
+     * png::byte** get_image_rows();
+     * \endcode
+     *
+     * See the consumer class documentation for the details.
+     *
      * An optional template parameter \c info_holder encapsulated
      * image_info storage policy.  Please refer to consumer class
      * documentation for the detailed description of this parameter.
@@ -127,9 +146,20 @@ namespace png
          */
         template< typename ostream >
         void write(ostream& stream)
+        {
+            write(stream, compression_profile());
+        }
+
+        /**
+         * \brief Writes an image to the stream with the compression
+         * settings of \a profile.
+         */
+        template< typename ostream >
+        void write(ostream& stream, compression_profile const& profile)
         {
             writer< ostream > wr(stream);
             wr.set_image_info(this->get_info());
+            wr.set_compression_profile(profile);
             wr.write_info();
 
 #if __BYTE_ORDER == __LITTLE_ENDIAN
@@ -163,19 +193,72 @@ namespace png
             {
                 pass_count = 1;
             }
-            pixgen* pixel_gen = static_cast< pixgen* >(this);
-            for (size_t pass = 0; pass < pass_count; ++pass)
-            {
-                pixel_gen->reset(pass);
+            write_rows(wr, pass_count, static_cast< pixgen* >(this));
+            wr.write_end_info();
+        }
 
-                for (size_t pos = 0; pos < this->get_info().get_height(); ++pos)
-                {
-                    wr.write_row(pixel_gen->get_next_row(pos));
-                }
+        /**
+         * \brief Writes an image to the stream with native_encoder,
+         * trading some compression for a much faster write.
+         *
+         * Rows are filtered as chosen by \c strategy (a fixed
+         * filter or an adaptive filter_strategy) and compressed with a fast
+         * deflate coder; the output is a standard PNG file.
+         * Interlaced images are written with write() instead.
+         */
+        template< typename ostream >
+        void write_fast(ostream& stream,
+                        filter_strategy const& strategy = filter_strategy())
+        {
+            if (this->get_info().get_interlace_type() != interlace_none)
+            {
+                write(stream);
+                return;
             }
+            native_encoder< ostream > enc(stream, this->get_info(), strategy);
+            enc.write_info();
+            write_rows(enc, 1, static_cast< pixgen* >(this));
+            enc.write_end_info();
+        }
 
-            wr.write_end_info();
+        /**
+         * \brief Writes an image with native_encoder applying \a
+         * filter, one of the \c PNG_FILTER_VALUE_* constants, to every
+         * row.  Throws error for any other value.
+         */
+        template< typename ostream >
+        void write_fast(ostream& stream, int filter)
+        {
+            write_fast(stream, filter_strategy::fixed(filter));
+        }
+
+#ifdef PNGPP_HAS_STD_THREAD
+        /**
+         * \brief Writes an image to the stream deflating strips of
+         * rows concurrently on \a pool (see parallel_encoder).
+         *
+         * The output does not depend on the number of threads.
+         * Interlaced images are written with write() instead.
+         */
+        template< typename ostream >
+        void write_parallel(ostream& stream, thread_pool& pool,
+                            compression_profile const& profile
+                                = compression_profile(),
+                            size_t strip_size = parallel_encoder
+                                < ostream >::default_strip_size)
+        {
+            if (this->get_info().get_interlace_type() != interlace_none)
+            {
+                write(stream, profile);
+                return;
+            }
+            parallel_encoder< ostream > enc(stream, this->get_info(), pool,
+                                            profile, strip_size);
+            enc.write_info();
+            write_rows(enc, 1, static_cast< pixgen* >(this));
+            enc.write_end_info();
         }
+#endif
 
     protected:
         typedef streaming_base< pixel, info_holder > base;
@@ -197,6 +280,47 @@ namespace png
             : base(width, height)
         {
         }
+
+    private:
+        /*
+         * Works with writer, native_encoder and parallel_encoder.
+         */
+        template< class writer_type >
+        void write_rows(writer_type& wr, size_t pass_count, pixgen* pixel_gen)
+        {
+            size_t const height = this->get_info().get_height();
+            byte* rows[base::rows_per_block];
+            for (size_t pass = 0; pass < pass_count; ++pass)
+            {
+                pixel_gen->reset(pass);
+
+                if (pass == 0)
+                {
+                    if (byte** image_rows = pixel_gen->get_image_rows())
+                    {
+                        wr.write_image(image_rows);
+                        break;
+                    }
+                }
+
+                for (size_t pos = 0; pos < height; )
+                {
+                    size_t count = height - pos < base::rows_per_block
+                        ? height - pos : base::rows_per_block;
+                    count = pixel_gen->get_next_rows(pos, count, rows);
+                    if (count)
+                    {
+                        wr.write_rows(rows, count);
+                        pos += count;
+                    }
+                    else
+                    {
+                        wr.write_row(pixel_gen->get_next_row(pos));
+                        ++pos;
+                    }
+                }
+            }
+        }
     };
 
 } // namespace png
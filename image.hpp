@@ -32,10 +32,18 @@
 #define PNGPP_IMAGE_HPP_INCLUDED
 
 #include <fstream>
+#include <stdexcept>
+#include <vector>
+#include "config.hpp"
+#include "memory_stream.hpp"
+#include "optimizer.hpp"
+#include "reduction.hpp"
+#include "mapped_file.hpp"
 #include "pixel_buffer.hpp"
 #include "generator.hpp"
 #include "consumer.hpp"
 #include "convert_color_space.hpp"
+#include "adam7.hpp"
 
 namespace png
 {
@@ -79,6 +87,12 @@ namespace png
         typedef typename pixbuf::row_access row_access;
         typedef typename pixbuf::row_const_access row_const_access;
 
+        /**
+         * \brief The low-resolution view of an image being read
+         * passed to read_progressive() callbacks.
+         */
+        typedef adam7_preview< pixel, pixbuf > preview;
+
         /**
          * \brief A transformation functor to convert any image to
          * appropriate color space.
@@ -199,17 +213,16 @@ namespace png
         /**
          * \brief Reads an image from specified file using custom
          * transformaton.
+         *
+         * If \c PNGPP_USE_MMAP is defined and the platform supports
+         * it, the file is memory-mapped rather than read through \c
+         * std::ifstream (see mapped_file).
          */
         template< class transformation >
         void read(char const* filename, transformation const& transform)
         {
-            std::ifstream stream(filename, std::ios::binary);
-            if (!stream.is_open())
-            {
-                throw std_error(filename);
-            }
-            stream.exceptions(std::ios::badbit);
-            read_stream(stream, transform);
+            read_file(filename, stream_reader< transformation >(*this,
+                                                                transform));
         }
 
         /**
@@ -252,6 +265,212 @@ namespace png
             pixcon.read(stream, transform);
         }
 
+        /**
+         * \brief Reads a rectangular region of an image from
+         * specified file using default converting transform.
+         *
+         * \see read_region_stream()
+         */
+        void read_region(std::string const& filename,
+                         size_t x, size_t y, size_t width, size_t height)
+        {
+            read_region(filename.c_str(), x, y, width, height,
+                        transform_convert());
+        }
+
+        /**
+         * \brief Reads a rectangular region of an image from
+         * specified file using custom transformation.
+         *
+         * \see read_region_stream()
+         */
+        template< class transformation >
+        void read_region(std::string const& filename,
+                         size_t x, size_t y, size_t width, size_t height,
+                         transformation const& transform)
+        {
+            read_region(filename.c_str(), x, y, width, height, transform);
+        }
+
+        /**
+         * \brief Reads a rectangular region of an image from
+         * specified file using default converting transform.
+         *
+         * \see read_region_stream()
+         */
+        void read_region(char const* filename,
+                         size_t x, size_t y, size_t width, size_t height)
+        {
+            read_region(filename, x, y, width, height, transform_convert());
+        }
+
+        /**
+         * \brief Reads a rectangular region of an image from
+         * specified file using custom transformation.
+         *
+         * \see read_region_stream()
+         */
+        template< class transformation >
+        void read_region(char const* filename,
+                         size_t x, size_t y, size_t width, size_t height,
+                         transformation const& transform)
+        {
+            read_file(filename,
+                      region_reader< transformation >(*this,
+                                                       x, y, width, height,
+                                                       transform));
+        }
+
+        /**
+         * \brief Reads a rectangular region of an image from a
+         * stream using default converting transform.
+         *
+         * \see read_region_stream()
+         */
+        template< class istream >
+        void read_region_stream(istream& stream,
+                                size_t x, size_t y,
+                                size_t width, size_t height)
+        {
+            read_region_stream(stream, x, y, width, height,
+                               transform_convert());
+        }
+
+        /**
+         * \brief Reads a rectangular region of an image from a
+         * stream using custom transformation.
+         *
+         * Only the \a width x \a height pixels at (\a x, \a y) are
+         * stored, the image becoming \a width x \a height.  Reading
+         * stops once the last row of the region is complete: the
+         * rest of the image data is not inflated and the chunks after
+         * it are not read.  For interlaced images that is in the last
+         * pass, and the region rows are buffered at full width
+         * meanwhile.
+         *
+         * Throws std::out_of_range if the region does not fit into
+         * the image.
+         */
+        template< class istream, class transformation >
+        void read_region_stream(istream& stream,
+                                size_t x, size_t y,
+                                size_t width, size_t height,
+                                transformation const& transform)
+        {
+            region_consumer pixcon(m_info, m_pixbuf, x, y, width, height);
+            pixcon.read(stream, transform);
+            m_info.set_width(width);
+            m_info.set_height(height);
+        }
+
+        /**
+         * \brief Reads an image from specified file using default
+         * converting transform, calling \a callback after every
+         * interlace pass.
+         *
+         * \see read_progressive_stream()
+         */
+        template< class pass_callback >
+        void read_progressive(std::string const& filename,
+                              pass_callback const& callback)
+        {
+            read_progressive(filename.c_str(), transform_convert(),
+                             callback);
+        }
+
+        /**
+         * \brief Reads an image from specified file using custom
+         * transformation, calling \a callback after every interlace
+         * pass.
+         *
+         * \see read_progressive_stream()
+         */
+        template< class transformation, class pass_callback >
+        void read_progressive(std::string const& filename,
+                              transformation const& transform,
+                              pass_callback const& callback)
+        {
+            read_progressive(filename.c_str(), transform, callback);
+        }
+
+        /**
+         * \brief Reads an image from specified file using default
+         * converting transform, calling \a callback after every
+         * interlace pass.
+         *
+         * \see read_progressive_stream()
+         */
+        template< class pass_callback >
+        void read_progressive(char const* filename, pass_callback const& callback)
+        {
+            read_progressive(filename, transform_convert(), callback);
+        }
+
+        /**
+         * \brief Reads an image from specified file using custom
+         * transformation, calling \a callback after every interlace
+         * pass.
+         *
+         * \see read_progressive_stream()
+         */
+        template< class transformation, class pass_callback >
+        void read_progressive(char const* filename,
+                              transformation const& transform,
+                              pass_callback const& callback)
+        {
+            read_file(filename,
+                      progressive_reader< transformation, pass_callback >
+                      (*this, transform, callback));
+        }
+
+        /**
+         * \brief Reads an image from a stream using default
+         * converting transform, calling \a callback after every
+         * interlace pass.
+         *
+         * \see read_progressive_stream()
+         */
+        template< class istream, class pass_callback >
+        void read_progressive_stream(istream& stream,
+                                     pass_callback const& callback)
+        {
+            read_progressive_stream(stream, transform_convert(), callback);
+        }
+
+        /**
+         * \brief Reads an image from a stream using custom
+         * transformation, calling \a callback after every interlace
+         * pass.
+         *
+         * The callback is invoked as
+         *
+         * \code
+         * bool callback(image::preview const& preview);
+         * \endcode
+         *
+         * after each of the 7 passes of an Adam7 image (once for a
+         * non-interlaced one) with a view of the pixels known so far:
+         * a 1/8-scale image after the first pass, 1/4 after the third
+         * and so on (see adam7_preview).  Returning \c false stops
+         * reading: the rest of the image data is not inflated, and
+         * the image keeps its full size with only the pixels of the
+         * passes read so far set.
+         *
+         * The callback is taken by const reference, like a
+         * transformation, so temporaries and lambdas may be passed;
+         * its \c operator() must be \c const, with any state it
+         * updates declared \c mutable or kept outside.
+         */
+        template< class istream, class transformation, class pass_callback >
+        void read_progressive_stream(istream& stream,
+                                     transformation const& transform,
+                                     pass_callback const& callback)
+        {
+            progressive_consumer< pass_callback >
+                pixcon(m_info, m_pixbuf, callback);
+            pixcon.read(stream, transform);
+        }
+
         /**
          * \brief Writes an image to specified file.
          */
@@ -284,6 +503,308 @@ namespace png
             pixgen.write(stream);
         }
 
+        /**
+         * \brief Writes an image to specified file with the
+         * compression settings of \a profile.
+         */
+        void write(std::string const& filename,
+                   compression_profile const& profile)
+        {
+            write(filename.c_str(), profile);
+        }
+
+        /**
+         * \brief Writes an image to specified file with the
+         * compression settings of \a profile.
+         */
+        void write(char const* filename, compression_profile const& profile)
+        {
+            std::ofstream stream(filename, std::ios::binary);
+            if (!stream.is_open())
+            {
+                throw std_error(filename);
+            }
+            stream.exceptions(std::ios::badbit);
+            write_stream(stream, profile);
+        }
+
+        /**
+         * \brief Writes an image to a stream with the compression
+         * settings of \a profile.
+         */
+        template< class ostream >
+        void write_stream(ostream& stream, compression_profile const& profile)
+        {
+            pixel_generator pixgen(m_info, m_pixbuf);
+            pixgen.write(stream, profile);
+        }
+
+        /**
+         * \brief Writes an image to specified file in the smallest
+         * lossless color type and bit depth for its pixels.
+         *
+         * \see write_reduced_stream()
+         */
+        image_info write_reduced(std::string const& filename,
+                                 compression_profile const& profile
+                                     = compression_profile())
+        {
+            return write_reduced(filename.c_str(), profile);
+        }
+
+        /**
+         * \brief Writes an image to specified file in the smallest
+         * lossless color type and bit depth for its pixels.
+         */
+        image_info write_reduced(char const* filename,
+                                 compression_profile const& profile
+                                     = compression_profile())
+        {
+            std::ofstream stream(filename, std::ios::binary);
+            if (!stream.is_open())
+            {
+                throw std_error(filename);
+            }
+            stream.exceptions(std::ios::badbit);
+            return write_reduced_stream(stream, profile);
+        }
+
+        /**
+         * \brief Writes an image to a stream in the smallest lossless
+         * color type and bit depth for its pixels.
+         *
+         * An analysis pass over the pixels detects opaque alpha
+         * channels, gray content, samples that fit in 8 bits, gray
+         * levels that fit in 1, 2 or 4 bits and images of at most 256
+         * colors, which are written with an exact palette (and tRNS
+         * for translucent colors).  The rows are repacked into the
+         * chosen format before encoding; reading the file back with
+         * the image's pixel type gives the same pixels.  Returns the
+         * header of the written image.
+         */
+        template< class ostream >
+        image_info write_reduced_stream(ostream& stream,
+                                        compression_profile const& profile
+                                            = compression_profile())
+        {
+            typedef typename pixbuf::row_traits row_traits;
+            size_t const height = m_info.get_height();
+            if (m_pixbuf.get_height() < height
+                || m_pixbuf.get_width() < m_info.get_width())
+            {
+                throw std::out_of_range("image: pixel buffer is smaller"
+                                        " than the image");
+            }
+            std::vector< byte const* > rows(height);
+            for (size_t y = 0; y < height; ++y)
+            {
+                rows[y] = reinterpret_cast< byte const* >
+                    (row_traits::get_data(m_pixbuf[y]));
+            }
+            detail::image_reduction reduction(m_info, rows);
+            size_t const row_size = reduction.get_row_size();
+            std::vector< byte > data(height * row_size);
+            std::vector< byte* > table(height);
+            for (size_t y = 0; y < height; ++y)
+            {
+                table[y] = & data[y * row_size];
+                reduction.repack(y, table[y]);
+            }
+
+            writer< ostream > wr(stream);
+            wr.set_image_info(reduction.get_info());
+            wr.set_compression_profile(profile);
+            wr.write_info();
+            wr.write_image(height ? & table[0] : 0);
+            wr.write_end_info();
+            return reduction.get_info();
+        }
+
+        /**
+         * \brief Writes an image to specified file with the fast
+         * native encoder.
+         *
+         * \see generator::write_fast()
+         */
+        void write_fast(std::string const& filename,
+                        filter_strategy const& strategy = filter_strategy())
+        {
+            write_fast(filename.c_str(), strategy);
+        }
+
+        /**
+         * \brief Writes an image to specified file with the fast
+         * native encoder.
+         */
+        void write_fast(char const* filename,
+                        filter_strategy const& strategy = filter_strategy())
+        {
+            std::ofstream stream(filename, std::ios::binary);
+            if (!stream.is_open())
+            {
+                throw std_error(filename);
+            }
+            stream.exceptions(std::ios::badbit);
+            write_fast_stream(stream, strategy);
+        }
+
+        /**
+         * \brief Writes an image to a stream with the fast native
+         * encoder.
+         */
+        template< class ostream >
+        void write_fast_stream(ostream& stream,
+                               filter_strategy const& strategy
+                                   = filter_strategy())
+        {
+            pixel_generator pixgen(m_info, m_pixbuf);
+            pixgen.write_fast(stream, strategy);
+        }
+
+        /**
+         * \brief Writes an image to specified file with the fast
+         * native encoder applying the fixed \a filter.
+         */
+        void write_fast(std::string const& filename, int filter)
+        {
+            write_fast(filename.c_str(), filter_strategy::fixed(filter));
+        }
+
+        /**
+         * \brief Writes an image to specified file with the fast
+         * native encoder applying the fixed \a filter.
+         */
+        void write_fast(char const* filename, int filter)
+        {
+            write_fast(filename, filter_strategy::fixed(filter));
+        }
+
+        /**
+         * \brief Writes an image to a stream with the fast native
+         * encoder applying the fixed \a filter.
+         */
+        template< class ostream >
+        void write_fast_stream(ostream& stream, int filter)
+        {
+            write_fast_stream(stream, filter_strategy::fixed(filter));
+        }
+
+#ifdef PNGPP_HAS_STD_THREAD
+        /**
+         * \brief Writes an image to specified file deflating strips
+         * of rows on \a thread_count threads (0 for one per hardware
+         * thread).
+         *
+         * \see generator::write_parallel()
+         */
+        void write_parallel(std::string const& filename,
+                            size_t thread_count = 0,
+                            compression_profile const& profile
+                                = compression_profile())
+        {
+            write_parallel(filename.c_str(), thread_count, profile);
+        }
+
+        /**
+         * \brief Writes an image to specified file deflating strips
+         * of rows on \a thread_count threads.
+         */
+        void write_parallel(char const* filename, size_t thread_count = 0,
+                            compression_profile const& profile
+                                = compression_profile())
+        {
+            std::ofstream stream(filename, std::ios::binary);
+            if (!stream.is_open())
+            {
+                throw std_error(filename);
+            }
+            stream.exceptions(std::ios::badbit);
+            write_parallel_stream(stream, thread_count, profile);
+        }
+
+        /**
+         * \brief Writes an image to a stream deflating strips of rows
+         * on \a thread_count threads.
+         */
+        template< class ostream >
+        void write_parallel_stream(ostream& stream, size_t thread_count = 0,
+                                   compression_profile const& profile
+                                       = compression_profile())
+        {
+            thread_pool pool(thread_count);
+            pixel_generator pixgen(m_info, m_pixbuf);
+            pixgen.write_parallel(stream, pool, profile);
+        }
+
+        /**
+         * \brief Writes the smallest of the encodings of the image
+         * with the compression profiles of \a options to specified
+         * file.
+         *
+         * \see write_optimized_stream()
+         */
+        optimize_report write_optimized(std::string const& filename,
+                                        optimize_options const& options
+                                            = optimize_options())
+        {
+            return write_optimized(filename.c_str(), options);
+        }
+
+        /**
+         * \brief Writes the smallest of the encodings of the image
+         * with the compression profiles of \a options to specified
+         * file.
+         */
+        optimize_report write_optimized(char const* filename,
+                                        optimize_options const& options
+                                            = optimize_options())
+        {
+            std::ofstream stream(filename, std::ios::binary);
+            if (!stream.is_open())
+            {
+                throw std_error(filename);
+            }
+            stream.exceptions(std::ios::badbit);
+            return write_optimized_stream(stream, options);
+        }
+
+        /**
+         * \brief Encodes the image concurrently with each of the
+         * compression profiles of \a options into memory and writes
+         * the smallest result to a stream.
+         *
+         * Every trial runs its own writer on a thread_pool of at most
+         * options.get_thread_count() threads, and no trial is
+         * started after the time budget is spent.  The returned
+         * report names the winning profile; image::write() with that
+         * profile reproduces the output.
+         */
+        template< class ostream >
+        optimize_report write_optimized_stream(ostream& stream,
+                                               optimize_options const&
+                                                   options
+                                                   = optimize_options())
+        {
+            std::vector< byte > best;
+            optimize_report report = detail::run_trials(
+                [this](std::vector< byte >& out,
+                       compression_profile const& profile)
+                {
+                    memory_ostream sink(out);
+                    image_info info(m_info);
+                    pixel_generator pixgen(info, m_pixbuf);
+                    pixgen.write(sink, profile);
+                }, options, best);
+            stream.write(reinterpret_cast< char const* >(& best[0]),
+                         best.size());
+            if (!stream.good())
+            {
+                throw error("ostream::write() failed");
+            }
+            return report;
+        }
+#endif
+
         /**
          * \brief Returns a reference to image pixel buffer.
          */
@@ -303,11 +824,19 @@ namespace png
         /**
          * \brief Replaces the image pixel buffer.
          *
+         * The image width and height are set to those of the
+         * buffer, as resize() does.  Earlier versions left the
+         * %image %info at its previous size, so after replacing the
+         * buffer with one of another size write() used the old
+         * dimensions or threw std::out_of_range.
+         *
          * \param buffer  a pixel buffer object to take a copy from
          */
         void set_pixbuf(pixbuf const& buffer)
         {
             m_pixbuf = buffer;
+            m_info.set_width(m_pixbuf.get_width());
+            m_info.set_height(m_pixbuf.get_height());
         }
 
         size_t get_width() const
@@ -453,6 +982,102 @@ namespace png
             m_info.set_tRNS(trns);
         }
 
+    private:
+        /*
+         * Opens \a filename, memory-mapped or not (see read()), and
+         * passes the stream to \a read_fn.
+         */
+        template< class read_function >
+        static void read_file(char const* filename,
+                              read_function const& read_fn)
+        {
+#if defined(PNGPP_USE_MMAP) && defined(PNGPP_HAS_MMAP)
+            mapped_file file(filename);
+            memory_istream stream(file.get_data(), file.get_size());
+            read_fn(stream);
+#else
+            std::ifstream stream(filename, std::ios::binary);
+            if (!stream.is_open())
+            {
+                throw std_error(filename);
+            }
+            stream.exceptions(std::ios::badbit);
+            read_fn(stream);
+#endif
+        }
+
+        template< class transformation >
+        struct stream_reader
+        {
+            stream_reader(image& img, transformation const& transform)
+                : m_image(img),
+                  m_transform(transform)
+            {
+            }
+
+            template< class istream >
+            void operator()(istream& stream) const
+            {
+                m_image.read_stream(stream, m_transform);
+            }
+
+            image& m_image;
+            transformation const& m_transform;
+        };
+
+        template< class transformation >
+        struct region_reader
+        {
+            region_reader(image& img,
+                          size_t x, size_t y, size_t width, size_t height,
+                          transformation const& transform)
+                : m_image(img),
+                  m_x(x),
+                  m_y(y),
+                  m_width(width),
+                  m_height(height),
+                  m_transform(transform)
+            {
+            }
+
+            template< class istream >
+            void operator()(istream& stream) const
+            {
+                m_image.read_region_stream(stream, m_x, m_y,
+                                           m_width, m_height, m_transform);
+            }
+
+            image& m_image;
+            size_t m_x;
+            size_t m_y;
+            size_t m_width;
+            size_t m_height;
+            transformation const& m_transform;
+        };
+
+        template< class transformation, class pass_callback >
+        struct progressive_reader
+        {
+            progressive_reader(image& img, transformation const& transform,
+                               pass_callback const& callback)
+                : m_image(img),
+                  m_transform(transform),
+                  m_callback(callback)
+            {
+            }
+
+            template< class istream >
+            void operator()(istream& stream) const
+            {
+                m_image.read_progressive_stream(stream, m_transform,
+                                                m_callback);
+            }
+
+            image& m_image;
+            transformation const& m_transform;
+            pass_callback const& m_callback;
+        };
+
     protected:
         /**
          * \brief A common base class template for pixel_consumer and
@@ -480,8 +1105,64 @@ namespace png
                     (row_traits::get_data(m_pixbuf.get_row(pos)));
             }
 
+            /**
+             * \brief Stores the starting addresses of \a count rows
+             * from \c pos on into \a rows.
+             *
+             * Throws std::out_of_range if the pixel buffer has fewer
+             * rows, like get_next_row().
+             */
+            size_t get_next_rows(size_t pos, size_t count, byte** rows)
+            {
+                typedef typename pixbuf::row_traits row_traits;
+                if (pos + count > m_pixbuf.get_height())
+                {
+                    throw std::out_of_range("image: pixel buffer is shorter"
+                                            " than the image");
+                }
+                for (size_t i = 0; i < count; ++i)
+                {
+                    rows[i] = reinterpret_cast< byte* >
+                        (row_traits::get_data(m_pixbuf[pos + i]));
+                }
+                return count;
+            }
+
         protected:
+            /**
+             * \brief Returns a table of the starting addresses of all
+             * the rows of the image in the pixel buffer.
+             *
+             * libpng reads or writes as many rows as the image info
+             * tells, so the pixel buffer is checked once to be at
+             * least that large: std::out_of_range is thrown if it is
+             * shorter or narrower.
+             */
+            byte** get_row_table()
+            {
+                typedef typename pixbuf::row_traits row_traits;
+                size_t const height = this->get_info().get_height();
+                if (m_pixbuf.get_height() < height
+                    || m_pixbuf.get_width() < this->get_info().get_width())
+                {
+                    throw std::out_of_range("image: pixel buffer is smaller"
+                                            " than the image");
+                }
+                if (height == 0)
+                {
+                    return 0;
+                }
+                m_rows.resize(height);
+                for (size_t i = 0; i < height; ++i)
+                {
+                    m_rows[i] = reinterpret_cast< byte* >
+                        (row_traits::get_data(m_pixbuf[i]));
+                }
+                return & m_rows[0];
+            }
+
             pixbuf& m_pixbuf;
+            std::vector< byte* > m_rows;
         };
 
         /**
@@ -510,6 +1191,167 @@ namespace png
                                           this->get_info().get_height());
                 }
             }
+
+            byte** get_image_rows()
+            {
+                return this->get_row_table();
+            }
+        };
+
+        /**
+         * \brief The pixel buffer adapter for reading pixel data
+         * with a callback after every pass.
+         */
+        template< class pass_callback >
+        class progressive_consumer
+            : public streaming_impl< consumer< pixel,
+                                               progressive_consumer
+                                               < pass_callback >,
+                                               image_info_ref_holder,
+                                               /* interlacing = */ true > >
+        {
+        public:
+            progressive_consumer(image_info& info, pixbuf& pixels,
+                                 pass_callback const& callback)
+                : streaming_impl< consumer< pixel,
+                                            progressive_consumer,
+                                            image_info_ref_holder,
+                                            true > >(info, pixels),
+                  m_callback(callback)
+            {
+            }
+
+            void reset(size_t pass)
+            {
+                if (pass == 0)
+                {
+                    this->m_pixbuf.resize(this->get_info().get_width(),
+                                          this->get_info().get_height());
+                }
+            }
+
+            bool finish_pass(size_t pass)
+            {
+                bool const interlaced = this->get_info().get_interlace_type()
+                    != interlace_none;
+                return m_callback(preview(this->m_pixbuf, pass, interlaced));
+            }
+
+        private:
+            pass_callback const& m_callback;
+        };
+
+        /**
+         * \brief The pixel buffer adapter for reading a region of
+         * the image.
+         */
+        class region_consumer
+            : public consumer< pixel,
+                               region_consumer,
+                               image_info_ref_holder,
+                               /* interlacing = */ true >
+        {
+        public:
+            region_consumer(image_info& info, pixbuf& pixels,
+                            size_t x, size_t y, size_t width, size_t height)
+                : consumer< pixel,
+                            region_consumer,
+                            image_info_ref_holder,
+                            true >(info),
+                  m_pixbuf(pixels),
+                  m_x(x),
+                  m_y(y),
+                  m_width(width),
+                  m_height(height),
+                  m_pass(0),
+                  m_last_pass(0),
+                  m_direct(false),
+                  m_interlaced(false)
+            {
+            }
+
+            void reset(size_t pass)
+            {
+                m_pass = pass;
+                if (pass != 0)
+                {
+                    return;
+                }
+                size_t const width = this->get_info().get_width();
+                size_t const height = this->get_info().get_height();
+                if (m_x > width || m_width > width - m_x
+                    || m_y > height || m_height > height - m_y)
+                {
+                    throw std::out_of_range("png::image::read_region():"
+                                            " region exceeds the image");
+                }
+                m_interlaced = this->get_info().get_interlace_type()
+                    != interlace_none;
+                m_last_pass = m_interlaced ? 6 : 0;
+                m_direct = m_x == 0 && m_width == width;
+
+                m_pixbuf.resize(m_width, m_height);
+                m_skip.resize(width, 1);
+                // whole rows are kept for libpng to combine passes
+                m_band.resize(m_direct ? 0 : width,
+                              m_direct ? 0 : m_interlaced ? m_height : 1);
+            }
+
+            byte* get_next_row(size_t pos)
+            {
+                if (pos < m_y || pos - m_y >= m_height)
+                {
+                    return get_data(m_skip[0]);
+                }
+                if (m_direct)
+                {
+                    typedef typename pixbuf::row_traits row_traits;
+                    return reinterpret_cast< byte* >
+                        (row_traits::get_data(m_pixbuf[pos - m_y]));
+                }
+                return get_data(m_band[m_interlaced ? pos - m_y : 0]);
+            }
+
+            bool finish_row(size_t pos)
+            {
+                if (pos < m_y || pos - m_y >= m_height
+                    || m_pass != m_last_pass)
+                {
+                    return true;
+                }
+                if (!m_direct)
+                {
+                    typename band_buffer::row_access src
+                        = m_band[m_interlaced ? pos - m_y : 0];
+                    row_access dst = m_pixbuf[pos - m_y];
+                    for (size_t i = 0; i < m_width; ++i)
+                    {
+                        dst[i] = src[m_x + i];
+                    }
+                }
+                return pos - m_y + 1 < m_height;
+            }
+
+        private:
+            typedef pixel_buffer< pixel > band_buffer;
+
+            static byte* get_data(typename band_buffer::row_access row)
+            {
+                typedef typename band_buffer::row_traits row_traits;
+                return reinterpret_cast< byte* >(row_traits::get_data(row));
+            }
+
+            pixbuf& m_pixbuf;
+            band_buffer m_band;
+            band_buffer m_skip;
+            size_t m_x;
+            size_t m_y;
+            size_t m_width;
+            size_t m_height;
+            size_t m_pass;
+            size_t m_last_pass;
+            bool m_direct;
+            bool m_interlaced;
         };
 
         /**
@@ -529,6 +1371,11 @@ namespace png
                                              true > >(info, pixels)
             {
             }
+
+            byte** get_image_rows()
+            {
+                return this->get_row_table();
+            }
         };
 
         image_info m_info;
@@ -0,0 +1 @@
+../../adam7.hpp
\ No newline at end of file
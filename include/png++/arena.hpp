@@ -0,0 +1 @@
+../../arena.hpp
\ No newline at end of file
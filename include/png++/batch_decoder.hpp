@@ -0,0 +1 @@
+../../batch_decoder.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../compression_profile.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../contiguous_pixel_buffer.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../downscale_consumer.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../filter_strategy.hpp
\ No newline at end of file
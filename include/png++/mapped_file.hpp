@@ -0,0 +1 @@
+../../mapped_file.hpp
\ No newline at end of file
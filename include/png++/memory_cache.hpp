@@ -0,0 +1 @@
+../../memory_cache.hpp
\ No newline at end of file
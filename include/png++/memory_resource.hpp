@@ -0,0 +1 @@
+../../memory_resource.hpp
\ No newline at end of file
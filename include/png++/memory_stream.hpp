@@ -0,0 +1 @@
+../../memory_stream.hpp
\ No newline at end of file
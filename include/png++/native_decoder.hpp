@@ -0,0 +1 @@
+../../native_decoder.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../native_encoder.hpp
\ No newline at end of file
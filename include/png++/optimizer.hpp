@@ -0,0 +1 @@
+../../optimizer.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../parallel_encoder.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../pixel_buffer_view.hpp
\ No newline at end of file
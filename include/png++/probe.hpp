@@ -0,0 +1 @@
+../../probe.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../push_consumer.hpp
\ No newline at end of file
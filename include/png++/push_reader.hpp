@@ -0,0 +1 @@
+../../push_reader.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../quantizer.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../reduction.hpp
\ No newline at end of file
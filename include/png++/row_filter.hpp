@@ -0,0 +1 @@
+../../row_filter.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../thread_pool.hpp
\ No newline at end of file
@@ -0,0 +1 @@
+../../trusted_input.hpp
\ No newline at end of file
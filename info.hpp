@@ -58,6 +58,19 @@ namespace png
             assert(m_info);
 
             png_read_info(m_png, m_info);
+            fetch();
+        }
+
+        /**
+         * \brief Retrieves image %info from the png_info structure
+         * already filled in by libpng (e.g. by the progressive
+         * reader).
+         */
+        void fetch()
+        {
+            assert(m_png);
+            assert(m_info);
+
             png_get_IHDR(m_png,
                          m_info,
                          & m_width,
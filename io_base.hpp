@@ -37,6 +37,7 @@
 #include "error.hpp"
 #include "info.hpp"
 #include "end_info.hpp"
+#include "memory_resource.hpp"
 
 static void
 trace_io_transform(char const* fmt, ...)
@@ -415,7 +416,81 @@ namespace png
         }
 #endif
 
+#ifdef PNG_READ_SUPPORTED
+        /**
+         * \brief Sets what to do on a CRC error in critical and
+         * ancillary chunks.
+         */
+        void set_crc_action(crc_action critical, crc_action ancillary) const
+        {
+            TRACE_IO_TRANSFORM("png_set_crc_action: critical=%d,"
+                               " ancillary=%d\n", critical, ancillary);
+            png_set_crc_action(m_png, critical, ancillary);
+        }
+#endif
+
+#ifdef PNG_HANDLE_AS_UNKNOWN_SUPPORTED
+        /**
+         * \brief Sets how to handle the \a count chunks named in \a
+         * chunks (4 bytes each): see png_set_keep_unknown_chunks().
+         *
+         * A \a count of 0 sets the default for unknown chunks, a
+         * negative one applies to every chunk but IHDR, PLTE, tRNS,
+         * IDAT and IEND.
+         */
+        void set_keep_unknown_chunks(chunk_handling keep,
+                                     byte const* chunks = 0,
+                                     int count = 0) const
+        {
+            TRACE_IO_TRANSFORM("png_set_keep_unknown_chunks: keep=%d,"
+                               " count=%d\n", keep, count);
+            png_set_keep_unknown_chunks(m_png, keep, chunks, count);
+        }
+#endif
+
     protected:
+        /**
+         * \brief Creates a png_struct for reading, reporting errors
+         * to \a io.  Uses the thread's current memory_resource, if any.
+         */
+        static png_struct* create_read_struct(io_base* io)
+        {
+#ifdef PNG_USER_MEM_SUPPORTED
+            if (memory_resource* resource
+                = memory_resource::get_current())
+            {
+                return png_create_read_struct_2(PNG_LIBPNG_VER_STRING,
+                                                io, raise_error, 0,
+                                                resource,
+                                                memory_resource::malloc_fn,
+                                                memory_resource::free_fn);
+            }
+#endif
+            return png_create_read_struct(PNG_LIBPNG_VER_STRING,
+                                          io, raise_error, 0);
+        }
+
+        /**
+         * \brief Creates a png_struct for writing, reporting errors
+         * to \a io.  Uses the thread's current memory_resource, if any.
+         */
+        static png_struct* create_write_struct(io_base* io)
+        {
+#ifdef PNG_USER_MEM_SUPPORTED
+            if (memory_resource* resource
+                = memory_resource::get_current())
+            {
+                return png_create_write_struct_2(PNG_LIBPNG_VER_STRING,
+                                                 io, raise_error, 0,
+                                                 resource,
+                                                 memory_resource::malloc_fn,
+                                                 memory_resource::free_fn);
+            }
+#endif
+            return png_create_write_struct(PNG_LIBPNG_VER_STRING,
+                                           io, raise_error, 0);
+        }
+
         void* get_io_ptr() const
         {
             return png_get_io_ptr(m_png);
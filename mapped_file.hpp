@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_MAPPED_FILE_HPP_INCLUDED
+#define PNGPP_MAPPED_FILE_HPP_INCLUDED
+
+#include "config.hpp"
+
+#ifdef PNGPP_HAS_MMAP
+
+#include <cerrno>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "error.hpp"
+#include "types.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief Read-only memory mapping of a whole file.
+     *
+     * The mapping is advised for sequential access, so the kernel
+     * reads ahead and the page cache serves the data directly--no
+     * user-space read copies are made.  Use it together with
+     * memory_istream:
+     *
+     * \code
+     * png::mapped_file file("input.png");
+     * png::memory_istream stream(file.get_data(), file.get_size());
+     * image.read_stream(stream);
+     * \endcode
+     *
+     * Define \c PNGPP_USE_MMAP before including png++ headers to make
+     * image::read(char const*) use a mapped_file instead of \c
+     * std::ifstream.
+     *
+     * Available on POSIX systems only (see \c PNGPP_HAS_MMAP in
+     * config.hpp).
+     *
+     * \see memory_istream, image::read
+     */
+    class mapped_file
+    {
+        mapped_file(mapped_file const&);
+        mapped_file& operator=(mapped_file const&);
+
+    public:
+        /**
+         * \brief Maps the file named \a filename into memory.
+         * Throws std_error if the file could not be opened or
+         * mapped.
+         */
+        explicit mapped_file(char const* filename)
+            : m_data(0),
+              m_size(0)
+        {
+            int fd = open(filename, O_RDONLY);
+            if (fd == -1)
+            {
+                throw std_error(filename);
+            }
+            struct stat st;
+            if (fstat(fd, & st) == -1)
+            {
+                int err = errno;
+                close(fd);
+                throw std_error(filename, err);
+            }
+            m_size = st.st_size;
+            if (m_size != 0)
+            {
+                void* data = mmap(0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data == MAP_FAILED)
+                {
+                    int err = errno;
+                    close(fd);
+                    throw std_error(filename, err);
+                }
+                m_data = static_cast< byte* >(data);
+#ifdef MADV_SEQUENTIAL
+                madvise(data, m_size, MADV_SEQUENTIAL);
+#endif
+            }
+            close(fd);
+        }
+
+        ~mapped_file()
+        {
+            if (m_data)
+            {
+                munmap(m_data, m_size);
+            }
+        }
+
+        byte const* get_data() const
+        {
+            return m_data;
+        }
+
+        size_t get_size() const
+        {
+            return m_size;
+        }
+
+    private:
+        byte* m_data;
+        size_t m_size;
+    };
+
+} // namespace png
+
+#endif // PNGPP_HAS_MMAP
+
+#endif // PNGPP_MAPPED_FILE_HPP_INCLUDED
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_MEMORY_CACHE_HPP_INCLUDED
+#define PNGPP_MEMORY_CACHE_HPP_INCLUDED
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "memory_resource.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief Recycles the memory libpng and zlib allocate for reader
+     * and writer objects.
+     *
+     * Every reader and writer allocates a png_struct, the %info
+     * structs and the zlib inflate or deflate state (about 256 KB
+     * for deflate with default settings), and frees them again on
+     * destruction.  For high rates of small images these
+     * allocations, and the page faults on freshly mapped memory,
+     * dominate the cost.  libpng cannot reset a png_struct for a new
+     * image, so instead the blocks are kept by a memory_cache when
+     * freed and handed out again to the next reader or writer asking
+     * for the same size--the memory stays warm in the caches and the
+     * system allocator is not involved after the first image.
+     *
+     * Readers and writers use the cache made current for the
+     * calling thread by a memory_resource::scope object:
+     *
+     * \code
+     * png::memory_cache cache;
+     * png::memory_cache::scope use_cache(cache);
+     * for (...)
+     * {
+     *     png::image< png::rgba_pixel > image(filename);
+     *     ...
+     * }
+     * \endcode
+     *
+     * A memory_cache is not thread-safe: use one per thread.  It
+     * must outlive the readers and writers created in its scope.
+     *
+     * Requires libpng built with PNG_USER_MEM_SUPPORTED; otherwise
+     * the cache is never used.
+     *
+     * \see memory_resource, arena, reader, writer
+     */
+    class memory_cache
+        : public memory_resource
+    {
+    public:
+        /**
+         * \brief Constructs an empty cache retaining at most \a
+         * max_size bytes of freed memory.
+         */
+        explicit memory_cache(size_t max_size = 4 * 1024 * 1024)
+            : m_max_size(max_size),
+              m_size(0)
+        {
+        }
+
+        ~memory_cache()
+        {
+            trim();
+        }
+
+        /**
+         * \brief Allocates \a size bytes, reusing a retained block of
+         * the same size if available.  Throws std::bad_alloc on
+         * failure.
+         */
+        virtual void* allocate(size_t size)
+        {
+            for (size_t i = 0; i < m_bins.size(); ++i)
+            {
+                bin& b = m_bins[i];
+                if (b.size == size && b.head)
+                {
+                    block* blk = b.head;
+                    b.head = blk->next;
+                    m_size -= size;
+                    return blk + 1;
+                }
+            }
+            block* blk = static_cast< block* >
+                (std::malloc(sizeof(block) + size));
+            if (!blk)
+            {
+                throw std::bad_alloc();
+            }
+            blk->size = size;
+            return blk + 1;
+        }
+
+        /**
+         * \brief Returns a block obtained from allocate() to the
+         * cache, or frees it if the cache is full.
+         */
+        virtual void deallocate(void* ptr)
+        {
+            if (!ptr)
+            {
+                return;
+            }
+            block* blk = static_cast< block* >(ptr) - 1;
+            if (m_size + blk->size <= m_max_size)
+            {
+                for (size_t i = 0; i < m_bins.size(); ++i)
+                {
+                    bin& b = m_bins[i];
+                    if (b.size == blk->size)
+                    {
+                        retain(b, blk);
+                        return;
+                    }
+                }
+                if (m_bins.size() < max_bins)
+                {
+                    m_bins.push_back(bin(blk->size));
+                    retain(m_bins.back(), blk);
+                    return;
+                }
+            }
+            std::free(blk);
+        }
+
+        /**
+         * \brief Frees all the retained memory.
+         */
+        void trim()
+        {
+            for (size_t i = 0; i < m_bins.size(); ++i)
+            {
+                while (block* blk = m_bins[i].head)
+                {
+                    m_bins[i].head = blk->next;
+                    std::free(blk);
+                }
+            }
+            m_bins.clear();
+            m_size = 0;
+        }
+
+        /**
+         * \brief Returns the number of bytes currently retained.
+         */
+        size_t get_size() const
+        {
+            return m_size;
+        }
+
+    private:
+        /*
+         * The header preceding every block.  Retained blocks are
+         * linked through it.  Its size (two words) keeps the payload
+         * aligned as well as malloc() does on common platforms.
+         */
+        struct block
+        {
+            size_t size;
+            block* next;
+        };
+
+        struct bin
+        {
+            explicit bin(size_t block_size)
+                : size(block_size),
+                  head(0)
+            {
+            }
+
+            size_t size;
+            block* head;
+        };
+
+        static size_t const max_bins = 32;
+
+        void retain(bin& b, block* blk)
+        {
+            blk->next = b.head;
+            b.head = blk;
+            m_size += blk->size;
+        }
+
+        std::vector< bin > m_bins;
+        size_t m_max_size;
+        size_t m_size;
+    };
+
+} // namespace png
+
+#endif // PNGPP_MEMORY_CACHE_HPP_INCLUDED
@@ -0,0 +1,478 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_MEMORY_RESOURCE_HPP_INCLUDED
+#define PNGPP_MEMORY_RESOURCE_HPP_INCLUDED
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#ifdef PNGPP_HAS_STD_MOVE
+#include <type_traits>
+#endif
+
+#include "config.hpp"
+#include "types.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief The abstract source of memory for libpng, zlib and
+     * pixel buffers.
+     *
+     * By default png++ and libpng allocate from the global heap.  A
+     * memory_resource made current for the calling thread with a
+     * memory_resource::scope object serves instead:
+     *
+     * - the png_struct, %info structs and zlib state of every reader,
+     *   writer and push_reader created in the scope (provided libpng
+     *   was built with PNG_USER_MEM_SUPPORTED);
+     *
+     * - the rows of pixel buffers using png::allocator, e.g.
+     *   pixel_buffer< rgba_pixel, allocator< rgba_pixel > >, created
+     *   or resized in the scope.
+     *
+     * Implementations: memory_cache recycles freed blocks between
+     * images, arena serves a whole request from a few big chunks and
+     * releases it in one step.
+     *
+     * The memory returned by allocate() must be aligned as for
+     * malloc().
+     */
+    class memory_resource
+    {
+        memory_resource(memory_resource const&);
+        memory_resource& operator=(memory_resource const&);
+
+    public:
+        memory_resource()
+        {
+        }
+
+        virtual ~memory_resource()
+        {
+        }
+
+        /**
+         * \brief Allocates \a size bytes.  Throws std::bad_alloc on
+         * failure.
+         */
+        virtual void* allocate(size_t size) = 0;
+
+        /**
+         * \brief Returns a block obtained from allocate().  NULL is
+         * ignored.
+         */
+        virtual void deallocate(void* ptr) = 0;
+
+        /**
+         * \brief Makes a memory_resource current for the calling
+         * thread for the lifetime of the scope object.
+         */
+        class scope
+        {
+            scope(scope const&);
+            scope& operator=(scope const&);
+
+        public:
+            explicit scope(memory_resource& resource)
+                : m_previous(get_current_ref())
+            {
+                get_current_ref() = & resource;
+            }
+
+            ~scope()
+            {
+                get_current_ref() = m_previous;
+            }
+
+        private:
+            memory_resource* m_previous;
+        };
+
+        /**
+         * \brief Returns the resource current for the calling thread
+         * or NULL if there is none.
+         */
+        static memory_resource* get_current()
+        {
+            return get_current_ref();
+        }
+
+#ifdef PNG_USER_MEM_SUPPORTED
+        /**
+         * \brief libpng allocation callback: \c mem_ptr must point
+         * to a memory_resource.
+         */
+        static png_voidp malloc_fn(png_struct* png, png_alloc_size_t size)
+        {
+            memory_resource* resource
+                = static_cast< memory_resource* >(png_get_mem_ptr(png));
+            try
+            {
+                return resource->allocate(size);
+            }
+            catch (std::bad_alloc const&)
+            {
+                return 0;
+            }
+        }
+
+        static void free_fn(png_struct* png, png_voidp ptr)
+        {
+            memory_resource* resource
+                = static_cast< memory_resource* >(png_get_mem_ptr(png));
+            resource->deallocate(ptr);
+        }
+#endif
+
+    private:
+        static memory_resource*& get_current_ref()
+        {
+            static PNGPP_THREAD_LOCAL memory_resource* current = 0;
+            return current;
+        }
+    };
+
+    /**
+     * \brief Standard library allocator drawing from a
+     * memory_resource.
+     *
+     * A default-constructed allocator binds to the resource current
+     * for the calling thread at that moment, or to the global heap if
+     * there is none.  Containers keep their allocator, so a pixel
+     * buffer created in a memory_resource::scope keeps allocating
+     * from that resource after the scope ends--the resource must
+     * outlive it.
+     *
+     * Swapping and move-assigning containers also move the
+     * allocator along with the memory, so buffers bound to different
+     * resources may be exchanged.  This needs C++11 allocator
+     * propagation: without it (C++98) only exchange buffers
+     * allocated from the same resource.  Copy assignment keeps the
+     * destination's resource.
+     *
+     * \code
+     * png::arena arena;
+     * png::memory_resource::scope use_arena(arena);
+     * png::image< png::rgba_pixel,
+     *             png::pixel_buffer< png::rgba_pixel,
+     *                                png::allocator< png::rgba_pixel > > >
+     *     image(filename);
+     * \endcode
+     */
+    template< typename T >
+    class allocator
+    {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef T const* const_pointer;
+        typedef T& reference;
+        typedef T const& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template< typename U >
+        struct rebind
+        {
+            typedef allocator< U > other;
+        };
+
+#ifdef PNGPP_HAS_STD_MOVE
+        typedef std::true_type propagate_on_container_swap;
+        typedef std::true_type propagate_on_container_move_assignment;
+#endif
+
+        allocator()
+            : m_resource(memory_resource::get_current())
+        {
+        }
+
+        explicit allocator(memory_resource* resource)
+            : m_resource(resource)
+        {
+        }
+
+        template< typename U >
+        allocator(allocator< U > const& other)
+            : m_resource(other.get_resource())
+        {
+        }
+
+        /**
+         * \brief Returns the resource allocated from, or NULL for
+         * the global heap.
+         */
+        memory_resource* get_resource() const
+        {
+            return m_resource;
+        }
+
+        pointer allocate(size_type n, void const* = 0)
+        {
+            if (n > max_size())
+            {
+                throw std::bad_alloc();
+            }
+            size_t size = n * sizeof(T);
+            return static_cast< pointer >
+                (m_resource
+                 ? m_resource->allocate(size)
+                 : ::operator new(size));
+        }
+
+        void deallocate(pointer ptr, size_type)
+        {
+            if (m_resource)
+            {
+                m_resource->deallocate(ptr);
+            }
+            else
+            {
+                ::operator delete(ptr);
+            }
+        }
+
+        size_type max_size() const
+        {
+            return std::numeric_limits< size_type >::max() / sizeof(T);
+        }
+
+        pointer address(reference x) const
+        {
+            return & x;
+        }
+
+        const_pointer address(const_reference x) const
+        {
+            return & x;
+        }
+
+        void construct(pointer ptr, const_reference value)
+        {
+            new (ptr) T(value);
+        }
+
+        void destroy(pointer ptr)
+        {
+            ptr->~T();
+        }
+
+    private:
+        memory_resource* m_resource;
+    };
+
+    template< typename T, typename U >
+    bool operator==(allocator< T > const& a, allocator< U > const& b)
+    {
+        return a.get_resource() == b.get_resource();
+    }
+
+    template< typename T, typename U >
+    bool operator!=(allocator< T > const& a, allocator< U > const& b)
+    {
+        return a.get_resource() != b.get_resource();
+    }
+
+    /**
+     * \brief Standard library allocator returning blocks aligned to
+     * \a alignment bytes.
+     *
+     * Like png::allocator, it draws from the memory_resource current
+     * when it was constructed, or from the global heap.  Each block
+     * is over-allocated by \a alignment bytes plus a pointer to the
+     * underlying block, so use it for large buffers such as
+     * solid_pixel_buffer rather than for many small rows.
+     * Swapping and move assignment propagate it like png::allocator.
+     * \a alignment must be a power of two.
+     *
+     * \code
+     * png::image< png::rgba_pixel,
+     *             png::solid_pixel_buffer
+     *             < png::rgba_pixel,
+     *               png::aligned_allocator< png::rgba_pixel, 64 >,
+     *               64 > > image(filename);
+     * \endcode
+     */
+    template< typename T, size_t alignment = 64 >
+    class aligned_allocator
+    {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef T const* const_pointer;
+        typedef T& reference;
+        typedef T const& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template< typename U >
+        struct rebind
+        {
+            typedef aligned_allocator< U, alignment > other;
+        };
+
+#ifdef PNGPP_HAS_STD_MOVE
+        typedef std::true_type propagate_on_container_swap;
+        typedef std::true_type propagate_on_container_move_assignment;
+#endif
+
+        aligned_allocator()
+            : m_resource(memory_resource::get_current())
+        {
+        }
+
+        explicit aligned_allocator(memory_resource* resource)
+            : m_resource(resource)
+        {
+        }
+
+        template< typename U >
+        aligned_allocator(aligned_allocator< U, alignment > const& other)
+            : m_resource(other.get_resource())
+        {
+        }
+
+        /**
+         * \brief Returns the resource allocated from, or NULL for
+         * the global heap.
+         */
+        memory_resource* get_resource() const
+        {
+            return m_resource;
+        }
+
+        pointer allocate(size_type n, void const* = 0)
+        {
+            if (n > max_size())
+            {
+                throw std::bad_alloc();
+            }
+            size_t size = n * sizeof(T) + alignment + sizeof(void*);
+            void* block = m_resource
+                ? m_resource->allocate(size)
+                : ::operator new(size);
+            size_t address = reinterpret_cast< size_t >(block)
+                + sizeof(void*) + alignment - 1;
+            address &= ~(alignment - 1);
+            reinterpret_cast< void** >(address)[-1] = block;
+            return reinterpret_cast< pointer >(address);
+        }
+
+        void deallocate(pointer ptr, size_type)
+        {
+            void* block = reinterpret_cast< void** >(ptr)[-1];
+            if (m_resource)
+            {
+                m_resource->deallocate(block);
+            }
+            else
+            {
+                ::operator delete(block);
+            }
+        }
+
+        size_type max_size() const
+        {
+            return (std::numeric_limits< size_type >::max()
+                    - alignment - sizeof(void*)) / sizeof(T);
+        }
+
+        pointer address(reference x) const
+        {
+            return & x;
+        }
+
+        const_pointer address(const_reference x) const
+        {
+            return & x;
+        }
+
+        void construct(pointer ptr, const_reference value)
+        {
+            new (ptr) T(value);
+        }
+
+        void destroy(pointer ptr)
+        {
+            ptr->~T();
+        }
+
+    private:
+        memory_resource* m_resource;
+
+#ifdef PNGPP_HAS_STATIC_ASSERT
+        static_assert(alignment != 0 && (alignment & (alignment - 1)) == 0,
+                      "alignment should be a power of two");
+#endif
+    };
+
+    template< typename T, typename U, size_t alignment >
+    bool operator==(aligned_allocator< T, alignment > const& a,
+                    aligned_allocator< U, alignment > const& b)
+    {
+        return a.get_resource() == b.get_resource();
+    }
+
+    template< typename T, typename U, size_t alignment >
+    bool operator!=(aligned_allocator< T, alignment > const& a,
+                    aligned_allocator< U, alignment > const& b)
+    {
+        return a.get_resource() != b.get_resource();
+    }
+
+    namespace detail
+    {
+
+        /**
+         * \brief Yields the type of \a alloc rebound to allocate
+         * objects of type \a U.
+         */
+        template< class alloc, typename U >
+        struct rebind_allocator
+        {
+            typedef typename alloc::template rebind< U >::other type;
+        };
+
+        // std::allocator lost its rebind member in C++20
+        template< typename T, typename U >
+        struct rebind_allocator< std::allocator< T >, U >
+        {
+            typedef std::allocator< U > type;
+        };
+
+    } // namespace detail
+
+} // namespace png
+
+#endif // PNGPP_MEMORY_RESOURCE_HPP_INCLUDED
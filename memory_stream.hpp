@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_MEMORY_STREAM_HPP_INCLUDED
+#define PNGPP_MEMORY_STREAM_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "types.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief Input stream class to read PNG data from a memory
+     * buffer.
+     *
+     * Implements the minimal stream interface required by the reader
+     * class template (see reader), so it can be passed to
+     * consumer::read() and image::read_stream() directly:
+     *
+     * \code
+     * png::memory_istream stream(data, size);
+     * png::image< png::rgb_pixel > image;
+     * image.read_stream(stream);
+     * \endcode
+     *
+     * The buffer is not copied and must stay valid while the stream
+     * is in use.  Unlike \c std::istringstream there is no stream
+     * buffer involved: every read() is a plain inline memcpy() from
+     * the current position.
+     *
+     * \see reader, consumer, image
+     */
+    class memory_istream
+    {
+    public:
+        /**
+         * \brief Constructs a stream reading \a size bytes starting
+         * at \a data.
+         */
+        memory_istream(void const* data, size_t size)
+            : m_data(static_cast< byte const* >(data)),
+              m_size(size),
+              m_pos(0),
+              m_good(true)
+        {
+        }
+
+        /**
+         * \brief Reads \a count bytes into \a buffer.  An attempt to
+         * read past the end of the data copies what is left and puts
+         * the stream into a failed state.
+         */
+        void read(char* buffer, size_t count)
+        {
+            if (count > m_size - m_pos)
+            {
+                count = m_size - m_pos;
+                m_good = false;
+            }
+            std::memcpy(buffer, m_data + m_pos, count);
+            m_pos += count;
+        }
+
+        bool good() const
+        {
+            return m_good;
+        }
+
+        /**
+         * \brief Returns the start of the underlying buffer.
+         */
+        byte const* get_data() const
+        {
+            return m_data;
+        }
+
+        /**
+         * \brief Returns the size of the underlying buffer.
+         */
+        size_t get_size() const
+        {
+            return m_size;
+        }
+
+        /**
+         * \brief Returns the number of bytes consumed so far.
+         */
+        size_t get_position() const
+        {
+            return m_pos;
+        }
+
+    private:
+        byte const* m_data;
+        size_t m_size;
+        size_t m_pos;
+        bool m_good;
+    };
+
+    /**
+     * \brief Output stream class to write PNG data into memory.
+     *
+     * Implements the minimal stream interface required by the writer
+     * class template (see writer), so it can be passed to
+     * generator::write() and image::write_stream() directly.  The
+     * encoded data is stored either in a caller-supplied \c
+     * std::vector (which grows geometrically as needed):
+     *
+     * \code
+     * std::vector< png::byte > buffer;
+     * png::memory_ostream stream(buffer);
+     * image.write_stream(stream);
+     * // buffer now holds the PNG data
+     * \endcode
+     *
+     * or in a fixed caller-supplied buffer; writing past the end of a
+     * fixed buffer puts the stream into a failed state, which makes
+     * the writer throw an error.  No intermediate copy is made in
+     * either case and flush() does nothing.
+     *
+     * \see writer, generator, image
+     */
+    class memory_ostream
+    {
+    public:
+        /**
+         * \brief Constructs a stream appending data to \a buffer.
+         * Reserve the vector beforehand (or reuse one) to avoid
+         * reallocations.
+         */
+        explicit memory_ostream(std::vector< byte >& buffer)
+            : m_vector(& buffer),
+              m_data(0),
+              m_capacity(0),
+              m_size(0),
+              m_good(true)
+        {
+        }
+
+        /**
+         * \brief Constructs a stream writing at most \a capacity
+         * bytes starting at \a data.
+         */
+        memory_ostream(void* data, size_t capacity)
+            : m_vector(0),
+              m_data(static_cast< byte* >(data)),
+              m_capacity(capacity),
+              m_size(0),
+              m_good(true)
+        {
+        }
+
+        void write(char const* data, size_t count)
+        {
+            if (m_vector)
+            {
+                m_vector->insert(m_vector->end(),
+                                 reinterpret_cast< byte const* >(data),
+                                 reinterpret_cast< byte const* >(data)
+                                 + count);
+                return;
+            }
+            if (count > m_capacity - m_size)
+            {
+                count = m_capacity - m_size;
+                m_good = false;
+            }
+            std::memcpy(m_data + m_size, data, count);
+            m_size += count;
+        }
+
+        void flush()
+        {
+        }
+
+        bool good() const
+        {
+            return m_good;
+        }
+
+        /**
+         * \brief Returns the number of bytes written so far.  For a
+         * vector-backed stream this is the size of the vector.
+         */
+        size_t get_size() const
+        {
+            return m_vector ? m_vector->size() : m_size;
+        }
+
+    private:
+        std::vector< byte >* m_vector;
+        byte* m_data;
+        size_t m_capacity;
+        size_t m_size;
+        bool m_good;
+    };
+
+} // namespace png
+
+#endif // PNGPP_MEMORY_STREAM_HPP_INCLUDED
@@ -0,0 +1,680 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_NATIVE_DECODER_HPP_INCLUDED
+#define PNGPP_NATIVE_DECODER_HPP_INCLUDED
+
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <zlib.h>
+
+#include "config.hpp"
+#include "error.hpp"
+#include "image_info.hpp"
+#include "io_base.hpp"
+#include "probe.hpp"
+#include "row_filter.hpp"
+#include "trusted_input.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief Decodes plain PNG data streams without libpng.
+     *
+     * Provides the row reading interface of the reader class
+     * (read_info(), read_row(), read_rows(), read_image() and
+     * read_end_info()) for the common case of a non-interlaced %image
+     * which is read in its own %color type and bit depth: the chunks
+     * are parsed here, the image data is inflated with zlib and the
+     * rows are reconstructed with the SSE2 kernels of row_filter.hpp
+     * (where available) straight into the caller's row buffers.  No
+     * libpng structures are set up, no \c setjmp() is involved and
+     * 16-bit samples are converted to host byte order while being
+     * copied.
+     *
+     * read_info() only parses the chunks up to the image data and
+     * keeps every byte it consumed, so the caller may give up and
+     * replay them to libpng (see get_header_data()) if the data
+     * stream is not understood (read_info() returns \c false) or
+     * needs transformations (can_decode() returns \c false).  This is
+     * what consumer::read() does when asked for native_decoding.  To
+     * bound that buffer, ancillary chunks taking it past libpng's user
+     * chunk allocation limit (8 MB by default) are skipped and left
+     * out of the replay; other chunks that large are left to libpng.
+     *
+     * Chunk CRCs and the zlib Adler-32 checksum are verified.
+     * Ancillary chunks are skipped, so only the IHDR fields, the
+     * palette and the palette transparency map end up in the image
+     * %info.
+     *
+     * \see native_decoding, consumer, reader
+     */
+    template< class istream >
+    class native_decoder
+    {
+    public:
+        explicit native_decoder(istream& stream)
+            : m_stream(stream),
+              m_inflating(false),
+              m_idat_left(0),
+              m_crc(0),
+              m_data_done(false),
+              m_have_chunk(false),
+              m_row_size(0),
+              m_bpp(0)
+        {
+        }
+
+        ~native_decoder()
+        {
+            if (m_inflating)
+            {
+                inflateEnd(& m_zstream);
+            }
+        }
+
+        /**
+         * \brief Parses the PNG signature and the chunks preceding
+         * the image data.  Returns \c false, without throwing, if the
+         * data stream is not one the decoder can handle on its own:
+         * an invalid header, a failed chunk CRC, an unknown critical
+         * chunk or a premature end of data.
+         */
+        bool read_info()
+        {
+            static byte const signature[8] =
+                { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+            if (!fetch_header(8)
+                || std::memcmp(& m_header[0], signature, 8) != 0)
+            {
+                return false;
+            }
+            bool have_ihdr = false;
+            for (;;)
+            {
+                size_t const start = m_header.size();
+                if (!fetch_header(8))
+                {
+                    return false;
+                }
+                uint_32 length = detail::probe_get_uint_32(& m_header[start]);
+                char name[4];
+                std::memcpy(name, & m_header[start + 4], 4);
+                if (length > PNG_UINT_31_MAX)
+                {
+                    return false;
+                }
+                if (std::memcmp(name, "IDAT", 4) == 0)
+                {
+                    if (!have_ihdr
+                        || (m_info.get_color_type() == color_type_palette
+                            && m_info.get_palette().empty()))
+                    {
+                        return false;
+                    }
+                    m_idat_left = length;
+                    m_crc = crc32(crc32(0, Z_NULL, 0),
+                                  & m_header[start + 4], 4);
+                    return true;
+                }
+                if (size_t(length) + m_header.size() > header_max)
+                {
+                    // too big to keep for the replay (libpng refuses
+                    // such chunks as well): drop an ancillary chunk
+                    if (!have_ihdr || !(name[0] & 0x20)
+                        || !skip_header(size_t(length) + 4))
+                    {
+                        return false;
+                    }
+                    m_header.resize(start);
+                    continue;
+                }
+                if (!fetch_header(size_t(length) + 4))
+                {
+                    return false;
+                }
+                byte const* data = & m_header[start + 8];
+                if (crc32(crc32(0, Z_NULL, 0), data - 4, length + 4)
+                    != detail::probe_get_uint_32(data + length))
+                {
+                    return false;
+                }
+
+                if (std::memcmp(name, "IHDR", 4) == 0)
+                {
+                    if (have_ihdr || length != 13 || !parse_ihdr(data))
+                    {
+                        return false;
+                    }
+                    have_ihdr = true;
+                }
+                else if (!have_ihdr)
+                {
+                    return false;
+                }
+                else if (std::memcmp(name, "PLTE", 4) == 0)
+                {
+                    if (length % 3 != 0 || length > 3 * 256
+                        || !m_info.get_palette().empty())
+                    {
+                        return false;
+                    }
+                    palette& plte = m_info.get_palette();
+                    plte.resize(length / 3);
+                    for (size_t i = 0; i < plte.size(); ++i)
+                    {
+                        plte[i] = color(data[3 * i],
+                                        data[3 * i + 1],
+                                        data[3 * i + 2]);
+                    }
+                }
+                else if (std::memcmp(name, "tRNS", 4) == 0)
+                {
+                    if (m_info.get_color_type() == color_type_palette)
+                    {
+                        if (length > m_info.get_palette().size())
+                        {
+                            return false;
+                        }
+                        m_info.get_tRNS().assign(data, data + length);
+                    }
+                }
+                else if (!(name[0] & 0x20)) // critical chunk
+                {
+                    return false;
+                }
+            }
+        }
+
+        /**
+         * \brief Returns the image %info parsed by read_info().
+         */
+        image_info const& get_image_info() const
+        {
+            return m_info;
+        }
+
+        /**
+         * \brief Tells whether the %image can be decoded into rows
+         * of the given %color type and bit depth, i.e. whether it is
+         * not interlaced and already in that format.
+         */
+        bool can_decode(color_type ctype, size_t bit_depth) const
+        {
+            return m_info.get_interlace_type() == interlace_none
+                && m_info.get_color_type() == ctype
+                && m_info.get_bit_depth() == bit_depth;
+        }
+
+        /**
+         * \brief Returns the bytes consumed by read_info(): the
+         * signature and the chunks up to and including the length
+         * and type of the first IDAT chunk.
+         */
+        byte const* get_header_data() const
+        {
+            return m_header.empty() ? 0 : & m_header[0];
+        }
+
+        size_t get_header_size() const
+        {
+            return m_header.size();
+        }
+
+        /**
+         * \brief Reads the next row of the %image into \a row.
+         */
+        void read_row(byte* row)
+        {
+            if (!m_inflating)
+            {
+                start();
+            }
+            inflate_data(& m_cur[0], m_row_size + 1);
+            if (!detail::unfilter_row(m_cur[0], & m_cur[1], & m_prev[1],
+                                      m_row_size, m_bpp))
+            {
+                throw error("bad adaptive filter value");
+            }
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+            if (m_info.get_bit_depth() == 16)
+            {
+                copy_swapped_16(row, & m_cur[1], m_row_size);
+            }
+            else
+#endif
+            {
+                std::memcpy(row, & m_cur[1], m_row_size);
+            }
+            m_cur.swap(m_prev);
+        }
+
+        /**
+         * \brief Reads \a count consecutive rows into the buffers
+         * listed in \a rows.
+         */
+        void read_rows(byte** rows, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                read_row(rows[i]);
+            }
+        }
+
+        /**
+         * \brief Reads the whole %image into the rows listed in \a
+         * rows, which must have an entry for every row.
+         */
+        void read_image(byte** rows)
+        {
+            read_rows(rows, m_info.get_height());
+        }
+
+        /**
+         * \brief Reads the rest of the data stream up to the IEND
+         * chunk, verifying the Adler-32 checksum of the image data
+         * and the chunk CRCs.
+         */
+        void read_end_info()
+        {
+            if (!m_inflating)
+            {
+                start();
+            }
+            // extra compressed data is tolerated like libpng does
+            byte dummy[64];
+            while (!m_data_done)
+            {
+                int ret = inflate_step(dummy, sizeof(dummy));
+                if (ret == Z_STREAM_END)
+                {
+                    break;
+                }
+            }
+            skip_idat();
+
+            for (;;)
+            {
+                byte header[8];
+                if (m_have_chunk)
+                {
+                    std::memcpy(header, m_chunk, 8);
+                    m_have_chunk = false;
+                }
+                else
+                {
+                    read_data(header, 8);
+                }
+                uint_32 length = detail::probe_get_uint_32(header);
+                char const* name = reinterpret_cast< char const* >(header + 4);
+                if (length > PNG_UINT_31_MAX)
+                {
+                    throw error("PNG unsigned integer out of range");
+                }
+                bool critical = !(name[0] & 0x20);
+                if (critical
+                    && std::memcmp(name, "IEND", 4) != 0
+                    && std::memcmp(name, "IDAT", 4) != 0)
+                {
+                    throw error(std::string(name, 4)
+                                + ": unknown critical chunk");
+                }
+                uLong crc = crc32(crc32(0, Z_NULL, 0), header + 4, 4);
+                while (length)
+                {
+                    size_t size = std::min(size_t(length), m_input.size());
+                    read_data(& m_input[0], size);
+                    crc = crc32(crc, & m_input[0], size);
+                    length -= size;
+                }
+                byte stored[4];
+                read_data(stored, 4);
+                if (critical && crc != detail::probe_get_uint_32(stored))
+                {
+                    throw error(std::string(name, 4) + ": CRC error");
+                }
+                if (std::memcmp(name, "IEND", 4) == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+    private:
+#if defined(PNG_USER_CHUNK_MALLOC_MAX) && PNG_USER_CHUNK_MALLOC_MAX > 0
+        static size_t const header_max = PNG_USER_CHUNK_MALLOC_MAX;
+#else
+        static size_t const header_max = 8000000;
+#endif
+
+        bool fetch_header(size_t count)
+        {
+            size_t const size = m_header.size();
+            m_header.resize(size + count);
+            m_stream.read(reinterpret_cast< char* >(& m_header[size]),
+                          count);
+            // keep only what was actually read for the replay
+            m_header.resize(size + size_t(m_stream.gcount()));
+            return m_stream.good();
+        }
+
+        bool skip_header(size_t count)
+        {
+            byte buffer[4096];
+            while (count)
+            {
+                size_t size = std::min(count, sizeof(buffer));
+                m_stream.read(reinterpret_cast< char* >(buffer), size);
+                if (!m_stream.good())
+                {
+                    return false;
+                }
+                count -= size;
+            }
+            return true;
+        }
+
+        void read_data(byte* buffer, size_t count)
+        {
+            m_stream.read(reinterpret_cast< char* >(buffer), count);
+            if (!m_stream.good())
+            {
+                throw error("istream::read() failed");
+            }
+        }
+
+        bool parse_ihdr(byte const* ihdr)
+        {
+            uint_32 width = detail::probe_get_uint_32(ihdr);
+            uint_32 height = detail::probe_get_uint_32(ihdr + 4);
+            if (width == 0 || height == 0
+                || width > PNG_USER_WIDTH_MAX || height > PNG_USER_HEIGHT_MAX
+                || !detail::probe_valid_bit_depth(ihdr[9], ihdr[8])
+                || ihdr[10] != compression_type_base
+                || ihdr[11] != filter_type_base
+                || ihdr[12] > interlace_adam7)
+            {
+                return false;
+            }
+            m_info.set_width(width);
+            m_info.set_height(height);
+            m_info.set_bit_depth(ihdr[8]);
+            m_info.set_color_type(color_type(ihdr[9]));
+            m_info.set_compression_type(compression_type(ihdr[10]));
+            m_info.set_filter_type(filter_type(ihdr[11]));
+            m_info.set_interlace_type(interlace_type(ihdr[12]));
+            return true;
+        }
+
+        void start()
+        {
+            size_t const bits
+                = detail::get_color_channels(m_info.get_color_type())
+                * m_info.get_bit_depth();
+            m_row_size = (m_info.get_width() * bits + 7) / 8;
+            m_bpp = bits < 8 ? 1 : bits / 8;
+            m_cur.assign(m_row_size + 1, 0);
+            m_prev.assign(m_row_size + 1, 0);
+            m_input.resize(32 * 1024);
+
+            std::memset(& m_zstream, 0, sizeof(m_zstream));
+            if (inflateInit(& m_zstream) != Z_OK)
+            {
+                throw error("zlib: inflateInit() failed");
+            }
+            m_inflating = true;
+        }
+
+        /*
+         * Fills the next IDAT data into the input buffer, moving on
+         * to the following IDAT chunk as necessary.  Returns false at
+         * the end of the image data.
+         */
+        bool refill()
+        {
+            while (m_idat_left == 0)
+            {
+                if (m_have_chunk)
+                {
+                    return false;
+                }
+                byte stored[4];
+                read_data(stored, 4);
+                if (m_crc != detail::probe_get_uint_32(stored))
+                {
+                    throw error("IDAT: CRC error");
+                }
+                read_data(m_chunk, 8);
+                m_have_chunk = true;
+                if (std::memcmp(m_chunk + 4, "IDAT", 4) != 0)
+                {
+                    return false;
+                }
+                m_have_chunk = false;
+                m_idat_left = detail::probe_get_uint_32(m_chunk);
+                if (m_idat_left > PNG_UINT_31_MAX)
+                {
+                    throw error("PNG unsigned integer out of range");
+                }
+                m_crc = crc32(crc32(0, Z_NULL, 0), m_chunk + 4, 4);
+            }
+            size_t size = std::min(size_t(m_idat_left), m_input.size());
+            read_data(& m_input[0], size);
+            m_crc = crc32(m_crc, & m_input[0], size);
+            m_idat_left -= size;
+            m_zstream.next_in = & m_input[0];
+            m_zstream.avail_in = size;
+            return true;
+        }
+
+        /*
+         * Runs inflate() once, refilling the input as needed.
+         * Returns Z_STREAM_END once the compressed data is complete
+         * or there is no more image data.
+         */
+        int inflate_step(byte* out, size_t size)
+        {
+            if (m_zstream.avail_in == 0 && !refill())
+            {
+                m_data_done = true;
+                return Z_STREAM_END;
+            }
+            m_zstream.next_out = out;
+            m_zstream.avail_out = size;
+            int ret = inflate(& m_zstream, Z_SYNC_FLUSH);
+            if (ret == Z_STREAM_END)
+            {
+                m_data_done = true;
+            }
+            else if (ret != Z_OK)
+            {
+                throw error(m_zstream.msg ? m_zstream.msg : "zlib error");
+            }
+            return ret;
+        }
+
+        void inflate_data(byte* out, size_t size)
+        {
+            while (size)
+            {
+                if (m_data_done)
+                {
+                    throw error("Not enough image data");
+                }
+                inflate_step(out, size);
+                size_t done = size - m_zstream.avail_out;
+                out += done;
+                size -= done;
+            }
+        }
+
+        /*
+         * Skips the unread rest of the IDAT chunks, if any.
+         */
+        void skip_idat()
+        {
+            m_zstream.avail_in = 0;
+            while (refill())
+            {
+            }
+        }
+
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+        static void copy_swapped_16(byte* dst, byte const* src, size_t size)
+        {
+            size_t i = 0;
+#ifdef PNGPP_HAS_SSE2
+            for (; i + 16 <= size; i += 16)
+            {
+                __m128i x = _mm_loadu_si128(reinterpret_cast< __m128i const* >
+                                            (src + i));
+                x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+                _mm_storeu_si128(reinterpret_cast< __m128i* >(dst + i), x);
+            }
+#endif
+            for (; i < size; i += 2)
+            {
+                dst[i] = src[i + 1];
+                dst[i + 1] = src[i];
+            }
+        }
+#endif
+
+        istream& m_stream;
+        std::vector< byte > m_header;
+        image_info m_info;
+        z_stream m_zstream;
+        bool m_inflating;
+        uint_32 m_idat_left;
+        uLong m_crc;
+        bool m_data_done;
+        byte m_chunk[8];
+        bool m_have_chunk;
+        std::vector< byte > m_input;
+        std::vector< byte > m_cur;
+        std::vector< byte > m_prev;
+        size_t m_row_size;
+        size_t m_bpp;
+    };
+
+    namespace detail
+    {
+
+        /*
+         * Replays the data already consumed by a native_decoder
+         * before reading on from the stream itself.
+         */
+        template< class istream >
+        class replay_istream
+        {
+        public:
+            replay_istream(byte const* data, size_t size, istream& stream)
+                : m_data(data),
+                  m_size(size),
+                  m_stream(stream)
+            {
+            }
+
+            void read(char* buffer, size_t count)
+            {
+                size_t size = std::min(count, m_size);
+                std::memcpy(buffer, m_data, size);
+                m_data += size;
+                m_size -= size;
+                if (count > size)
+                {
+                    m_stream.read(buffer + size, count - size);
+                }
+            }
+
+            bool good() const
+            {
+                return m_stream.good();
+            }
+
+        private:
+            byte const* m_data;
+            size_t m_size;
+            istream& m_stream;
+        };
+
+    } // namespace detail
+
+    /**
+     * \brief IO transformation wrapper selecting the native_decoder
+     * engine.
+     *
+     * consumer::read() decodes non-interlaced images which already
+     * have the %color type and bit depth of the %consumer's pixel
+     * type with native_decoder, and falls back to libpng and the
+     * wrapped transformation for everything else:
+     *
+     * \code
+     * png::image< png::rgb_pixel > image;
+     * image.read(filename,
+     *            png::native_decoding< png::convert_color_space
+     *                                  < png::rgb_pixel > >());
+     * \endcode
+     *
+     * The transformation is not applied to natively decoded images,
+     * so it should leave images in the target format unchanged, like
+     * convert_color_space and require_color_space do.  push_consumer
+     * always uses libpng.
+     */
+    template< class transformation = detail::no_transform >
+    class native_decoding
+    {
+    public:
+        explicit native_decoding(transformation const& transform
+                                     = transformation())
+            : m_transform(transform)
+        {
+        }
+
+        void operator()(io_base& io) const
+        {
+            m_transform(io);
+        }
+
+        transformation const& get_transformation() const
+        {
+            return m_transform;
+        }
+
+    private:
+        transformation m_transform;
+    };
+
+} // namespace png
+
+#endif // PNGPP_NATIVE_DECODER_HPP_INCLUDED
@@ -0,0 +1,813 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_NATIVE_ENCODER_HPP_INCLUDED
+#define PNGPP_NATIVE_ENCODER_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include <zlib.h>
+
+#include "config.hpp"
+#include "error.hpp"
+#include "image_info.hpp"
+#include "row_filter.hpp"
+#include "filter_strategy.hpp"
+
+namespace png
+{
+
+    namespace detail
+    {
+
+        inline void put_uint_32(byte* buf, uint_32 value)
+        {
+            buf[0] = byte(value >> 24);
+            buf[1] = byte(value >> 16);
+            buf[2] = byte(value >> 8);
+            buf[3] = byte(value);
+        }
+
+        /*
+         * Writes the PNG signature and complete chunks, computing
+         * their CRCs, to an ostream of the writer interface.
+         */
+        template< class ostream >
+        class chunk_writer
+        {
+        public:
+            explicit chunk_writer(ostream& stream)
+                : m_stream(stream)
+            {
+            }
+
+            void write_signature()
+            {
+                static byte const signature[8] =
+                    { 137, 80, 78, 71, 13, 10, 26, 10 };
+                write(signature, 8);
+            }
+
+            void write_chunk(char const* name, byte const* data, size_t size)
+            {
+                byte header[8];
+                put_uint_32(header, size);
+                std::memcpy(header + 4, name, 4);
+                uLong crc = crc32(crc32(0, Z_NULL, 0), header + 4, 4);
+                if (size)
+                {
+                    crc = crc32(crc, data, size);
+                }
+                byte trailer[4];
+                put_uint_32(trailer, crc);
+                write(header, 8);
+                write(data, size);
+                write(trailer, 4);
+            }
+
+            void write_chunk(char const* name, std::vector< byte > const& data)
+            {
+                write_chunk(name, data.empty() ? 0 : & data[0], data.size());
+            }
+
+            /*
+             * Writes IHDR and, for color-mapped images, PLTE and tRNS
+             * as found in \c info.
+             */
+            void write_header(image_info const& info)
+            {
+                write_signature();
+                byte ihdr[13];
+                put_uint_32(ihdr, info.get_width());
+                put_uint_32(ihdr + 4, info.get_height());
+                ihdr[8] = byte(info.get_bit_depth());
+                ihdr[9] = byte(info.get_color_type());
+                ihdr[10] = byte(info.get_compression_type());
+                ihdr[11] = byte(info.get_filter_type());
+                ihdr[12] = byte(info.get_interlace_type());
+                write_chunk("IHDR", ihdr, sizeof(ihdr));
+
+                if (info.get_color_type() != color_type_palette)
+                {
+                    return;
+                }
+                palette const& plte = info.get_palette();
+                if (plte.empty())
+                {
+                    throw error("palette is required for color_type_palette");
+                }
+                std::vector< byte > data;
+                for (size_t i = 0; i < plte.size(); ++i)
+                {
+                    data.push_back(plte[i].red);
+                    data.push_back(plte[i].green);
+                    data.push_back(plte[i].blue);
+                }
+                write_chunk("PLTE", data);
+                if (!info.get_tRNS().empty())
+                {
+                    write_chunk("tRNS", info.get_tRNS());
+                }
+            }
+
+        private:
+            void write(byte const* data, size_t size)
+            {
+                m_stream.write(reinterpret_cast< char const* >(data), size);
+                if (!m_stream.good())
+                {
+                    throw error("ostream::write() failed");
+                }
+            }
+
+            ostream& m_stream;
+        };
+
+        /*
+         * A zlib stream encoder trading compression for speed: greedy
+         * LZ77 matching with a single-entry hash table of 4-byte
+         * sequences (which also catches runs of repeated pixels,
+         * distance 1 to 8), and one block with Huffman codes built
+         * from the symbol statistics per 64K of input.
+         */
+        class fast_deflate
+        {
+        public:
+            fast_deflate()
+                : m_hash(hash_size, 0),
+                  m_base(0),
+                  m_pos(0),
+                  m_adler(adler32(0, Z_NULL, 0)),
+                  m_bits(0),
+                  m_count(0),
+                  m_started(false)
+            {
+            }
+
+            /*
+             * Adds data to the stream, appending any compressed
+             * output to \c out.
+             */
+            void compress(byte const* data, size_t size,
+                          std::vector< byte >& out)
+            {
+                m_adler = adler32(m_adler, data, size);
+                m_window.insert(m_window.end(), data, data + size);
+                if (m_window.size() - m_pos >= block_size)
+                {
+                    write_block(out, false);
+                }
+            }
+
+            /*
+             * Ends the stream, appending the rest of the compressed
+             * output to \c out.
+             */
+            void finish(std::vector< byte >& out)
+            {
+                write_block(out, true);
+                byte* p = reserve(out, 8);
+                while (m_count > 0)
+                {
+                    *p++ = byte(m_bits);
+                    m_bits >>= 8;
+                    m_count = m_count > 8 ? m_count - 8 : 0;
+                }
+                put_uint_32(p, m_adler);
+                out.resize(p + 4 - & out[0]);
+            }
+
+        private:
+            static size_t const window_size = 32768;
+            static size_t const max_match = 258;
+            static size_t const block_size = 65536;
+            static size_t const hash_bits = 15;
+            static size_t const hash_size = 1 << hash_bits;
+            static size_t const literal_count = 286;
+            static size_t const distance_count = 30;
+            static uint_32 const match_flag = 0x80000000u;
+
+            /*
+             * Symbol numbers for match lengths and distances.
+             */
+            struct tables
+            {
+                byte length_code[max_match + 1];
+                byte distance_code[512];
+
+                tables()
+                {
+                    for (size_t len = 3; len <= max_match; ++len)
+                    {
+                        int sym = 0;
+                        while (sym < 28 && length_base(sym + 1) <= len)
+                        {
+                            ++sym;
+                        }
+                        length_code[len] = byte(sym);
+                    }
+                    for (int d = 0; d < 512; ++d)
+                    {
+                        // (dist-1) below 256, (dist-1) >> 7 above
+                        size_t dist = (d < 256 ? d : (d - 256) << 7) + 1;
+                        int sym = 0;
+                        while (sym < 29 && distance_base(sym + 1) <= dist)
+                        {
+                            ++sym;
+                        }
+                        distance_code[d] = byte(sym);
+                    }
+                }
+            };
+
+            /*
+             * A canonical Huffman code, with the codes bit-reversed
+             * for output.
+             */
+            struct huffman
+            {
+                uint_32 codes[literal_count];
+                byte lengths[literal_count];
+                size_t count;
+
+                void build(uint_32 const* freq, size_t n, size_t limit)
+                {
+                    count = n;
+                    std::vector< uint_32 > f(freq, freq + n);
+                    while (!build_lengths(& f[0], n, limit))
+                    {
+                        // flatten the statistics until the code fits
+                        for (size_t i = 0; i < n; ++i)
+                        {
+                            f[i] = f[i] ? (f[i] >> 1) | 1 : 0;
+                        }
+                    }
+                    uint_32 next[16] = { 0 };
+                    size_t bl_count[16] = { 0 };
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        ++bl_count[lengths[i]];
+                    }
+                    bl_count[0] = 0;
+                    uint_32 code = 0;
+                    for (size_t bits = 1; bits < 16; ++bits)
+                    {
+                        code = (code + bl_count[bits - 1]) << 1;
+                        next[bits] = code;
+                    }
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        if (lengths[i])
+                        {
+                            codes[i] = reverse(next[lengths[i]]++,
+                                               lengths[i]);
+                        }
+                    }
+                }
+
+                bool build_lengths(uint_32 const* freq, size_t n,
+                                   size_t limit)
+                {
+                    typedef std::pair< uint_32, size_t > node;
+                    std::priority_queue< node, std::vector< node >,
+                                         std::greater< node > > queue;
+                    std::vector< size_t > parent;
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        lengths[i] = 0;
+                        if (freq[i])
+                        {
+                            queue.push(node(freq[i], parent.size()));
+                            parent.push_back(i);
+                        }
+                    }
+                    size_t const leaves = parent.size();
+                    if (leaves == 0)
+                    {
+                        return true;
+                    }
+                    if (leaves == 1)
+                    {
+                        lengths[parent[0]] = 1;
+                        return true;
+                    }
+                    std::vector< size_t > symbols(parent);
+                    while (queue.size() > 1)
+                    {
+                        node a = queue.top();
+                        queue.pop();
+                        node b = queue.top();
+                        queue.pop();
+                        parent[a.second] = parent[b.second] = parent.size();
+                        queue.push(node(a.first + b.first, parent.size()));
+                        parent.push_back(0);
+                    }
+                    // internal nodes come after their children
+                    std::vector< size_t > depth(parent.size(), 0);
+                    for (size_t i = parent.size() - 1; i-- > 0; )
+                    {
+                        depth[i] = depth[parent[i]] + 1;
+                    }
+                    for (size_t i = 0; i < leaves; ++i)
+                    {
+                        if (depth[i] > limit)
+                        {
+                            return false;
+                        }
+                        lengths[symbols[i]] = byte(depth[i]);
+                    }
+                    return true;
+                }
+            };
+
+            static uint_32 reverse(uint_32 code, size_t bits)
+            {
+                uint_32 result = 0;
+                for (size_t i = 0; i < bits; ++i)
+                {
+                    result = (result << 1) | ((code >> i) & 1);
+                }
+                return result;
+            }
+
+            static size_t length_base(int sym)
+            {
+                static unsigned short const base[29] =
+                    { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+                      31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195,
+                      227, 258 };
+                return base[sym];
+            }
+
+            static size_t length_extra(int sym)
+            {
+                return sym < 8 || sym == 28 ? 0 : (sym - 4) / 4;
+            }
+
+            static size_t distance_base(int sym)
+            {
+                static unsigned short const base[30] =
+                    { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                      193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                      6145, 8193, 12289, 16385, 24577 };
+                return base[sym];
+            }
+
+            static size_t distance_extra(int sym)
+            {
+                return sym < 4 ? 0 : (sym - 2) / 2;
+            }
+
+            static tables const& get_tables()
+            {
+                static tables const t;
+                return t;
+            }
+
+            static uint_32 load_32(byte const* p)
+            {
+                uint_32 v;
+                std::memcpy(& v, p, 4);
+                return v;
+            }
+
+            static byte* reserve(std::vector< byte >& out, size_t size)
+            {
+                size_t const used = out.size();
+                out.resize(used + size);
+                return & out[used];
+            }
+
+            void put(byte*& p, uint_32 bits, size_t count)
+            {
+                m_bits |= uint64_t(bits) << m_count;
+                m_count += count;
+                if (m_count >= 32)
+                {
+                    p[0] = byte(m_bits);
+                    p[1] = byte(m_bits >> 8);
+                    p[2] = byte(m_bits >> 16);
+                    p[3] = byte(m_bits >> 24);
+                    p += 4;
+                    m_bits >>= 32;
+                    m_count -= 32;
+                }
+            }
+
+            /*
+             * Finds the matches in the window data not processed
+             * yet, storing literals and (length, distance) pairs in
+             * m_symbols.  Unless \c final, stops short of the end so
+             * that matches are not cut by the next data.
+             */
+            void parse(bool final)
+            {
+                tables const& t = get_tables();
+                size_t const end = m_window.size();
+                size_t const limit = final ? end
+                    : end - (end - m_pos < max_match ? end - m_pos
+                                                     : max_match);
+                m_symbols.clear();
+                std::fill(m_literal_freq, m_literal_freq + literal_count, 0);
+                std::fill(m_distance_freq, m_distance_freq + distance_count,
+                          0);
+
+                byte const* w = m_window.empty() ? 0 : & m_window[0];
+                size_t i = m_pos;
+                while (i + 4 <= limit)
+                {
+                    uint_32 v = load_32(w + i);
+                    uint_32 h = (v * 2654435761u) >> (32 - hash_bits);
+                    uint_32 candidate = m_hash[h];
+                    m_hash[h] = uint_32(m_base + i + 1);
+                    if (candidate > m_base)
+                    {
+                        size_t cpos = candidate - 1 - m_base;
+                        size_t dist = i - cpos;
+                        if (dist <= window_size && load_32(w + cpos) == v)
+                        {
+                            size_t max = end - i < max_match
+                                ? end - i : max_match;
+                            size_t len = 4;
+                            while (len < max && w[cpos + len] == w[i + len])
+                            {
+                                ++len;
+                            }
+                            m_symbols.push_back(match_flag
+                                                | uint_32(len) << 16
+                                                | uint_32(dist - 1));
+                            ++m_literal_freq[257 + t.length_code[len]];
+                            size_t d = dist - 1;
+                            ++m_distance_freq[t.distance_code
+                                              [d < 256 ? d
+                                               : 256 + (d >> 7)]];
+                            // index the tail of the match so that the
+                            // next row finds it
+                            size_t next = i + len;
+                            for (size_t j = next - 3 > i + 1 ? next - 3 : i + 1;
+                                 j + 4 <= limit && j < next; ++j)
+                            {
+                                m_hash[(load_32(w + j) * 2654435761u)
+                                       >> (32 - hash_bits)]
+                                    = uint_32(m_base + j + 1);
+                            }
+                            i = next;
+                            continue;
+                        }
+                    }
+                    m_symbols.push_back(w[i]);
+                    ++m_literal_freq[w[i]];
+                    ++i;
+                }
+                if (final)
+                {
+                    for (; i < end; ++i)
+                    {
+                        m_symbols.push_back(w[i]);
+                        ++m_literal_freq[w[i]];
+                    }
+                }
+                ++m_literal_freq[256]; // end of block
+
+                size_t const parsed = i - m_pos;
+                m_pos = i;
+                // keep a window's worth of history
+                if (m_pos > window_size + block_size)
+                {
+                    size_t drop = m_pos - window_size;
+                    m_window.erase(m_window.begin(),
+                                   m_window.begin() + drop);
+                    m_base += drop;
+                    m_pos -= drop;
+                }
+                m_parsed = parsed;
+            }
+
+            void write_block(std::vector< byte >& out, bool final)
+            {
+                parse(final);
+
+                huffman& lit = m_literal_code;
+                huffman& dist = m_distance_code;
+                lit.build(m_literal_freq, literal_count, 15);
+                dist.build(m_distance_freq, distance_count, 15);
+                if (!has_distances())
+                {
+                    // a lone zero-length distance code is not enough
+                    // for some decoders
+                    dist.lengths[0] = 1;
+                    dist.codes[0] = 0;
+                }
+                size_t hlit = literal_count;
+                while (hlit > 257 && !lit.lengths[hlit - 1])
+                {
+                    --hlit;
+                }
+                size_t hdist = distance_count;
+                while (hdist > 1 && !dist.lengths[hdist - 1])
+                {
+                    --hdist;
+                }
+
+                // run-length coded code lengths of both codes
+                byte lengths[literal_count + distance_count];
+                std::memcpy(lengths, lit.lengths, hlit);
+                std::memcpy(lengths + hlit, dist.lengths, hdist);
+                size_t const total = hlit + hdist;
+                std::vector< uint_32 > runs; // symbol | extra << 8
+                uint_32 cl_freq[19] = { 0 };
+                for (size_t i = 0; i < total; )
+                {
+                    byte len = lengths[i];
+                    size_t run = 1;
+                    while (i + run < total && lengths[i + run] == len)
+                    {
+                        ++run;
+                    }
+                    i += run;
+                    if (len == 0)
+                    {
+                        while (run >= 11)
+                        {
+                            size_t n = run < 138 ? run : 138;
+                            runs.push_back(18 | uint_32(n - 11) << 8);
+                            ++cl_freq[18];
+                            run -= n;
+                        }
+                        if (run >= 3)
+                        {
+                            runs.push_back(17 | uint_32(run - 3) << 8);
+                            ++cl_freq[17];
+                            run = 0;
+                        }
+                    }
+                    else
+                    {
+                        runs.push_back(len);
+                        ++cl_freq[len];
+                        --run;
+                        while (run >= 3)
+                        {
+                            size_t n = run < 6 ? run : 6;
+                            runs.push_back(16 | uint_32(n - 3) << 8);
+                            ++cl_freq[16];
+                            run -= n;
+                        }
+                    }
+                    for (; run; --run)
+                    {
+                        runs.push_back(len);
+                        ++cl_freq[len];
+                    }
+                }
+                // unlike the others this code must be complete, i.e.
+                // have two symbols at least
+                if (std::count(cl_freq, cl_freq + 19, 0u) > 17)
+                {
+                    ++cl_freq[cl_freq[0] ? 1 : 0];
+                }
+                huffman& cl = m_length_code;
+                cl.build(cl_freq, 19, 7);
+                static byte const order[19] =
+                    { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13,
+                      2, 14, 1, 15 };
+                size_t hclen = 19;
+                while (hclen > 4 && !cl.lengths[order[hclen - 1]])
+                {
+                    --hclen;
+                }
+
+                // at most 15+5+15+13 bits per match of 4 or more bytes,
+                // 15 bits per literal and 14 per code length
+                size_t const used = out.size();
+                byte* p = reserve(out, 2 * m_parsed + 1024);
+                byte* const start = p;
+                if (!m_started)
+                {
+                    // zlib header: deflate, 32K window, fastest level
+                    *p++ = 0x78;
+                    *p++ = 0x01;
+                    m_started = true;
+                }
+                put(p, final ? 5 : 4, 3); // BFINAL, dynamic codes
+                put(p, hlit - 257, 5);
+                put(p, hdist - 1, 5);
+                put(p, hclen - 4, 4);
+                for (size_t i = 0; i < hclen; ++i)
+                {
+                    put(p, cl.lengths[order[i]], 3);
+                }
+                for (size_t i = 0; i < runs.size(); ++i)
+                {
+                    uint_32 sym = runs[i] & 0xff;
+                    put(p, cl.codes[sym], cl.lengths[sym]);
+                    if (sym >= 16)
+                    {
+                        put(p, runs[i] >> 8, sym == 16 ? 2 : sym == 17 ? 3 : 7);
+                    }
+                }
+
+                tables const& t = get_tables();
+                for (size_t i = 0; i < m_symbols.size(); ++i)
+                {
+                    uint_32 s = m_symbols[i];
+                    if (!(s & match_flag))
+                    {
+                        put(p, lit.codes[s], lit.lengths[s]);
+                        continue;
+                    }
+                    size_t len = (s >> 16) & 0x1ff;
+                    size_t d = s & 0xffff;
+                    int lsym = t.length_code[len];
+                    put(p, lit.codes[257 + lsym], lit.lengths[257 + lsym]);
+                    put(p, uint_32(len - length_base(lsym)),
+                        length_extra(lsym));
+                    int dsym = t.distance_code[d < 256 ? d : 256 + (d >> 7)];
+                    put(p, dist.codes[dsym], dist.lengths[dsym]);
+                    put(p, uint_32(d + 1 - distance_base(dsym)),
+                        distance_extra(dsym));
+                }
+                put(p, lit.codes[256], lit.lengths[256]);
+                out.resize(used + (p - start));
+            }
+
+            bool has_distances() const
+            {
+                for (size_t i = 0; i < distance_count; ++i)
+                {
+                    if (m_distance_freq[i])
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            std::vector< byte > m_window;
+            std::vector< uint_32 > m_hash;
+            std::vector< uint_32 > m_symbols;
+            uint_32 m_literal_freq[literal_count];
+            uint_32 m_distance_freq[distance_count];
+            huffman m_literal_code;
+            huffman m_distance_code;
+            huffman m_length_code;
+            size_t m_base;
+            size_t m_pos;
+            size_t m_parsed;
+            uLong m_adler;
+            uint64_t m_bits;
+            size_t m_count;
+            bool m_started;
+        };
+    } // namespace detail
+
+    /**
+     * \brief Encodes PNG data streams without libpng, favouring
+     * speed over compression.
+     *
+     * Provides the row writing interface of the writer class
+     * (write_info(), write_row(), write_rows(), write_image() and
+     * write_end_info()) for non-interlaced images.  Rows are filtered
+     * as directed by a filter_strategy (the Up filter for every row
+     * by default) with the SSE2 kernels of row_filter.hpp where
+     * available, and the image data is compressed with a specialised
+     * deflate coder using a single-probe match search and Huffman
+     * codes built from the symbol counts of each block.  The result
+     * is a standard PNG file, typically a bit larger than libpng's
+     * default output but written several times faster.
+     *
+     * Only the IHDR, PLTE, tRNS, IDAT and IEND chunks are written.
+     *
+     * \see generator::write_fast(), image::write_fast()
+     */
+    template< class ostream >
+    class native_encoder
+    {
+    public:
+        native_encoder(ostream& stream, image_info const& info,
+                       filter_strategy const& strategy = filter_strategy())
+            : m_writer(stream),
+              m_info(info),
+              m_selector(strategy, info)
+        {
+            if (info.get_interlace_type() != interlace_none)
+            {
+                throw error("native_encoder: interlaced images"
+                            " are not supported");
+            }
+            size_t const bits
+                = detail::get_color_channels(info.get_color_type())
+                * info.get_bit_depth();
+            m_row_size = (info.get_width() * bits + 7) / 8;
+            m_prev.assign(m_row_size, 0);
+        }
+
+        /**
+         * \brief Writes the PNG signature and the chunks preceding
+         * the image data.
+         */
+        void write_info()
+        {
+            m_writer.write_header(m_info);
+        }
+
+        /**
+         * \brief Filters and compresses the next row of the %image.
+         */
+        void write_row(byte* row)
+        {
+            byte const* bytes = row;
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+            if (m_info.get_bit_depth() == 16)
+            {
+                m_swapped.resize(m_row_size);
+                for (size_t i = 0; i < m_row_size; i += 2)
+                {
+                    m_swapped[i] = row[i + 1];
+                    m_swapped[i + 1] = row[i];
+                }
+                bytes = & m_swapped[0];
+            }
+#endif
+            byte const* filtered = m_selector.filter(bytes, & m_prev[0]);
+            std::memcpy(& m_prev[0], bytes, m_row_size);
+            m_deflate.compress(filtered, m_row_size + 1, m_idat);
+            if (m_idat.size() >= idat_size)
+            {
+                m_writer.write_chunk("IDAT", m_idat);
+                m_idat.clear();
+            }
+        }
+
+        void write_rows(byte** rows, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                write_row(rows[i]);
+            }
+        }
+
+        void write_image(byte** rows)
+        {
+            write_rows(rows, m_info.get_height());
+        }
+
+        /**
+         * \brief Completes the image data and writes the IEND chunk.
+         */
+        void write_end_info()
+        {
+            m_deflate.finish(m_idat);
+            m_writer.write_chunk("IDAT", m_idat);
+            m_idat.clear();
+            m_writer.write_chunk("IEND", 0, 0);
+        }
+
+    private:
+        static size_t const idat_size = 65536;
+
+        detail::chunk_writer< ostream > m_writer;
+        image_info const& m_info;
+        detail::filter_selector m_selector;
+        size_t m_row_size;
+        std::vector< byte > m_prev;
+        std::vector< byte > m_swapped;
+        std::vector< byte > m_idat;
+        detail::fast_deflate m_deflate;
+    };
+
+} // namespace png
+
+#endif // PNGPP_NATIVE_ENCODER_HPP_INCLUDED
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_OPTIMIZER_HPP_INCLUDED
+#define PNGPP_OPTIMIZER_HPP_INCLUDED
+
+#include "config.hpp"
+
+#ifdef PNGPP_HAS_STD_THREAD
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "compression_profile.hpp"
+#include "thread_pool.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief Settings of the trial encoding done by
+     * image::write_optimized().
+     *
+     * Holds the compression profiles to try, the maximum number of
+     * threads encoding at a time (0 for one per hardware thread) and
+     * a time budget in milliseconds (0 for none).  Once the budget
+     * is spent no further trials are started; the first candidate is
+     * always encoded.  The candidates are tried in order, so put the
+     * most promising ones first.
+     */
+    class optimize_options
+    {
+    public:
+        optimize_options()
+            : m_candidates(default_candidates()),
+              m_thread_count(0),
+              m_time_budget(0)
+        {
+        }
+
+        /**
+         * \brief Returns the default candidates: zlib level 9 with
+         * the largest window and memory level, combining the
+         * default, filtered and run-length strategies with libpng's
+         * adaptive filter choice and each single filter, adaptive
+         * choices first.
+         */
+        static std::vector< compression_profile > default_candidates()
+        {
+            static int const filters[] =
+            {
+                PNG_ALL_FILTERS, PNG_FILTER_PAETH, PNG_FILTER_NONE,
+                PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVG
+            };
+            static int const strategies[] =
+            {
+                strategy_default, strategy_filtered, strategy_rle
+            };
+            std::vector< compression_profile > result;
+            for (size_t f = 0; f < sizeof(filters) / sizeof(*filters); ++f)
+            {
+                for (size_t s = 0;
+                     s < sizeof(strategies) / sizeof(*strategies); ++s)
+                {
+                    compression_profile profile;
+                    profile.set_level(9);
+                    profile.set_strategy(strategies[s]);
+                    profile.set_window_bits(15);
+                    profile.set_mem_level(9);
+                    profile.set_filters(filters[f]);
+                    result.push_back(profile);
+                }
+            }
+            return result;
+        }
+
+        std::vector< compression_profile > const& get_candidates() const
+        {
+            return m_candidates;
+        }
+
+        void set_candidates(std::vector< compression_profile > const&
+                            candidates)
+        {
+            m_candidates = candidates;
+        }
+
+        size_t get_thread_count() const
+        {
+            return m_thread_count;
+        }
+
+        void set_thread_count(size_t count)
+        {
+            m_thread_count = count;
+        }
+
+        /**
+         * \brief Returns the time budget in milliseconds, 0 for
+         * none.
+         */
+        size_t get_time_budget() const
+        {
+            return m_time_budget;
+        }
+
+        void set_time_budget(size_t milliseconds)
+        {
+            m_time_budget = milliseconds;
+        }
+
+    private:
+        std::vector< compression_profile > m_candidates;
+        size_t m_thread_count;
+        size_t m_time_budget;
+    };
+
+    /**
+     * \brief The outcome of image::write_optimized(): the profile
+     * that gave the smallest file, which may be cached and passed to
+     * image::write() later for the same output, and the trial
+     * statistics.
+     */
+    struct optimize_report
+    {
+        optimize_report()
+            : size(0),
+              trials(0),
+              skipped(0)
+        {
+        }
+
+        compression_profile profile;
+        size_t size;
+        size_t trials;
+        size_t skipped;
+    };
+
+    namespace detail
+    {
+
+        /*
+         * Runs \c encode for every candidate of \c options on a
+         * thread_pool and leaves the smallest output in \c best.
+         * Ties go to the earlier candidate, so the result does not
+         * depend on the scheduling.
+         */
+        inline optimize_report
+        run_trials(std::function< void (std::vector< byte >&,
+                                        compression_profile const&) >
+                   const& encode,
+                   optimize_options const& options,
+                   std::vector< byte >& best)
+        {
+            typedef std::chrono::steady_clock clock;
+            std::vector< compression_profile > const& candidates
+                = options.get_candidates();
+            clock::time_point const deadline = clock::now()
+                + std::chrono::milliseconds(options.get_time_budget());
+            bool const limited = options.get_time_budget() != 0;
+            if (candidates.empty())
+            {
+                throw error("no compression profiles to try");
+            }
+
+            optimize_report report;
+            size_t best_index = 0;
+            std::exception_ptr failure;
+            std::mutex mutex;
+            {
+                thread_pool pool(options.get_thread_count());
+                for (size_t i = 0; i < candidates.size(); ++i)
+                {
+                    pool.submit([&, i]()
+                        {
+                            if (i != 0 && limited && clock::now() > deadline)
+                            {
+                                std::lock_guard< std::mutex > lock(mutex);
+                                ++report.skipped;
+                                return;
+                            }
+                            std::vector< byte > out;
+                            try
+                            {
+                                encode(out, candidates[i]);
+                            }
+                            catch (...)
+                            {
+                                std::lock_guard< std::mutex > lock(mutex);
+                                if (!failure)
+                                {
+                                    failure = std::current_exception();
+                                }
+                                return;
+                            }
+                            std::lock_guard< std::mutex > lock(mutex);
+                            ++report.trials;
+                            if (report.trials == 1
+                                || out.size() < best.size()
+                                || (out.size() == best.size()
+                                    && i < best_index))
+                            {
+                                best.swap(out);
+                                best_index = i;
+                            }
+                        });
+                }
+                pool.wait();
+            }
+            if (failure)
+            {
+                std::rethrow_exception(failure);
+            }
+            report.profile = candidates[best_index];
+            report.size = best.size();
+            return report;
+        }
+
+    } // namespace detail
+
+} // namespace png
+
+#endif // PNGPP_HAS_STD_THREAD
+
+#endif // PNGPP_OPTIMIZER_HPP_INCLUDED
@@ -0,0 +1,394 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_PARALLEL_ENCODER_HPP_INCLUDED
+#define PNGPP_PARALLEL_ENCODER_HPP_INCLUDED
+
+#include "config.hpp"
+
+#ifdef PNGPP_HAS_STD_THREAD
+
+#include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <vector>
+#include <zlib.h>
+
+#include "error.hpp"
+#include "image_info.hpp"
+#include "compression_profile.hpp"
+#include "native_encoder.hpp"
+#include "filter_strategy.hpp"
+#include "thread_pool.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief Encodes PNG images deflating horizontal strips of rows
+     * concurrently.
+     *
+     * Provides the row writing interface of the writer class
+     * (write_info(), write_row(), write_rows(), write_image() and
+     * write_end_info()) for non-interlaced images.  Rows are
+     * filtered on the calling thread and collected into strips of
+     * about \c strip_size bytes.  Every strip is deflated by a task
+     * on a thread_pool as raw deflate data primed with the tail of
+     * the previous strip as preset dictionary and ended with a sync
+     * flush, so that the pieces simply concatenate into one zlib
+     * stream; their Adler-32 checksums are combined with
+     * adler32_combine().  The strips depend on \c strip_size only, so
+     * the output is byte-identical for any number of threads.
+     *
+     * The zlib level, strategy, window bits and memory level are
+     * taken from a compression_profile.  Every row is filtered with
+     * the filter the profile allows if it names exactly one, and
+     * with the one of minimum sum among the allowed filters
+     * otherwise (see filter_strategy::min_sum()).
+     *
+     * Requires C++11 (see \c PNGPP_HAS_STD_THREAD in config.hpp).
+     *
+     * \see generator::write_parallel(), image::write_parallel()
+     */
+    template< class ostream >
+    class parallel_encoder
+    {
+    public:
+        static size_t const default_strip_size = 256 * 1024;
+
+        parallel_encoder(ostream& stream, image_info const& info,
+                         thread_pool& pool,
+                         compression_profile const& profile
+                             = compression_profile(),
+                         size_t strip_size = default_strip_size)
+            : m_writer(stream),
+              m_info(info),
+              m_pool(pool),
+              m_selector(get_strategy(profile.get_filters()), info),
+              m_adler(adler32(0, Z_NULL, 0)),
+              m_started(false)
+        {
+            if (info.get_interlace_type() != interlace_none)
+            {
+                throw error("parallel_encoder: interlaced images"
+                            " are not supported");
+            }
+            size_t const bits
+                = detail::get_color_channels(info.get_color_type())
+                * info.get_bit_depth();
+            m_row_size = (info.get_width() * bits + 7) / 8;
+            m_prev.assign(m_row_size, 0);
+            m_strip_rows = strip_size / (m_row_size + 1);
+            if (m_strip_rows == 0)
+            {
+                m_strip_rows = 1;
+            }
+            m_max_pending = 2 * pool.get_thread_count();
+
+            int const keep = compression_profile::keep_default;
+            m_level = profile.get_level() == keep
+                ? Z_DEFAULT_COMPRESSION : profile.get_level();
+            m_strategy = profile.get_strategy() == keep
+                ? Z_DEFAULT_STRATEGY : profile.get_strategy();
+            m_window_bits = profile.get_window_bits() == keep
+                ? 15 : profile.get_window_bits();
+            m_window_bits = m_window_bits < 9 ? 9 : m_window_bits;
+            m_mem_level = profile.get_mem_level() == keep
+                ? 8 : profile.get_mem_level();
+        }
+
+        /**
+         * \brief Waits for the strips still being deflated.
+         */
+        ~parallel_encoder()
+        {
+            for (size_t i = 0; i < m_pending.size(); ++i)
+            {
+                m_pending[i].result.wait();
+            }
+        }
+
+        /**
+         * \brief Writes the PNG signature and the chunks preceding
+         * the image data.
+         */
+        void write_info()
+        {
+            m_writer.write_header(m_info);
+        }
+
+        /**
+         * \brief Filters the next row of the %image, submitting a
+         * strip for compression once complete.
+         */
+        void write_row(byte* row)
+        {
+            if (!m_strip)
+            {
+                m_strip.reset(new strip);
+                m_strip->data.reserve(m_strip_rows * (m_row_size + 1));
+            }
+            byte const* bytes = row;
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+            if (m_info.get_bit_depth() == 16)
+            {
+                m_swapped.resize(m_row_size);
+                for (size_t i = 0; i < m_row_size; i += 2)
+                {
+                    m_swapped[i] = row[i + 1];
+                    m_swapped[i + 1] = row[i];
+                }
+                bytes = & m_swapped[0];
+            }
+#endif
+            std::vector< byte >& data = m_strip->data;
+            byte const* filtered = m_selector.filter(bytes, & m_prev[0]);
+            data.insert(data.end(), filtered, filtered + m_row_size + 1);
+            std::memcpy(& m_prev[0], bytes, m_row_size);
+            if (data.size() == m_strip_rows * (m_row_size + 1))
+            {
+                submit();
+            }
+        }
+
+        void write_rows(byte** rows, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                write_row(rows[i]);
+            }
+        }
+
+        void write_image(byte** rows)
+        {
+            write_rows(rows, m_info.get_height());
+        }
+
+        /**
+         * \brief Completes the image data and writes the IEND chunk.
+         */
+        void write_end_info()
+        {
+            if (m_strip)
+            {
+                submit();
+            }
+            while (!m_pending.empty())
+            {
+                write_pending();
+            }
+            // an empty final block with fixed codes, and the checksum
+            byte trailer[6] = { 3, 0 };
+            detail::put_uint_32(trailer + 2, m_adler);
+            m_idat.insert(m_idat.end(), trailer, trailer + 6);
+            m_writer.write_chunk("IDAT", m_idat);
+            m_writer.write_chunk("IEND", 0, 0);
+        }
+
+    private:
+        struct strip
+        {
+            std::vector< byte > dictionary;
+            std::vector< byte > data;
+            std::vector< byte > out;
+            size_t size;
+            uLong adler;
+        };
+
+        struct pending
+        {
+            std::shared_ptr< strip > data;
+            std::future< void > result;
+        };
+
+        /*
+         * Maps the PNG_FILTER_* flags of a profile to a filter
+         * strategy: a single flag to its fixed filter, anything else
+         * to a minimum-sum choice.
+         */
+        static filter_strategy get_strategy(int filters)
+        {
+            switch (filters)
+            {
+            case PNG_FILTER_NONE:
+                return filter_strategy::fixed(PNG_FILTER_VALUE_NONE);
+            case PNG_FILTER_SUB:
+                return filter_strategy::fixed(PNG_FILTER_VALUE_SUB);
+            case PNG_FILTER_UP:
+                return filter_strategy::fixed(PNG_FILTER_VALUE_UP);
+            case PNG_FILTER_AVG:
+                return filter_strategy::fixed(PNG_FILTER_VALUE_AVG);
+            case PNG_FILTER_PAETH:
+                return filter_strategy::fixed(PNG_FILTER_VALUE_PAETH);
+            case compression_profile::keep_default:
+                return filter_strategy::min_sum();
+            }
+            return filter_strategy::min_sum(filters);
+        }
+
+        void submit()
+        {
+            std::shared_ptr< strip > s(m_strip.release());
+            // the dictionary is the last window of data before the
+            // strip
+            s->dictionary = m_last;
+            size_t const window = size_t(1) << m_window_bits;
+            if (s->data.size() >= window)
+            {
+                m_last.assign(s->data.end() - window, s->data.end());
+            }
+            else
+            {
+                m_last.insert(m_last.end(), s->data.begin(), s->data.end());
+                if (m_last.size() > window)
+                {
+                    m_last.erase(m_last.begin(), m_last.end() - window);
+                }
+            }
+
+            int const level = m_level;
+            int const strategy = m_strategy;
+            int const window_bits = m_window_bits;
+            int const mem_level = m_mem_level;
+            typedef std::packaged_task< void () > task_type;
+            std::shared_ptr< task_type > task(new task_type([=]()
+                {
+                    deflate_strip(*s, level, strategy, window_bits,
+                                  mem_level);
+                }));
+            pending p;
+            p.data = s;
+            p.result = task->get_future();
+            m_pool.submit([task]() { (*task)(); });
+            m_pending.push_back(std::move(p));
+
+            while (m_pending.size() > m_max_pending)
+            {
+                write_pending();
+            }
+        }
+
+        static void deflate_strip(strip& s, int level, int strategy,
+                                  int window_bits, int mem_level)
+        {
+            s.size = s.data.size();
+            s.adler = adler32(adler32(0, Z_NULL, 0),
+                              s.data.empty() ? Z_NULL : & s.data[0],
+                              s.data.size());
+            z_stream z;
+            std::memset(& z, 0, sizeof(z));
+            if (deflateInit2(& z, level, Z_DEFLATED, -window_bits,
+                             mem_level, strategy) != Z_OK)
+            {
+                throw error("zlib: deflateInit2() failed");
+            }
+            if (!s.dictionary.empty())
+            {
+                deflateSetDictionary(& z, & s.dictionary[0],
+                                     s.dictionary.size());
+            }
+            // room for the sync flush marker, too
+            s.out.resize(deflateBound(& z, s.data.size()) + 64);
+            z.next_in = & s.data[0];
+            z.avail_in = s.data.size();
+            z.next_out = & s.out[0];
+            z.avail_out = s.out.size();
+            int ret = deflate(& z, Z_SYNC_FLUSH);
+            s.out.resize(s.out.size() - z.avail_out);
+            deflateEnd(& z);
+            if (ret != Z_OK || z.avail_in != 0 || z.avail_out == 0)
+            {
+                throw error("zlib: deflate() failed");
+            }
+            std::vector< byte >().swap(s.data);
+        }
+
+        /*
+         * Appends the oldest strip's compressed data to the IDAT
+         * buffer, writing the buffer out once it is large enough.
+         * The chunk boundaries thus depend on the data only.
+         */
+        void write_pending()
+        {
+            pending& p = m_pending.front();
+            p.result.get();
+            strip& s = *p.data;
+            if (!m_started)
+            {
+                // zlib header for the window size and level
+                int const flevel = m_level == Z_DEFAULT_COMPRESSION ? 2
+                    : m_level < 2 || m_strategy >= Z_HUFFMAN_ONLY ? 0
+                    : m_level < 6 ? 1 : m_level == 6 ? 2 : 3;
+                uint_32 header = ((m_window_bits - 8) << 12 | 8 << 8)
+                    | flevel << 6;
+                header += 31 - header % 31;
+                m_idat.push_back(byte(header >> 8));
+                m_idat.push_back(byte(header));
+                m_started = true;
+            }
+            m_adler = adler32_combine(m_adler, s.adler, s.size);
+            m_idat.insert(m_idat.end(), s.out.begin(), s.out.end());
+            m_pending.pop_front();
+            if (m_idat.size() >= idat_size)
+            {
+                m_writer.write_chunk("IDAT", m_idat);
+                m_idat.clear();
+            }
+        }
+
+        static size_t const idat_size = 256 * 1024;
+
+        detail::chunk_writer< ostream > m_writer;
+        image_info const& m_info;
+        thread_pool& m_pool;
+        detail::filter_selector m_selector;
+        int m_level;
+        int m_strategy;
+        int m_window_bits;
+        int m_mem_level;
+        size_t m_row_size;
+        size_t m_strip_rows;
+        size_t m_max_pending;
+        std::vector< byte > m_prev;
+        std::vector< byte > m_swapped;
+        std::vector< byte > m_last;
+        std::unique_ptr< strip > m_strip;
+        std::deque< pending > m_pending;
+        std::vector< byte > m_idat;
+        uLong m_adler;
+        bool m_started;
+    };
+
+} // namespace png
+
+#endif // PNGPP_HAS_STD_THREAD
+
+#endif // PNGPP_PARALLEL_ENCODER_HPP_INCLUDED
@@ -36,6 +36,7 @@
 #include <stdexcept>
 #include <vector>
 
+#include "memory_resource.hpp"
 #include "packed_pixel.hpp"
 #include "gray_pixel.hpp"
 #include "index_pixel.hpp"
@@ -54,10 +55,13 @@ namespace png
 
     /**
      * \brief The basic class template to represent image pixel data.
+     *
+     * The vector of rows is allocated with \a row_allocator.
      */
     template< typename pixel,
               typename row,
-              class traits = row_traits< row > >
+              class traits = row_traits< row >,
+              class row_allocator = std::allocator< row > >
     class basic_pixel_buffer
     {
     public:
@@ -185,21 +189,21 @@ namespace png
     protected:
         size_t m_width;
         size_t m_height;
-        typedef std::vector< row_type > row_vec;
+        typedef std::vector< row_type, row_allocator > row_vec;
         row_vec m_rows;
     };
 
     /**
      * \brief The row_traits specialization for unpacked pixel rows.
      */
-    template< typename pixel >
-    class row_traits< std::vector< pixel > >
+    template< typename pixel, class allocator >
+    class row_traits< std::vector< pixel, allocator > >
     {
     public:
         /**
          * \brief Returns the starting address of the row.
          */
-        static pixel* get_data(std::vector< pixel >& vec)
+        static pixel* get_data(std::vector< pixel, allocator >& vec)
         {
             assert(vec.size());
             return & vec[0];
@@ -208,18 +212,37 @@ namespace png
 
     /**
      * The pixel_buffer specialization for unpacked pixels.
+     *
+     * Rows are std::vector-s using \a allocator.  Pass
+     * png::allocator< pixel > to allocate from the current
+     * memory_resource.
      */
-    template< typename pixel >
+    template< typename pixel, class allocator = std::allocator< pixel > >
     class pixel_buffer
-        : public basic_pixel_buffer< pixel, std::vector< pixel > >
+        : public basic_pixel_buffer< pixel,
+                                     std::vector< pixel, allocator >,
+                                     row_traits< std::vector< pixel,
+                                                              allocator > >,
+                                     typename detail::rebind_allocator
+                                     < allocator,
+                                       std::vector< pixel, allocator >
+                                     >::type >
     {
     public:
+        typedef std::vector< pixel, allocator > pixel_row_type;
+        typedef basic_pixel_buffer< pixel,
+                                    pixel_row_type,
+                                    row_traits< pixel_row_type >,
+                                    typename detail::rebind_allocator
+                                    < allocator, pixel_row_type >::type >
+            basic_buffer;
+
         pixel_buffer()
         {
         }
 
         pixel_buffer(size_t width, size_t height)
-            : basic_pixel_buffer< pixel, std::vector< pixel > >(width, height)
+            : basic_buffer(width, height)
         {
         }
     };
@@ -326,10 +349,11 @@ namespace png
     /**
      * \brief The packed pixel row class template.
      *
-     * Stores the pixel row as a std::vector of byte-s, providing
-     * access to individual packed pixels via proxy objects.
+     * Stores the pixel row as a std::vector of byte-s, allocated
+     * with \a allocator, providing access to individual packed
+     * pixels via proxy objects.
      */
-    template< class pixel >
+    template< class pixel, class allocator = std::allocator< byte > >
     class packed_pixel_row
     {
     public:
@@ -421,7 +445,7 @@ namespace png
             return 8 / pixel::get_bit_depth();
         }
 
-        std::vector< byte > m_vec;
+        std::vector< byte, allocator > m_vec;
         size_t m_size;
     };
 
@@ -429,40 +453,62 @@ namespace png
      * \brief The row_traits class template specialization for packed
      * pixel row type.
      */
-    template< typename pixel >
-    class row_traits< packed_pixel_row< pixel > >
+    template< typename pixel, class allocator >
+    class row_traits< packed_pixel_row< pixel, allocator > >
     {
     public:
         /**
          * \brief Returns the starting address of the row.
          */
-        static byte* get_data(packed_pixel_row< pixel >& row)
+        static byte* get_data(packed_pixel_row< pixel, allocator >& row)
         {
             return row.get_data();
         }
     };
 
+    namespace detail
+    {
+
+        /**
+         * \brief Yields the basic_pixel_buffer of packed_pixel_row-s
+         * the packed pixel buffers derive from.
+         */
+        template< class pixel, class allocator >
+        struct packed_pixel_buffer_base
+        {
+            typedef packed_pixel_row< pixel,
+                                      typename rebind_allocator
+                                      < allocator, byte >::type > row;
+            typedef basic_pixel_buffer< pixel,
+                                        row,
+                                        row_traits< row >,
+                                        typename rebind_allocator
+                                        < allocator, row >::type > type;
+        };
+
+    } // namespace detail
+
     /**
      * \brief The pixel buffer class template specialization for the
      * packed_gray_pixel type.
      */
-    template< size_t bits >
-    class pixel_buffer< packed_gray_pixel< bits > >
-        : public basic_pixel_buffer< packed_gray_pixel< bits >,
-                                     packed_pixel_row< packed_gray_pixel
-                                                       < bits > > >
+    template< size_t bits, class allocator >
+    class pixel_buffer< packed_gray_pixel< bits >, allocator >
+        : public detail::packed_pixel_buffer_base
+                 < packed_gray_pixel< bits >, allocator >::type
     {
     public:
         typedef packed_gray_pixel< bits > pixel_type;
-        typedef packed_pixel_row< pixel_type > pixel_row_type;
+        typedef typename detail::packed_pixel_buffer_base
+                         < pixel_type, allocator >::type basic_buffer;
+        typedef typename basic_buffer::row_type pixel_row_type;
 
         pixel_buffer()
         {
         }
 
         pixel_buffer(size_t width, size_t height)
-            : basic_pixel_buffer< pixel_type,
-                                  pixel_row_type >(width, height)
+            : basic_buffer(width, height)
         {
         }
     };
@@ -471,23 +517,23 @@ namespace png
      * \brief The pixel buffer class template specialization for the
      * packed_index_pixel type.
      */
-    template< size_t bits >
-    class pixel_buffer< packed_index_pixel< bits > >
-        : public basic_pixel_buffer< packed_index_pixel< bits >,
-                                     packed_pixel_row< packed_index_pixel
-                                                       < bits > > >
+    template< size_t bits, class allocator >
+    class pixel_buffer< packed_index_pixel< bits >, allocator >
+        : public detail::packed_pixel_buffer_base
+                 < packed_index_pixel< bits >, allocator >::type
     {
     public:
         typedef packed_index_pixel< bits > pixel_type;
-        typedef packed_pixel_row< pixel_type > pixel_row_type;
+        typedef typename detail::packed_pixel_buffer_base
+                         < pixel_type, allocator >::type basic_buffer;
+        typedef typename basic_buffer::row_type pixel_row_type;
 
         pixel_buffer()
         {
         }
 
         pixel_buffer(size_t width, size_t height)
-            : basic_pixel_buffer< pixel_type,
-                                  pixel_row_type >(width, height)
+            : basic_buffer(width, height)
         {
         }
     };
@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_PIXEL_BUFFER_VIEW_HPP_INCLUDED
+#define PNGPP_PIXEL_BUFFER_VIEW_HPP_INCLUDED
+
+#include <cstddef>
+#include <stdexcept>
+
+#include "config.hpp"
+#include "error.hpp"
+#include "packed_pixel.hpp"
+#include "contiguous_pixel_buffer.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief Pixel buffer over memory owned by the caller.
+     *
+     * Wraps a pointer to the first (top) row, a width and height in
+     * pixels and the distance between the starts of consecutive rows
+     * in bytes.  The stride may be negative for bottom-up layouts:
+     * then \a data is the address of the last row in memory.  Use it
+     * as image's pixel buffer type to decode straight into a frame
+     * buffer, shared memory segment or tensor, or to encode from one,
+     * without a copy:
+     *
+     * \code
+     * png::image< png::rgba_pixel, png::pixel_buffer_view< png::rgba_pixel > >
+     *     image;
+     * image.set_pixbuf(png::pixel_buffer_view< png::rgba_pixel >
+     *                  (frame, 1920, 1080, frame_stride));
+     * image.read("input.png");
+     * \endcode
+     *
+     * set_pixbuf() also sets the image size to that of the view, so
+     * a freshly wrapped view may be written straight away:
+     *
+     * \code
+     * image.set_pixbuf(png::pixel_buffer_view< png::rgba_pixel >
+     *                  (frame, 640, 480, frame_stride));
+     * image.write("output.png");
+     * \endcode
+     *
+     * The width and height passed to the constructor are the
+     * capacity: resize() never allocates, it only changes the
+     * dimensions within that capacity and throws png::error if the
+     * new size does not fit.  The pixels are left untouched.
+     * Copies of a view refer to the same memory, which must outlive
+     * all of them.
+     */
+    template< typename pixel >
+    class pixel_buffer_view
+    {
+    public:
+        struct row_traits
+        {
+            typedef row_view< pixel > row_access;
+            typedef row_view< pixel const > row_const_access;
+
+            static byte* get_data(row_access row)
+            {
+                return reinterpret_cast< byte* >(row.data());
+            }
+        };
+
+        /**
+         * \brief A row of pixel data.
+         */
+        typedef typename row_traits::row_access row_access;
+        typedef typename row_traits::row_const_access row_const_access;
+        typedef row_access row_type;
+
+        /**
+         * \brief Constructs an empty view with no capacity.
+         */
+        pixel_buffer_view()
+            : m_data(0),
+              m_stride(0),
+              m_width(0),
+              m_height(0),
+              m_max_width(0),
+              m_max_height(0)
+        {
+        }
+
+        /**
+         * \brief Constructs a view of \a height rows of \a width
+         * pixels with no gaps between the rows.
+         */
+        pixel_buffer_view(pixel* data, size_t width, size_t height)
+            : m_data(reinterpret_cast< byte* >(data)),
+              m_stride(static_cast< ptrdiff_t >(width * sizeof(pixel))),
+              m_width(width),
+              m_height(height),
+              m_max_width(width),
+              m_max_height(height)
+        {
+            check_data();
+        }
+
+        /**
+         * \brief Constructs a view of \a height rows of \a width
+         * pixels, \a stride bytes apart.
+         */
+        pixel_buffer_view(pixel* data, size_t width, size_t height,
+                          ptrdiff_t stride)
+            : m_data(reinterpret_cast< byte* >(data)),
+              m_stride(stride),
+              m_width(width),
+              m_height(height),
+              m_max_width(width),
+              m_max_height(height)
+        {
+            size_t const size = stride < 0 ? -stride : stride;
+            if (height > 1 && size < width * sizeof(pixel))
+            {
+                throw error("pixel_buffer_view: rows overlap");
+            }
+            check_data();
+        }
+
+        size_t get_width() const
+        {
+            return m_width;
+        }
+
+        size_t get_height() const
+        {
+            return m_height;
+        }
+
+        /**
+         * \brief Returns the distance between the starts of two
+         * consecutive rows in bytes, negative for bottom-up layouts.
+         */
+        ptrdiff_t get_stride() const
+        {
+            return m_stride;
+        }
+
+        /**
+         * \brief Returns the start of the first row.
+         */
+        pixel* get_data() const
+        {
+            return reinterpret_cast< pixel* >(m_data);
+        }
+
+        /**
+         * \brief Changes the dimensions of the view.
+         *
+         * Throws png::error if \a width or \a height exceeds the
+         * size the view was constructed with.
+         */
+        void resize(size_t width, size_t height)
+        {
+            if (width > m_max_width || height > m_max_height)
+            {
+                throw error("pixel_buffer_view: image does not fit the buffer");
+            }
+            m_width = width;
+            m_height = height;
+        }
+
+        /**
+         * \brief Returns a view of the row of image data at
+         * specified index.
+         *
+         * Checks the index before returning a row: an instance of
+         * std::out_of_range is thrown if \c index is greater than \c
+         * height.
+         */
+        row_access get_row(size_t index) const
+        {
+            if (index >= m_height)
+            {
+                throw std::out_of_range("pixel_buffer_view::get_row");
+            }
+            return (*this)[index];
+        }
+
+        /**
+         * \brief The non-checking version of get_row() method.
+         */
+        row_access operator[](size_t index) const
+        {
+            return row_access(reinterpret_cast< pixel* >
+                              (m_data + static_cast< ptrdiff_t >(index)
+                               * m_stride), m_width);
+        }
+
+        /**
+         * \brief Replaces the row at specified index.
+         *
+         * Throws std::out_of_range if \c index is not less than the
+         * height or \a r holds fewer pixels than the width.
+         */
+        void put_row(size_t index, row_const_access r)
+        {
+            row_access row = get_row(index);
+            if (r.size() < m_width)
+            {
+                throw std::out_of_range("pixel_buffer_view::put_row");
+            }
+            for (size_t i = 0; i < m_width; ++i)
+            {
+                row[i] = r[i];
+            }
+        }
+
+        /**
+         * \brief Returns a pixel at (x,y) position.
+         */
+        pixel get_pixel(size_t x, size_t y) const
+        {
+            return get_row(y).at(x);
+        }
+
+        /**
+         * \brief Replaces a pixel at (x,y) position.
+         */
+        void set_pixel(size_t x, size_t y, pixel p)
+        {
+            get_row(y).at(x) = p;
+        }
+
+    private:
+        void check_data() const
+        {
+            if (m_data == 0 && m_width != 0 && m_height != 0)
+            {
+                throw error("pixel_buffer_view: null data");
+            }
+        }
+
+        byte* m_data;
+        ptrdiff_t m_stride;
+        size_t m_width;
+        size_t m_height;
+        size_t m_max_width;
+        size_t m_max_height;
+    };
+
+    /**
+     * \brief pixel_buffer_view for packed_pixel is not implemented,
+     * see solid_pixel_buffer.
+     */
+    template< size_t bits >
+    class pixel_buffer_view< packed_pixel< bits > >;
+
+} // namespace png
+
+#endif // PNGPP_PIXEL_BUFFER_VIEW_HPP_INCLUDED
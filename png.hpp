@@ -48,16 +48,40 @@
 #include "info_base.hpp"
 #include "info.hpp"
 #include "end_info.hpp"
+#include "memory_resource.hpp"
+#include "memory_cache.hpp"
+#include "arena.hpp"
 #include "io_base.hpp"
+#include "compression_profile.hpp"
+#include "memory_stream.hpp"
+#include "mapped_file.hpp"
 #include "reader.hpp"
 #include "writer.hpp"
 #include "generator.hpp"
 #include "consumer.hpp"
+#include "push_reader.hpp"
+#include "push_consumer.hpp"
 #include "pixel_buffer.hpp"
 #include "solid_pixel_buffer.hpp"
+#include "contiguous_pixel_buffer.hpp"
+#include "pixel_buffer_view.hpp"
 #include "require_color_space.hpp"
 #include "convert_color_space.hpp"
+#include "trusted_input.hpp"
+#include "row_filter.hpp"
+#include "filter_strategy.hpp"
+#include "reduction.hpp"
+#include "quantizer.hpp"
+#include "native_decoder.hpp"
+#include "native_encoder.hpp"
+#include "parallel_encoder.hpp"
+#include "adam7.hpp"
 #include "image.hpp"
+#include "downscale_consumer.hpp"
+#include "probe.hpp"
+#include "thread_pool.hpp"
+#include "batch_decoder.hpp"
+#include "optimizer.hpp"
 
 /**
  * \mainpage
@@ -202,11 +226,18 @@
  * The same holds for reading images too.  You can use consumer class
  * template in order to read the image data row-by-row.  This might
  * help in applications which have to deal with large PNG images but
- * do not want to read the entire image into memory.
+ * do not want to read the entire image into memory.  If the PNG data
+ * itself arrives in pieces (e.g. from the network), push_consumer
+ * class template decodes it incrementally as the data is fed in.
  *
  * You can read or write images from/to generic IO stream, not only
  * file on disk.  Check out \c image::read(std::istream&),
  * \c image::write(std::ostream&) overloads in the reference manual.
+ * PNG data already in memory can be decoded without wrapping it in
+ * \c std::istringstream: pass a png::memory_istream to
+ * \c image::read_stream() or \c consumer::read().
+ * Likewise, png::memory_ostream encodes straight into a
+ * \c std::vector of bytes.
  *
  * \section sec_compiling_user Compiling your programs
  *
@@ -0,0 +1,327 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_PROBE_HPP_INCLUDED
+#define PNGPP_PROBE_HPP_INCLUDED
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "error.hpp"
+#include "image_info.hpp"
+
+#ifdef PNGPP_HAS_POSIX_IO
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace png
+{
+
+    namespace detail
+    {
+
+        class probe_memory_source
+        {
+        public:
+            probe_memory_source(void const* data, size_t size)
+                : m_data(static_cast< byte const* >(data)),
+                  m_size(size),
+                  m_pos(0)
+            {
+            }
+
+            void read(byte* buffer, size_t count)
+            {
+                if (count > m_size - m_pos)
+                {
+                    throw error("probe: unexpected end of data");
+                }
+                std::memcpy(buffer, m_data + m_pos, count);
+                m_pos += count;
+            }
+
+            void skip(size_t count)
+            {
+                if (count > m_size - m_pos)
+                {
+                    throw error("probe: unexpected end of data");
+                }
+                m_pos += count;
+            }
+
+        private:
+            byte const* m_data;
+            size_t m_size;
+            size_t m_pos;
+        };
+
+#ifdef PNGPP_HAS_POSIX_IO
+        class probe_fd_source
+        {
+        public:
+            explicit probe_fd_source(int fd)
+                : m_fd(fd)
+            {
+            }
+
+            void read(byte* buffer, size_t count)
+            {
+                while (count)
+                {
+                    ssize_t n = ::read(m_fd, buffer, count);
+                    if (n < 0)
+                    {
+                        throw std_error("probe");
+                    }
+                    if (n == 0)
+                    {
+                        throw error("probe: unexpected end of data");
+                    }
+                    buffer += n;
+                    count -= n;
+                }
+            }
+
+            void skip(size_t count)
+            {
+                if (lseek(m_fd, count, SEEK_CUR) == -1)
+                {
+                    // not seekable (pipe, socket): read through a
+                    // small buffer whatever the chunk length
+                    byte buffer[4096];
+                    while (count)
+                    {
+                        size_t const n = count < sizeof(buffer)
+                            ? count : sizeof(buffer);
+                        read(buffer, n);
+                        count -= n;
+                    }
+                }
+            }
+
+        private:
+            int m_fd;
+        };
+#endif
+
+        inline uint_32 probe_get_uint_32(byte const* buf)
+        {
+            return (uint_32(buf[0]) << 24) | (uint_32(buf[1]) << 16)
+                | (uint_32(buf[2]) << 8) | uint_32(buf[3]);
+        }
+
+        inline bool probe_valid_bit_depth(int color_value, int depth)
+        {
+            switch (color_value)
+            {
+            case color_type_gray:
+                return depth == 1 || depth == 2 || depth == 4
+                    || depth == 8 || depth == 16;
+            case color_type_palette:
+                return depth == 1 || depth == 2 || depth == 4
+                    || depth == 8;
+            case color_type_rgb:
+            case color_type_gray_alpha:
+            case color_type_rgb_alpha:
+                return depth == 8 || depth == 16;
+            }
+            return false;
+        }
+
+        template< class source >
+        image_info probe(source& src, std::vector< std::string >* chunks)
+        {
+            static byte const signature[8] =
+                { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+            // signature + IHDR chunk header + IHDR data + CRC
+            byte buf[8 + 8 + 13 + 4];
+            src.read(buf, sizeof(buf));
+            if (std::memcmp(buf, signature, 8) != 0)
+            {
+                throw error("probe: not a PNG data stream");
+            }
+            byte const* ihdr = buf + 16;
+            if (probe_get_uint_32(buf + 8) != 13
+                || std::memcmp(buf + 12, "IHDR", 4) != 0)
+            {
+                throw error("probe: IHDR chunk expected");
+            }
+
+            uint_32 width = probe_get_uint_32(ihdr);
+            uint_32 height = probe_get_uint_32(ihdr + 4);
+            int bit_depth = ihdr[8];
+            int color_value = ihdr[9];
+            if (width == 0 || height == 0
+                || width > PNG_UINT_31_MAX || height > PNG_UINT_31_MAX)
+            {
+                throw error("probe: invalid image dimensions");
+            }
+            if (!probe_valid_bit_depth(color_value, bit_depth))
+            {
+                throw error("probe: invalid color type and/or bit depth");
+            }
+            if (ihdr[12] > interlace_adam7)
+            {
+                throw error("probe: invalid interlace type");
+            }
+
+            image_info info;
+            info.set_width(width);
+            info.set_height(height);
+            info.set_bit_depth(bit_depth);
+            info.set_color_type(color_type(color_value));
+            info.set_compression_type(compression_type(ihdr[10]));
+            info.set_filter_type(filter_type(ihdr[11]));
+            info.set_interlace_type(interlace_type(ihdr[12]));
+
+            if (!chunks)
+            {
+                return info;
+            }
+            chunks->push_back("IHDR");
+            for (;;)
+            {
+                byte header[8];
+                src.read(header, sizeof(header));
+                uint_32 length = probe_get_uint_32(header);
+                std::string name(reinterpret_cast< char* >(header + 4), 4);
+                if (length > PNG_UINT_31_MAX)
+                {
+                    throw error("probe: invalid chunk length");
+                }
+                chunks->push_back(name);
+                if (name == "IDAT" || name == "IEND")
+                {
+                    break;
+                }
+                if (name == "PLTE" && color_value == color_type_palette)
+                {
+                    if (length % 3 != 0 || length > 3 * 256)
+                    {
+                        throw error("probe: invalid PLTE chunk");
+                    }
+                    byte data[3 * 256];
+                    src.read(data, length);
+                    palette& plte = info.get_palette();
+                    plte.resize(length / 3);
+                    for (size_t i = 0; i < plte.size(); ++i)
+                    {
+                        plte[i] = color(data[3 * i],
+                                        data[3 * i + 1],
+                                        data[3 * i + 2]);
+                    }
+                    src.skip(4); // CRC
+                }
+                else if (name == "tRNS" && color_value == color_type_palette)
+                {
+                    if (length > 256)
+                    {
+                        throw error("probe: invalid tRNS chunk");
+                    }
+                    byte data[256];
+                    src.read(data, length);
+                    info.get_tRNS().assign(data, data + length);
+                    src.skip(4); // CRC
+                }
+                else
+                {
+                    src.skip(size_t(length) + 4);
+                }
+            }
+            return info;
+        }
+
+    } // namespace detail
+
+    /**
+     * \brief Reads basic image %info from PNG data in memory without
+     * setting up libpng.
+     *
+     * Only the PNG signature and the IHDR chunk are parsed, so this
+     * is much cheaper than constructing a reader and calling
+     * reader::read_info() when all you need is the image dimensions,
+     * %color type or bit depth.  Chunk CRCs are not checked.  Throws
+     * png::error if the data does not start with a valid PNG header.
+     */
+    inline image_info probe(void const* data, size_t size)
+    {
+        detail::probe_memory_source src(data, size);
+        return detail::probe< detail::probe_memory_source >(src, 0);
+    }
+
+    /**
+     * \brief Reads basic image %info from PNG data in memory and
+     * lists the chunks preceding image data.
+     *
+     * Like probe(void const*, size_t), but also walks the chunks up
+     * to and including the first IDAT (or IEND), storing their names
+     * in \a chunks.  The palette and the palette transparency map of
+     * %color-mapped images are stored in the returned image_info.
+     */
+    inline image_info probe(void const* data, size_t size,
+                            std::vector< std::string >& chunks)
+    {
+        detail::probe_memory_source src(data, size);
+        return detail::probe< detail::probe_memory_source >(src, & chunks);
+    }
+
+#ifdef PNGPP_HAS_POSIX_IO
+    /**
+     * \brief Reads basic image %info from the file descriptor \a fd,
+     * starting at its current position.
+     *
+     * \see probe(void const*, size_t)
+     */
+    inline image_info probe(int fd)
+    {
+        detail::probe_fd_source src(fd);
+        return detail::probe< detail::probe_fd_source >(src, 0);
+    }
+
+    /**
+     * \brief Reads basic image %info from the file descriptor \a fd
+     * and lists the chunks preceding image data.
+     *
+     * \see probe(void const*, size_t, std::vector< std::string >&)
+     */
+    inline image_info probe(int fd, std::vector< std::string >& chunks)
+    {
+        detail::probe_fd_source src(fd);
+        return detail::probe< detail::probe_fd_source >(src, & chunks);
+    }
+#endif
+
+} // namespace png
+
+#endif // PNGPP_PROBE_HPP_INCLUDED
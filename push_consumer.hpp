@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_PUSH_CONSUMER_HPP_INCLUDED
+#define PNGPP_PUSH_CONSUMER_HPP_INCLUDED
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include "config.hpp"
+#include "error.hpp"
+#include "streaming_base.hpp"
+#include "push_reader.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief Push-mode pixel consumer class template.
+     *
+     * Works like consumer, except that the PNG data is not pulled
+     * from a stream but pushed by the caller in pieces of arbitrary
+     * size as they become available (e.g. network fragments):
+     *
+     * \code
+     * class pixel_consumer
+     *     : public png::push_consumer< pixel, pixel_consumer >
+     * {
+     *     ...
+     * };
+     *
+     * pixel_consumer pixcon;
+     * while (... more data ...)
+     * {
+     *     pixcon.feed(data, size);
+     * }
+     * assert(pixcon.is_done());
+     * \endcode
+     *
+     * Rows are delivered through the same \c get_next_row() and \c
+     * reset() methods consumer uses, as soon as libpng has decoded
+     * them, so only the current compressed window and one row need
+     * to be kept in memory for non-interlaced images.
+     *
+     * Additionally, your class may implement the \c transform()
+     * method to set up IO transformation once the image %info is
+     * known (by default no transformation is applied):
+     *
+     * \code
+     * void transform(png::io_base& io);
+     * \endcode
+     *
+     * For example, call \c png::convert_color_space< pixel >()(io)
+     * there to convert any image to the \c pixel color space.
+     *
+     * Interlaced images are only supported if \c
+     * interlacing_supported is \c true: the rows returned by \c
+     * get_next_row() must then keep their contents between passes
+     * since each pass is merged into the pixels delivered by the
+     * previous ones.  Otherwise an attempt to read an interlaced
+     * image results in an error.
+     *
+     * A push_consumer object decodes a single image.
+     *
+     * \see consumer, push_reader
+     */
+    template< typename pixel,
+              class pixcon,
+              class info_holder = def_image_info_holder,
+              bool interlacing_supported = false >
+    class push_consumer
+        : public streaming_base< pixel, info_holder >
+    {
+    public:
+        typedef pixel_traits< pixel > traits;
+
+        /**
+         * \brief Feeds the next \a size bytes of PNG data.  Throws
+         * png::error if the data is malformed or the consumer fails.
+         */
+        void feed(byte const* data, size_t size)
+        {
+            m_reader.process_data(data, size);
+        }
+
+        /**
+         * \brief Returns \c true once the end of the PNG data stream
+         * has been processed.
+         */
+        bool is_done() const
+        {
+            return m_done;
+        }
+
+    protected:
+        typedef streaming_base< pixel, info_holder > base;
+        typedef push_reader< push_consumer > reader_type;
+
+        /**
+         * \brief Constructs a push_consumer object using passed
+         * image_info object to store image information.
+         */
+        explicit push_consumer(image_info& info)
+            : base(info),
+              m_reader(*this),
+              m_pass(0),
+              m_started(false),
+              m_done(false)
+        {
+        }
+
+        /**
+         * \brief The default io transformation: does nothing.
+         */
+        void transform(io_base&)
+        {
+        }
+
+    private:
+        friend class push_reader< push_consumer >;
+
+        void on_info(reader_type& rd)
+        {
+            pixcon* pixel_con = static_cast< pixcon* >(this);
+            pixel_con->transform(rd);
+
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+            if (traits::get_bit_depth() == 16)
+            {
+#ifdef PNG_READ_SWAP_SUPPORTED
+                rd.set_swap();
+#else
+                throw error("Cannot read 16-bit image: recompile with PNG_READ_SWAP_SUPPORTED.");
+#endif
+            }
+#endif
+
+            // interlace handling _must_ be set up prior to info update
+            if (rd.get_interlace_type() != interlace_none)
+            {
+                if (!interlacing_supported)
+                {
+                    throw std::logic_error("Cannot read interlaced image: push_consumer does not support it.");
+                }
+#ifdef PNG_READ_INTERLACING_SUPPORTED
+                rd.set_interlace_handling();
+#else
+                throw error("Cannot read interlaced image: interlace handling disabled.");
+#endif
+            }
+
+            rd.update_info();
+            if (rd.get_color_type() != traits::get_color_type()
+                || rd.get_bit_depth() != traits::get_bit_depth())
+            {
+                throw std::logic_error("color type and/or bit depth mismatch"
+                                       " in png::push_consumer::feed()");
+            }
+
+            this->get_info() = rd.get_image_info();
+        }
+
+        void on_row(reader_type& rd, byte* row, size_t pos, size_t pass)
+        {
+            pixcon* pixel_con = static_cast< pixcon* >(this);
+            if (!m_started || pass != m_pass)
+            {
+                m_started = true;
+                m_pass = pass;
+                pixel_con->reset(pass);
+            }
+            byte* dst = pixel_con->get_next_row(pos);
+            if (this->get_info().get_interlace_type() != interlace_none)
+            {
+                rd.combine_row(dst, row);
+            }
+            else
+            {
+                std::memcpy(dst, row, rd.get_rowbytes());
+            }
+        }
+
+        void on_end(reader_type&)
+        {
+            m_done = true;
+        }
+
+        reader_type m_reader;
+        size_t m_pass;
+        bool m_started;
+        bool m_done;
+    };
+
+} // namespace png
+
+#endif // PNGPP_PUSH_CONSUMER_HPP_INCLUDED
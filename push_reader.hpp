@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_PUSH_READER_HPP_INCLUDED
+#define PNGPP_PUSH_READER_HPP_INCLUDED
+
+#include <cassert>
+#include "io_base.hpp"
+
+namespace png
+{
+
+    /**
+     * \brief The progressive (push-mode) PNG reader class template.
+     * This is the low-level interface--use push_consumer class to
+     * actually read images.
+     *
+     * Unlike reader, which pulls data from a stream, push_reader is
+     * fed with data by the caller (see process_data()) and notifies
+     * the \c handler object as soon as image %info and rows become
+     * available.  The \c handler class should implement the
+     * following interface:
+     *
+     * \code
+     * class my_handler
+     * {
+     * public:
+     *     void on_info(push_reader< my_handler >&);
+     *     void on_row(push_reader< my_handler >&, byte* row,
+     *                 size_t pos, size_t pass);
+     *     void on_end(push_reader< my_handler >&);
+     * };
+     * \endcode
+     *
+     * Exceptions thrown by the handler are reported as png::error
+     * from process_data().
+     *
+     * \see push_consumer, reader, io_base
+     */
+    template< class handler >
+    class push_reader
+        : public io_base
+    {
+    public:
+        /**
+         * \brief Constructs a push_reader reporting to the \a
+         * handler object.
+         */
+        explicit push_reader(handler& hnd)
+            : io_base(create_read_struct(static_cast< io_base* >(this)))
+        {
+            png_set_progressive_read_fn(m_png, & hnd,
+                                        info_callback,
+                                        row_callback,
+                                        end_callback);
+        }
+
+        ~push_reader()
+        {
+            png_destroy_read_struct(& m_png,
+                                    m_info.get_png_info_ptr(),
+                                    m_end_info.get_png_info_ptr());
+        }
+
+        /**
+         * \brief Feeds the next \a size bytes of PNG data to the
+         * reader.  The data may be split at arbitrary positions.
+         */
+        void process_data(byte const* data, size_t size)
+        {
+            if (setjmp(png_jmpbuf(m_png)))
+            {
+                throw error(m_error);
+            }
+            png_process_data(m_png, m_info.get_png_info(),
+                             const_cast< byte* >(data), size);
+        }
+
+        void update_info()
+        {
+            m_info.update();
+        }
+
+        /**
+         * \brief Merges the pixels of an interlace pass in \a
+         * new_row into \a row.  A NULL \a new_row is ignored.
+         */
+        void combine_row(byte* row, byte const* new_row)
+        {
+            png_progressive_combine_row(m_png, row, new_row);
+        }
+
+        /**
+         * \brief Returns the size of a transformed row in bytes.
+         */
+        size_t get_rowbytes() const
+        {
+            return png_get_rowbytes(m_png, m_info.get_png_info());
+        }
+
+    private:
+        static push_reader* get_reader(png_struct* png)
+        {
+            io_base* io = static_cast< io_base* >(png_get_error_ptr(png));
+            return static_cast< push_reader* >(io);
+        }
+
+        static handler* get_handler(png_struct* png)
+        {
+            return static_cast< handler* >(png_get_progressive_ptr(png));
+        }
+
+        /*
+         * The callbacks are invoked from within libpng, so no
+         * exception may escape them: errors are recorded and raised
+         * through libpng's longjmp mechanism once the handler is
+         * left.
+         */
+        void record_exception()
+        {
+            try
+            {
+                throw;
+            }
+            catch (std::exception const& error)
+            {
+                set_error(error.what());
+            }
+            catch (...)
+            {
+                assert(!"push_reader: caught something wrong");
+                set_error("push_reader: caught something wrong");
+            }
+        }
+
+        static void info_callback(png_struct* png, png_info*)
+        {
+            push_reader* rd = get_reader(png);
+            rd->reset_error();
+            try
+            {
+                rd->m_info.fetch();
+                get_handler(png)->on_info(*rd);
+            }
+            catch (...)
+            {
+                rd->record_exception();
+            }
+            if (rd->is_error())
+            {
+                rd->raise_error();
+            }
+        }
+
+        static void row_callback(png_struct* png, byte* row,
+                                 uint_32 pos, int pass)
+        {
+            push_reader* rd = get_reader(png);
+            rd->reset_error();
+            try
+            {
+                get_handler(png)->on_row(*rd, row, pos, pass);
+            }
+            catch (...)
+            {
+                rd->record_exception();
+            }
+            if (rd->is_error())
+            {
+                rd->raise_error();
+            }
+        }
+
+        static void end_callback(png_struct* png, png_info*)
+        {
+            push_reader* rd = get_reader(png);
+            rd->reset_error();
+            try
+            {
+                get_handler(png)->on_end(*rd);
+            }
+            catch (...)
+            {
+                rd->record_exception();
+            }
+            if (rd->is_error())
+            {
+                rd->raise_error();
+            }
+        }
+    };
+
+} // namespace png
+
+#endif // PNGPP_PUSH_READER_HPP_INCLUDED
@@ -0,0 +1,830 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_QUANTIZER_HPP_INCLUDED
+#define PNGPP_QUANTIZER_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "config.hpp"
+#include "types.hpp"
+#include "error.hpp"
+#include "palette.hpp"
+#include "tRNS.hpp"
+#include "index_pixel.hpp"
+#include "pixel_traits.hpp"
+
+#ifdef PNGPP_HAS_STD_THREAD
+#include "thread_pool.hpp"
+#endif
+
+#ifdef PNGPP_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace png
+{
+
+    namespace detail
+    {
+
+        /*
+         * A color with 4 integer channels (red, green, blue, alpha).
+         */
+        struct quantize_color
+        {
+            int c[4];
+        };
+
+        inline int get_distance(quantize_color const& x,
+                                quantize_color const& y)
+        {
+            int const r = x.c[0] - y.c[0];
+            int const g = x.c[1] - y.c[1];
+            int const b = x.c[2] - y.c[2];
+            int const a = x.c[3] - y.c[3];
+            return r * r + g * g + b * b + a * a;
+        }
+
+        /*
+         * Colors are histogrammed in bins of 5 bits per color
+         * channel and 3 bits of alpha.
+         */
+        size_t const quantize_bins = 1 << 18;
+
+        inline size_t get_bin(int r, int g, int b, int a)
+        {
+            return size_t(r >> 3) << 13 | size_t(g >> 3) << 8
+                | size_t(b >> 3) << 3 | size_t(a >> 5);
+        }
+
+        /*
+         * Returns a representative color of a bin: the center of the
+         * bin, with the extreme alpha bins fully transparent and
+         * fully opaque.
+         */
+        inline quantize_color get_bin_color(size_t bin)
+        {
+            quantize_color color;
+            color.c[0] = int(bin >> 13 & 31) << 3 | 4;
+            color.c[1] = int(bin >> 8 & 31) << 3 | 4;
+            color.c[2] = int(bin >> 3 & 31) << 3 | 4;
+            int const a = int(bin & 7);
+            color.c[3] = a == 0 ? 0 : a == 7 ? 255 : a << 5 | 16;
+            return color;
+        }
+
+    } // namespace detail
+
+    /**
+     * \brief Converts truecolor images to %color-mapped ones with a
+     * palette of at most 256 entries.
+     *
+     * Images with no more distinct colors than the palette holds
+     * are converted exactly.  Otherwise the colors are counted in a
+     * histogram of 5 bits per color channel and 3 bits of alpha
+     * (one per thread, then merged), an initial palette is built by
+     * variance-based median cut over the histogram and refined by a
+     * few k-means iterations; the last one averages the actual
+     * pixels mapped to every entry.  Pixels are then mapped to their
+     * nearest entry, optionally with Floyd-Steinberg error diffusion
+     * (SSE2 where available).  Translucent entries come first in the
+     * palette, so the tRNS chunk stays short.
+     *
+     * \code
+     * png::image< png::rgba_pixel > truecolor("icon.png");
+     * png::image< png::index_pixel > indexed;
+     * png::quantizer quant;
+     * quant.set_max_colors(64);
+     * quant.quantize(truecolor, indexed);
+     * indexed.write("icon-64.png");
+     * \endcode
+     *
+     * Works with images of rgb_pixel and rgba_pixel.  Threads are
+     * used with C++11 (see \c PNGPP_HAS_STD_THREAD in config.hpp).
+     */
+    class quantizer
+    {
+    public:
+        quantizer()
+            : m_max_colors(256),
+              m_iterations(3),
+              m_dither(true),
+              m_thread_count(0)
+        {
+        }
+
+        /**
+         * \brief Returns the maximum number of palette entries (2
+         * to 256).
+         */
+        size_t get_max_colors() const
+        {
+            return m_max_colors;
+        }
+
+        void set_max_colors(size_t colors)
+        {
+            if (colors < 2 || colors > 256)
+            {
+                throw error("quantizer: palette size must be 2 to 256");
+            }
+            m_max_colors = colors;
+        }
+
+        /**
+         * \brief Returns the number of k-means iterations refining
+         * the median cut palette.
+         */
+        size_t get_iterations() const
+        {
+            return m_iterations;
+        }
+
+        void set_iterations(size_t iterations)
+        {
+            m_iterations = iterations;
+        }
+
+        /**
+         * \brief Returns whether error diffusion dithering is used.
+         */
+        bool get_dither() const
+        {
+            return m_dither;
+        }
+
+        void set_dither(bool dither)
+        {
+            m_dither = dither;
+        }
+
+        /**
+         * \brief Returns the number of threads used, 0 for one per
+         * hardware thread.
+         */
+        size_t get_thread_count() const
+        {
+            return m_thread_count;
+        }
+
+        void set_thread_count(size_t count)
+        {
+            m_thread_count = count;
+        }
+
+        /**
+         * \brief Converts \a src into \a dst, which is resized and
+         * gets the palette and tRNS of the result.
+         */
+        template< class source, class target >
+        void quantize(source const& src, target& dst) const
+        {
+            typedef typename source::traits traits;
+            size_t const channels = traits::get_channels();
+            if (traits::get_bit_depth() != 8 || channels < 3)
+            {
+                throw error("quantizer: expected rgb or rgba pixels");
+            }
+            size_t const width = src.get_width();
+            size_t const height = src.get_height();
+            dst.resize(width, height);
+            if (width == 0 || height == 0)
+            {
+                dst.set_palette(palette(1));
+                return;
+            }
+            std::vector< byte const* > rows(height);
+            for (size_t y = 0; y < height; ++y)
+            {
+                rows[y] = reinterpret_cast< byte const* >(& src[y][0]);
+            }
+            std::vector< byte > indices(width * height);
+
+#ifdef PNGPP_HAS_STD_THREAD
+            thread_pool pool(m_thread_count);
+            size_t const workers = pool.get_thread_count();
+            void* pool_ptr = & pool;
+#else
+            size_t const workers = 1;
+            void* pool_ptr = 0;
+#endif
+            work job(*this, rows, width, channels, pool_ptr, workers);
+            job.run(& indices[0]);
+
+            palette plte;
+            tRNS trns;
+            for (size_t i = 0; i < job.colors.size(); ++i)
+            {
+                detail::quantize_color const& c = job.colors[i];
+                plte.push_back(color(byte(c.c[0]), byte(c.c[1]),
+                                     byte(c.c[2])));
+                if (c.c[3] != 255)
+                {
+                    trns.push_back(byte(c.c[3]));
+                }
+            }
+            dst.set_palette(plte);
+            dst.set_tRNS(trns);
+            for (size_t y = 0; y < height; ++y)
+            {
+                for (size_t x = 0; x < width; ++x)
+                {
+                    dst[y][x] = index_pixel(indices[y * width + x]);
+                }
+            }
+        }
+
+    private:
+        typedef detail::quantize_color qcolor;
+
+        /*
+         * The state of one quantization.
+         */
+        struct work
+        {
+            work(quantizer const& q, std::vector< byte const* > const& r,
+                 size_t w, size_t ch, void* p, size_t n)
+                : options(q),
+                  rows(r),
+                  width(w),
+                  channels(ch),
+                  pool(p),
+                  workers(n),
+                  output(0)
+            {
+            }
+
+            qcolor get_pixel(size_t y, size_t x) const
+            {
+                byte const* p = rows[y] + x * channels;
+                qcolor color;
+                color.c[0] = p[0];
+                color.c[1] = p[1];
+                color.c[2] = p[2];
+                color.c[3] = channels == 4 ? p[3] : 255;
+                return color;
+            }
+
+            size_t get_height() const
+            {
+                return rows.size();
+            }
+
+            void run(byte* out)
+            {
+                if (find_exact(out))
+                {
+                    return;
+                }
+                build_histogram();
+                median_cut();
+                for (size_t i = 0; i < options.m_iterations; ++i)
+                {
+                    refine_bins();
+                }
+                refine_pixels();
+                sort_translucent_first();
+                nearest.assign(detail::quantize_bins, -1);
+                if (options.m_dither)
+                {
+                    dither(out);
+                }
+                else
+                {
+                    map(out);
+                }
+            }
+
+            /*
+             * Uses the colors of the image as the palette if there
+             * are few enough of them.
+             */
+            bool find_exact(byte* out)
+            {
+                size_t const size = 1024;
+                std::vector< unsigned > keys(size);
+                std::vector< int > slots(size, -1);
+                for (size_t y = 0; y < get_height(); ++y)
+                {
+                    for (size_t x = 0; x < width; ++x)
+                    {
+                        qcolor const c = get_pixel(y, x);
+                        unsigned const key = unsigned(c.c[0]) << 24
+                            | unsigned(c.c[1]) << 16
+                            | unsigned(c.c[2]) << 8 | unsigned(c.c[3]);
+                        size_t i = (key * 2654435761u) >> 22;
+                        while (slots[i] >= 0 && keys[i] != key)
+                        {
+                            i = (i + 1) % size;
+                        }
+                        if (slots[i] < 0)
+                        {
+                            if (colors.size() == options.m_max_colors)
+                            {
+                                colors.clear();
+                                return false;
+                            }
+                            keys[i] = key;
+                            slots[i] = int(colors.size());
+                            colors.push_back(c);
+                        }
+                        out[y * width + x] = byte(slots[i]);
+                    }
+                }
+                // translucent entries first
+                std::vector< int > order(colors.size());
+                std::vector< qcolor > sorted;
+                for (int pass = 0; pass < 2; ++pass)
+                {
+                    for (size_t i = 0; i < colors.size(); ++i)
+                    {
+                        if ((colors[i].c[3] == 255) == (pass == 1))
+                        {
+                            order[i] = int(sorted.size());
+                            sorted.push_back(colors[i]);
+                        }
+                    }
+                }
+                colors.swap(sorted);
+                for (size_t i = 0; i < width * get_height(); ++i)
+                {
+                    out[i] = byte(order[out[i]]);
+                }
+                return true;
+            }
+
+            typedef void (work::*task)(size_t begin, size_t end, size_t w);
+
+            /*
+             * Runs (this->*f)(begin, end, worker) over [0, count)
+             * split among the workers.
+             */
+            void parallel(task f, size_t count)
+            {
+#ifdef PNGPP_HAS_STD_THREAD
+                if (pool && workers > 1)
+                {
+                    thread_pool& threads = *static_cast< thread_pool* >(pool);
+                    for (size_t w = 0; w < workers; ++w)
+                    {
+                        size_t const begin = count * w / workers;
+                        size_t const end = count * (w + 1) / workers;
+                        threads.submit([this, f, begin, end, w]()
+                            {
+                                (this->*f)(begin, end, w);
+                            });
+                    }
+                    threads.wait();
+                    return;
+                }
+#endif
+                (this->*f)(0, count, 0);
+            }
+
+            void count_rows(size_t begin, size_t end, size_t w)
+            {
+                std::vector< unsigned >& c = partial_counts[w];
+                c.assign(detail::quantize_bins, 0);
+                for (size_t y = begin; y < end; ++y)
+                {
+                    for (size_t x = 0; x < width; ++x)
+                    {
+                        qcolor const p = get_pixel(y, x);
+                        ++c[detail::get_bin(p.c[0], p.c[1], p.c[2], p.c[3])];
+                    }
+                }
+            }
+
+            void build_histogram()
+            {
+                partial_counts.resize(workers);
+                parallel(& work::count_rows, get_height());
+                for (size_t bin = 0; bin < detail::quantize_bins; ++bin)
+                {
+                    size_t count = 0;
+                    for (size_t w = 0; w < workers; ++w)
+                    {
+                        if (!partial_counts[w].empty())
+                        {
+                            count += partial_counts[w][bin];
+                        }
+                    }
+                    if (count)
+                    {
+                        bins.push_back(bin);
+                        bin_colors.push_back(detail::get_bin_color(bin));
+                        counts.push_back(count);
+                    }
+                }
+            }
+
+            struct box
+            {
+                size_t begin;
+                size_t end;
+                size_t axis;
+                double error;
+            };
+
+            /*
+             * Finds the axis of largest weighted variance of the bins
+             * in [begin, end).
+             */
+            void measure(box& b, std::vector< size_t > const& items)
+            {
+                double sum[4] = { 0, 0, 0, 0 };
+                double squares[4] = { 0, 0, 0, 0 };
+                double total = 0;
+                for (size_t i = b.begin; i < b.end; ++i)
+                {
+                    qcolor const& c = bin_colors[items[i]];
+                    double const n = double(counts[items[i]]);
+                    total += n;
+                    for (size_t k = 0; k < 4; ++k)
+                    {
+                        sum[k] += n * c.c[k];
+                        squares[k] += n * c.c[k] * c.c[k];
+                    }
+                }
+                b.axis = 0;
+                b.error = -1;
+                for (size_t k = 0; k < 4; ++k)
+                {
+                    double const e = squares[k] - sum[k] * sum[k] / total;
+                    if (e > b.error)
+                    {
+                        b.error = e;
+                        b.axis = k;
+                    }
+                }
+                if (b.end - b.begin < 2)
+                {
+                    b.error = -1;
+                }
+            }
+
+            struct by_axis
+            {
+                by_axis(std::vector< qcolor > const& c, size_t a)
+                    : colors(c), axis(a)
+                {
+                }
+
+                bool operator()(size_t x, size_t y) const
+                {
+                    return colors[x].c[axis] < colors[y].c[axis];
+                }
+
+                std::vector< qcolor > const& colors;
+                size_t axis;
+            };
+
+            void median_cut()
+            {
+                std::vector< size_t > items(bins.size());
+                for (size_t i = 0; i < items.size(); ++i)
+                {
+                    items[i] = i;
+                }
+                std::vector< box > boxes(1);
+                boxes[0].begin = 0;
+                boxes[0].end = items.size();
+                measure(boxes[0], items);
+                while (boxes.size() < options.m_max_colors)
+                {
+                    size_t best = 0;
+                    for (size_t i = 1; i < boxes.size(); ++i)
+                    {
+                        if (boxes[i].error > boxes[best].error)
+                        {
+                            best = i;
+                        }
+                    }
+                    box b = boxes[best];
+                    if (b.error <= 0)
+                    {
+                        break;
+                    }
+                    std::sort(items.begin() + b.begin, items.begin() + b.end,
+                              by_axis(bin_colors, b.axis));
+                    size_t total = 0;
+                    for (size_t i = b.begin; i < b.end; ++i)
+                    {
+                        total += counts[items[i]];
+                    }
+                    size_t split = b.begin + 1;
+                    for (size_t seen = counts[items[b.begin]];
+                         split < b.end - 1 && 2 * seen < total; ++split)
+                    {
+                        seen += counts[items[split]];
+                    }
+                    box first = b;
+                    box second = b;
+                    first.end = split;
+                    second.begin = split;
+                    measure(first, items);
+                    measure(second, items);
+                    boxes[best] = first;
+                    boxes.push_back(second);
+                }
+                for (size_t i = 0; i < boxes.size(); ++i)
+                {
+                    double sum[4] = { 0, 0, 0, 0 };
+                    double total = 0;
+                    for (size_t j = boxes[i].begin; j < boxes[i].end; ++j)
+                    {
+                        double const n = double(counts[items[j]]);
+                        total += n;
+                        for (size_t k = 0; k < 4; ++k)
+                        {
+                            sum[k] += n * bin_colors[items[j]].c[k];
+                        }
+                    }
+                    qcolor c;
+                    for (size_t k = 0; k < 4; ++k)
+                    {
+                        c.c[k] = int(sum[k] / total + 0.5);
+                    }
+                    colors.push_back(c);
+                }
+            }
+
+            int find_nearest(qcolor const& c) const
+            {
+                int best = 0;
+                int best_distance = detail::get_distance(c, colors[0]);
+                for (size_t i = 1; i < colors.size(); ++i)
+                {
+                    int const d = detail::get_distance(c, colors[i]);
+                    if (d < best_distance)
+                    {
+                        best = int(i);
+                        best_distance = d;
+                    }
+                }
+                return best;
+            }
+
+            void assign_bins(size_t begin, size_t end, size_t)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    nearest[bins[i]] = find_nearest(bin_colors[i]);
+                }
+            }
+
+            /*
+             * Moves every palette entry to the weighted mean of the
+             * histogram bins nearest to it.
+             */
+            void refine_bins()
+            {
+                nearest.assign(detail::quantize_bins, -1);
+                parallel(& work::assign_bins, bins.size());
+                std::vector< double > sums(colors.size() * 5, 0.0);
+                for (size_t i = 0; i < bins.size(); ++i)
+                {
+                    double* s = & sums[nearest[bins[i]] * 5];
+                    double const n = double(counts[i]);
+                    for (size_t k = 0; k < 4; ++k)
+                    {
+                        s[k] += n * bin_colors[i].c[k];
+                    }
+                    s[4] += n;
+                }
+                update(sums);
+            }
+
+            /*
+             * Moves every palette entry to the mean of the pixels
+             * whose bin is nearest to it.
+             */
+            void sum_rows(size_t begin, size_t end, size_t w)
+            {
+                std::vector< double >& s = partial_sums[w];
+                s.assign(colors.size() * 5, 0.0);
+                for (size_t y = begin; y < end; ++y)
+                {
+                    for (size_t x = 0; x < width; ++x)
+                    {
+                        qcolor const p = get_pixel(y, x);
+                        double* e = & s[5 * nearest[detail::get_bin(
+                            p.c[0], p.c[1], p.c[2], p.c[3])]];
+                        for (size_t k = 0; k < 4; ++k)
+                        {
+                            e[k] += p.c[k];
+                        }
+                        e[4] += 1;
+                    }
+                }
+            }
+
+            void refine_pixels()
+            {
+                nearest.assign(detail::quantize_bins, -1);
+                parallel(& work::assign_bins, bins.size());
+                partial_sums.resize(workers);
+                parallel(& work::sum_rows, get_height());
+                std::vector< double > sums(colors.size() * 5, 0.0);
+                for (size_t w = 0; w < workers; ++w)
+                {
+                    for (size_t i = 0; i < partial_sums[w].size(); ++i)
+                    {
+                        sums[i] += partial_sums[w][i];
+                    }
+                }
+                update(sums);
+            }
+
+            void update(std::vector< double > const& sums)
+            {
+                for (size_t i = 0; i < colors.size(); ++i)
+                {
+                    double const* s = & sums[i * 5];
+                    if (s[4] > 0)
+                    {
+                        for (size_t k = 0; k < 4; ++k)
+                        {
+                            colors[i].c[k] = int(s[k] / s[4] + 0.5);
+                        }
+                    }
+                }
+            }
+
+            void sort_translucent_first()
+            {
+                std::vector< qcolor > sorted;
+                for (int pass = 0; pass < 2; ++pass)
+                {
+                    for (size_t i = 0; i < colors.size(); ++i)
+                    {
+                        if ((colors[i].c[3] == 255) == (pass == 1))
+                        {
+                            sorted.push_back(colors[i]);
+                        }
+                    }
+                }
+                colors.swap(sorted);
+            }
+
+            /*
+             * Returns the palette entry nearest to the bin of \c c,
+             * caching the answer per bin.
+             */
+            byte lookup(qcolor const& c)
+            {
+                size_t const bin
+                    = detail::get_bin(c.c[0], c.c[1], c.c[2], c.c[3]);
+                if (nearest[bin] < 0)
+                {
+                    nearest[bin] = find_nearest(c);
+                }
+                return byte(nearest[bin]);
+            }
+
+            void map_rows(size_t begin, size_t end, size_t)
+            {
+                for (size_t y = begin; y < end; ++y)
+                {
+                    for (size_t x = 0; x < width; ++x)
+                    {
+                        qcolor const p = get_pixel(y, x);
+                        output[y * width + x] = byte(nearest[detail::get_bin(
+                            p.c[0], p.c[1], p.c[2], p.c[3])]);
+                    }
+                }
+            }
+
+            void map(byte* out)
+            {
+                parallel(& work::assign_bins, bins.size());
+                output = out;
+                parallel(& work::map_rows, get_height());
+            }
+
+            /*
+             * Floyd-Steinberg error diffusion.  Errors are kept in
+             * sixteenths, four channels per pixel, with a pixel of
+             * padding on either side of the row.
+             */
+            void dither(byte* out)
+            {
+                std::vector< int > current((width + 2) * 4, 0);
+                std::vector< int > next((width + 2) * 4, 0);
+                for (size_t y = 0; y < get_height(); ++y)
+                {
+                    std::fill(next.begin(), next.end(), 0);
+                    for (size_t x = 0; x < width; ++x)
+                    {
+                        int* err = & current[(x + 1) * 4];
+                        int* below = & next[(x + 1) * 4];
+                        qcolor c = get_pixel(y, x);
+#ifdef PNGPP_HAS_SSE2
+                        __m128i v = _mm_setr_epi32(c.c[0], c.c[1],
+                                                   c.c[2], c.c[3]);
+                        __m128i e = _mm_loadu_si128(
+                            reinterpret_cast< __m128i const* >(err));
+                        v = _mm_add_epi32(v, _mm_srai_epi32(e, 4));
+                        // clamp to 0..255 by saturating packs
+                        v = _mm_packs_epi32(v, v);
+                        v = _mm_packus_epi16(v, v);
+                        v = _mm_unpacklo_epi8(v, _mm_setzero_si128());
+                        v = _mm_unpacklo_epi16(v, _mm_setzero_si128());
+                        _mm_storeu_si128(reinterpret_cast< __m128i* >(c.c),
+                                         v);
+                        byte const index = lookup(c);
+                        qcolor const& p = colors[index];
+                        __m128i const d = _mm_sub_epi32(v,
+                            _mm_setr_epi32(p.c[0], p.c[1], p.c[2], p.c[3]));
+                        __m128i const d2 = _mm_slli_epi32(d, 1);
+                        __m128i const d4 = _mm_slli_epi32(d, 2);
+                        __m128i const d8 = _mm_slli_epi32(d, 3);
+                        add(err + 4, _mm_sub_epi32(d8, d));   // 7/16
+                        add(below - 4, _mm_add_epi32(d2, d)); // 3/16
+                        add(below, _mm_add_epi32(d4, d));     // 5/16
+                        add(below + 4, d);                    // 1/16
+#else
+                        for (size_t k = 0; k < 4; ++k)
+                        {
+                            int const v = c.c[k] + (err[k] >> 4);
+                            c.c[k] = v < 0 ? 0 : v > 255 ? 255 : v;
+                        }
+                        byte const index = lookup(c);
+                        qcolor const& p = colors[index];
+                        for (size_t k = 0; k < 4; ++k)
+                        {
+                            int const d = c.c[k] - p.c[k];
+                            err[k + 4] += 7 * d;
+                            below[k - 4] += 3 * d;
+                            below[k] += 5 * d;
+                            below[k + 4] += d;
+                        }
+#endif
+                        out[y * width + x] = index;
+                    }
+                    current.swap(next);
+                }
+            }
+
+#ifdef PNGPP_HAS_SSE2
+            static void add(int* p, __m128i x)
+            {
+                __m128i* q = reinterpret_cast< __m128i* >(p);
+                _mm_storeu_si128(q, _mm_add_epi32(_mm_loadu_si128(q), x));
+            }
+#endif
+
+            quantizer const& options;
+            std::vector< byte const* > const& rows;
+            size_t width;
+            size_t channels;
+            void* pool;
+            size_t workers;
+            std::vector< size_t > bins;
+            std::vector< qcolor > bin_colors;
+            std::vector< size_t > counts;
+            std::vector< qcolor > colors;
+            std::vector< int > nearest;
+            std::vector< std::vector< unsigned > > partial_counts;
+            std::vector< std::vector< double > > partial_sums;
+            byte* output;
+        };
+
+        size_t m_max_colors;
+        size_t m_iterations;
+        bool m_dither;
+        size_t m_thread_count;
+    };
+
+} // namespace png
+
+#endif // PNGPP_QUANTIZER_HPP_INCLUDED
@@ -57,9 +57,14 @@ namespace png
      *
      * With the semantics similar to the \c std::istream.  Naturally,
      * \c std::istream fits this requirement and can be used with the
-     * reader class as is.
+     * reader class as is.  To read PNG data from a memory buffer
+     * use memory_istream.
      *
-     * \see image, consumer, writer, io_base
+     * libpng memory is allocated through the calling thread's current
+     * memory_resource, if any (see memory_resource::scope).
+     *
+     * \see image, consumer, writer, io_base, memory_istream,
+     * memory_resource
      */
     template< class istream >
     class reader
@@ -71,10 +76,7 @@ namespace png
          * a \a stream.
          */
         explicit reader(istream& stream)
-            : io_base(png_create_read_struct(PNG_LIBPNG_VER_STRING,
-                                             static_cast< io_base* >(this),
-                                             raise_error,
-                                             0))
+            : io_base(create_read_struct(static_cast< io_base* >(this)))
         {
             png_set_read_fn(m_png, & stream, read_data);
         }
@@ -102,6 +104,38 @@ namespace png
                          /* params = */ 0);
         }
 
+        /**
+         * \brief Switches off the integrity checks for input known
+         * to be intact, e.g. checksummed by the storage layer.
+         *
+         * Chunk CRCs are neither computed nor checked, ancillary
+         * chunks other than tRNS are skipped unparsed (so gamma,
+         * text and the like are not available) and, if \a
+         * check_adler32 is \c false and libpng supports it, the zlib
+         * Adler-32 checksum of the image data is not verified
+         * either.  Corrupted data may then produce garbage pixels
+         * instead of an error.
+         *
+         * Must be called before read_info().
+         *
+         * \see trusted_input
+         */
+        void set_trusted_input(bool check_adler32 = false)
+        {
+            set_crc_action(crc_quiet_use, crc_quiet_use);
+#ifdef PNG_HANDLE_AS_UNKNOWN_SUPPORTED
+            set_keep_unknown_chunks(handle_chunk_never, 0, -1);
+#endif
+#if defined(PNG_SET_OPTION_SUPPORTED) && defined(PNG_IGNORE_ADLER32)
+            if (!check_adler32)
+            {
+                png_set_option(m_png, PNG_IGNORE_ADLER32, PNG_OPTION_ON);
+            }
+#else
+            (void) check_adler32;
+#endif
+        }
+
         /**
          * \brief Reads info about PNG image.
          */
@@ -126,6 +160,31 @@ namespace png
             png_read_row(m_png, bytes, 0);
         }
 
+        /**
+         * \brief Reads \a count rows of image data at a time.
+         */
+        void read_rows(byte** rows, size_t count)
+        {
+            if (setjmp(png_jmpbuf(m_png)))
+            {
+                throw error(m_error);
+            }
+            png_read_rows(m_png, rows, 0, static_cast< png_uint_32 >(count));
+        }
+
+        /**
+         * \brief Reads the whole image, all interlace passes
+         * included, into the rows listed in \a rows.
+         */
+        void read_image(byte** rows)
+        {
+            if (setjmp(png_jmpbuf(m_png)))
+            {
+                throw error(m_error);
+            }
+            png_read_image(m_png, rows);
+        }
+
         /**
          * \brief Reads ending info about PNG image.
          */
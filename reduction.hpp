@@ -0,0 +1,401 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_REDUCTION_HPP_INCLUDED
+#define PNGPP_REDUCTION_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "types.hpp"
+#include "image_info.hpp"
+#include "row_filter.hpp"
+
+namespace png
+{
+
+    namespace detail
+    {
+
+        /*
+         * Finds the smallest lossless color type and bit depth for
+         * the pixels of an image and repacks its rows accordingly.
+         *
+         * The rows are given in the in-memory layout of png++ (16-bit
+         * samples in host byte order); repacked rows are in PNG byte
+         * order.  Every pixel is widened to 16-bit RGBA and the
+         * analysis records whether the alpha is opaque everywhere,
+         * whether the image is gray, whether all samples fit in 8
+         * bits, the smallest gray bit depth and up to 256 distinct
+         * colors in an open-addressing hash table.  Sources below 8
+         * bits per sample are copied through unchanged, and
+         * non-palette sources with a tRNS chunk keep their format.
+         */
+        class image_reduction
+        {
+        public:
+            image_reduction(image_info const& info,
+                            std::vector< byte const* > const& rows)
+                : m_source(info),
+                  m_target(info),
+                  m_rows(rows),
+                  m_opaque(true),
+                  m_gray(true),
+                  m_fits_8(true),
+                  m_gray_depth(1),
+                  m_too_many(false),
+                  m_verbatim(info.get_bit_depth() < 8),
+                  m_keys(table_size),
+                  m_slots(table_size, -1)
+            {
+                m_channels = get_color_channels(info.get_color_type());
+                if (m_verbatim
+                    || (info.get_color_type() != color_type_palette
+                        && !info.get_tRNS().empty()))
+                {
+                    return;
+                }
+                analyze();
+                choose();
+            }
+
+            /*
+             * Returns the header of the reduced image.
+             */
+            image_info const& get_info() const
+            {
+                return m_target;
+            }
+
+            size_t get_row_size() const
+            {
+                return (m_target.get_width()
+                        * get_color_channels(m_target.get_color_type())
+                        * m_target.get_bit_depth() + 7) / 8;
+            }
+
+            /*
+             * Writes row \c y of the reduced image to \c out.
+             */
+            void repack(size_t y, byte* out) const
+            {
+                if (m_verbatim)
+                {
+                    // packed rows are already in PNG layout
+                    std::memcpy(out, m_rows[y], get_row_size());
+                    return;
+                }
+                size_t const width = m_source.get_width();
+                size_t const depth = m_target.get_bit_depth();
+                color_type const ctype = m_target.get_color_type();
+                if (depth < 8)
+                {
+                    std::memset(out, 0, get_row_size());
+                    size_t const scale = 255 / ((1 << depth) - 1);
+                    for (size_t x = 0; x < width; ++x)
+                    {
+                        uint_64 const key = get_key(y, x);
+                        size_t const v = ctype == color_type_palette
+                            ? m_slots[find(key)]
+                            : size_t(key >> 56) / scale;
+                        size_t const bit = x * depth;
+                        out[bit / 8] |= byte(v << (8 - depth - bit % 8));
+                    }
+                    return;
+                }
+                size_t const channels = get_color_channels(ctype);
+                for (size_t x = 0; x < width; ++x)
+                {
+                    uint_64 const key = get_key(y, x);
+                    if (ctype == color_type_palette)
+                    {
+                        *out++ = byte(m_slots[find(key)]);
+                        continue;
+                    }
+                    unsigned const r = unsigned(key >> 48);
+                    unsigned const g = unsigned(key >> 32 & 0xffff);
+                    unsigned const b = unsigned(key >> 16 & 0xffff);
+                    unsigned const a = unsigned(key & 0xffff);
+                    unsigned samples[4] = { r, g, b, a };
+                    if (channels <= 2)
+                    {
+                        samples[1] = a;
+                    }
+                    for (size_t c = 0; c < channels; ++c)
+                    {
+                        if (depth == 16)
+                        {
+                            *out++ = byte(samples[c] >> 8);
+                        }
+                        *out++ = byte(samples[c] & 0xff);
+                    }
+                }
+            }
+
+        private:
+            typedef unsigned long long uint_64;
+
+            static size_t const table_size = 1024;
+            static size_t const max_colors = 256;
+
+            /*
+             * Returns pixel (x, y) as 16-bit RGBA packed into 64
+             * bits, red in the high bits.
+             */
+            uint_64 get_key(size_t y, size_t x) const
+            {
+                byte const* p = m_rows[y]
+                    + x * m_channels * (m_source.get_bit_depth() / 8);
+                unsigned s[4] = { 0, 0, 0, 0 };
+                if (m_source.get_color_type() == color_type_palette)
+                {
+                    palette const& plte = m_source.get_palette();
+                    tRNS const& trns = m_source.get_tRNS();
+                    size_t const i = *p;
+                    color const c = i < plte.size() ? plte[i] : color();
+                    s[0] = c.red * 257u;
+                    s[1] = c.green * 257u;
+                    s[2] = c.blue * 257u;
+                    s[3] = (i < trns.size() ? trns[i] : 255) * 257u;
+                }
+                else
+                {
+                    for (size_t c = 0; c < m_channels; ++c)
+                    {
+                        if (m_source.get_bit_depth() == 16)
+                        {
+                            uint_16 v;
+                            std::memcpy(& v, p + 2 * c, 2);
+                            s[c] = v;
+                        }
+                        else
+                        {
+                            s[c] = p[c] * 257u;
+                        }
+                    }
+                    switch (m_channels)
+                    {
+                    case 1:
+                        s[1] = s[2] = s[0];
+                        s[3] = 0xffff;
+                        break;
+                    case 2:
+                        s[3] = s[1];
+                        s[1] = s[2] = s[0];
+                        break;
+                    case 3:
+                        s[3] = 0xffff;
+                        break;
+                    }
+                }
+                return uint_64(s[0]) << 48 | uint_64(s[1]) << 32
+                    | uint_64(s[2]) << 16 | s[3];
+            }
+
+            size_t find(uint_64 key) const
+            {
+                size_t i = size_t((key * 0x9e3779b97f4a7c15ULL) >> 54);
+                while (m_slots[i] >= 0 && m_keys[i] != key)
+                {
+                    i = (i + 1) % table_size;
+                }
+                return i;
+            }
+
+            void analyze()
+            {
+                bool const has_alpha = m_channels == 2 || m_channels == 4
+                    || m_source.get_color_type() == color_type_palette;
+                bool const has_color = m_channels >= 3
+                    || m_source.get_color_type() == color_type_palette;
+                bool const wide = m_source.get_bit_depth() == 16;
+                bool first = true;
+                uint_64 last = 0;
+                for (size_t y = 0; y < m_source.get_height(); ++y)
+                {
+                    for (size_t x = 0; x < m_source.get_width(); ++x)
+                    {
+                        uint_64 const key = get_key(y, x);
+                        if (!first && key == last)
+                        {
+                            continue;
+                        }
+                        first = false;
+                        last = key;
+                        add(key);
+                    }
+                    // stop once the rest cannot change the outcome
+                    if (m_too_many && !(has_alpha && m_opaque)
+                        && !(has_color && m_gray)
+                        && !(wide && m_fits_8)
+                        && !(m_gray && m_gray_depth < 8))
+                    {
+                        break;
+                    }
+                }
+            }
+
+            void add(uint_64 key)
+            {
+                unsigned const r = unsigned(key >> 48);
+                unsigned const g = unsigned(key >> 32 & 0xffff);
+                unsigned const b = unsigned(key >> 16 & 0xffff);
+                unsigned const a = unsigned(key & 0xffff);
+                if (a != 0xffff)
+                {
+                    m_opaque = false;
+                }
+                if (r != g || g != b)
+                {
+                    m_gray = false;
+                }
+                if (r % 257 || g % 257 || b % 257 || a % 257)
+                {
+                    m_fits_8 = false;
+                    m_gray_depth = 16;
+                }
+                while (m_gray_depth < 8
+                       && (r >> 8) % (255 / ((1 << m_gray_depth) - 1)))
+                {
+                    m_gray_depth *= 2;
+                }
+                if (!m_too_many)
+                {
+                    size_t const i = find(key);
+                    if (m_slots[i] < 0)
+                    {
+                        if (m_colors.size() == max_colors)
+                        {
+                            m_too_many = true;
+                            return;
+                        }
+                        m_keys[i] = key;
+                        m_slots[i] = int(m_colors.size());
+                        m_colors.push_back(key);
+                    }
+                }
+            }
+
+            void choose()
+            {
+                size_t const width = m_source.get_width();
+                size_t const height = m_source.get_height();
+                size_t const depth = m_fits_8 ? 8 : 16;
+                color_type ctype;
+                size_t bits;
+                if (m_gray)
+                {
+                    ctype = m_opaque ? color_type_gray : color_type_gray_alpha;
+                    bits = m_opaque ? m_gray_depth : 2 * depth;
+                }
+                else
+                {
+                    ctype = m_opaque ? color_type_rgb : color_type_rgb_alpha;
+                    bits = (m_opaque ? 3 : 4) * depth;
+                }
+                size_t const direct = height * ((width * bits + 7) / 8);
+                m_target.set_color_type(ctype);
+                m_target.set_bit_depth(ctype == color_type_gray
+                                       ? m_gray_depth : depth);
+                m_target.drop_palette();
+                m_target.get_tRNS().clear();
+
+                if (m_too_many || !m_fits_8 || m_colors.empty())
+                {
+                    return;
+                }
+                size_t index_depth = 1;
+                while ((size_t(1) << index_depth) < m_colors.size())
+                {
+                    index_depth *= 2;
+                }
+                size_t const indexed = height * ((width * index_depth + 7) / 8)
+                    + 3 * m_colors.size() + (m_opaque ? 0 : m_colors.size());
+                if (indexed >= direct)
+                {
+                    return;
+                }
+
+                // translucent entries first to keep tRNS short
+                std::vector< uint_64 > order;
+                for (size_t i = 0; i < m_colors.size(); ++i)
+                {
+                    if ((m_colors[i] & 0xffff) != 0xffff)
+                    {
+                        order.push_back(m_colors[i]);
+                    }
+                }
+                size_t const translucent = order.size();
+                for (size_t i = 0; i < m_colors.size(); ++i)
+                {
+                    if ((m_colors[i] & 0xffff) == 0xffff)
+                    {
+                        order.push_back(m_colors[i]);
+                    }
+                }
+                palette plte;
+                tRNS trns;
+                for (size_t i = 0; i < order.size(); ++i)
+                {
+                    uint_64 const key = order[i];
+                    plte.push_back(color(byte(key >> 56), byte(key >> 40),
+                                         byte(key >> 24)));
+                    if (i < translucent)
+                    {
+                        trns.push_back(byte(key >> 8));
+                    }
+                    m_slots[find(key)] = int(i);
+                }
+                m_target.set_color_type(color_type_palette);
+                m_target.set_bit_depth(index_depth);
+                m_target.set_palette(plte);
+                m_target.set_tRNS(trns);
+            }
+
+            image_info m_source;
+            image_info m_target;
+            std::vector< byte const* > const& m_rows;
+            size_t m_channels;
+            bool m_opaque;
+            bool m_gray;
+            bool m_fits_8;
+            size_t m_gray_depth;
+            bool m_too_many;
+            bool m_verbatim;
+            std::vector< uint_64 > m_keys;
+            std::vector< int > m_slots;
+            std::vector< uint_64 > m_colors;
+        };
+
+    } // namespace detail
+
+} // namespace png
+
+#endif // PNGPP_REDUCTION_HPP_INCLUDED
@@ -0,0 +1,538 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_ROW_FILTER_HPP_INCLUDED
+#define PNGPP_ROW_FILTER_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstring>
+#include "config.hpp"
+#include "types.hpp"
+
+#ifdef PNGPP_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace png
+{
+
+    namespace detail
+    {
+
+        /*
+         * Returns the number of samples per pixel of \c ctype.
+         */
+        inline size_t get_color_channels(color_type ctype)
+        {
+            switch (ctype)
+            {
+            case color_type_gray_alpha: return 2;
+            case color_type_rgb: return 3;
+            case color_type_rgb_alpha: return 4;
+            default: return 1;
+            }
+        }
+
+        /*
+         * Reconstruction of filtered PNG rows (see the PNG
+         * specification, section 9).  \c row points to the \c size
+         * bytes of a row following the filter type byte, \c prev to
+         * the previous reconstructed row (all zeros for the first
+         * row) and \c bpp is the number of bytes per complete pixel,
+         * rounded up to 1.
+         */
+
+        inline void unfilter_sub(byte* row, size_t size, size_t bpp)
+        {
+            for (size_t i = bpp; i < size; ++i)
+            {
+                row[i] = byte(row[i] + row[i - bpp]);
+            }
+        }
+
+        inline void unfilter_up(byte* row, byte const* prev, size_t size)
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                row[i] = byte(row[i] + prev[i]);
+            }
+        }
+
+        inline void unfilter_avg(byte* row, byte const* prev, size_t size,
+                                 size_t bpp)
+        {
+            size_t i = 0;
+            for (; i < bpp && i < size; ++i)
+            {
+                row[i] = byte(row[i] + (prev[i] >> 1));
+            }
+            for (; i < size; ++i)
+            {
+                row[i] = byte(row[i] + ((row[i - bpp] + prev[i]) >> 1));
+            }
+        }
+
+        inline byte paeth_predictor(int a, int b, int c)
+        {
+            int pa = b - c;
+            int pb = a - c;
+            int pc = pa + pb;
+            pa = pa < 0 ? -pa : pa;
+            pb = pb < 0 ? -pb : pb;
+            pc = pc < 0 ? -pc : pc;
+            if (pa <= pb && pa <= pc)
+            {
+                return byte(a);
+            }
+            return byte(pb <= pc ? b : c);
+        }
+
+        inline void unfilter_paeth(byte* row, byte const* prev, size_t size,
+                                   size_t bpp)
+        {
+            size_t i = 0;
+            for (; i < bpp && i < size; ++i)
+            {
+                row[i] = byte(row[i] + prev[i]);
+            }
+            for (; i < size; ++i)
+            {
+                row[i] = byte(row[i] + paeth_predictor(row[i - bpp], prev[i],
+                                                       prev[i - bpp]));
+            }
+        }
+
+#ifdef PNGPP_HAS_SSE2
+
+        inline void sse2_unfilter_up(byte* row, byte const* prev, size_t size)
+        {
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16)
+            {
+                __m128i x = _mm_loadu_si128(reinterpret_cast< __m128i const* >
+                                            (row + i));
+                __m128i b = _mm_loadu_si128(reinterpret_cast< __m128i const* >
+                                            (prev + i));
+                _mm_storeu_si128(reinterpret_cast< __m128i* >(row + i),
+                                 _mm_add_epi8(x, b));
+            }
+            unfilter_up(row + i, prev + i, size - i);
+        }
+
+        /*
+         * Sub is a running sum: each 16-byte load holds as many whole
+         * pixels as fit, which are summed up in log2(pixels) shifted
+         * additions after adding the last pixel of the previous
+         * block to the first one.
+         */
+        template< size_t bpp >
+        void sse2_unfilter_sub(byte* row, size_t size)
+        {
+            size_t const block = bpp * (16 / bpp);
+            __m128i const mask = _mm_srli_si128(_mm_set1_epi8(-1),
+                                                16 - block);
+            __m128i last = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 16 <= size; i += block)
+            {
+                __m128i raw = _mm_loadu_si128(reinterpret_cast
+                                              < __m128i const* >(row + i));
+                __m128i x = _mm_add_epi8(raw, last);
+                x = _mm_add_epi8(x, _mm_slli_si128(x, bpp));
+                if (2 * bpp < block)
+                {
+                    x = _mm_add_epi8(x, _mm_slli_si128(x, 2 * bpp));
+                }
+                if (4 * bpp < block)
+                {
+                    x = _mm_add_epi8(x, _mm_slli_si128(x, 4 * bpp));
+                }
+                if (8 * bpp < block)
+                {
+                    x = _mm_add_epi8(x, _mm_slli_si128(x, 8 * bpp));
+                }
+                // keep the bytes past the block unfiltered
+                x = _mm_or_si128(_mm_and_si128(mask, x),
+                                 _mm_andnot_si128(mask, raw));
+                _mm_storeu_si128(reinterpret_cast< __m128i* >(row + i), x);
+                last = _mm_srli_si128(_mm_slli_si128(x, 16 - block),
+                                      16 - bpp);
+            }
+            for (i = i < bpp ? bpp : i; i < size; ++i)
+            {
+                row[i] = byte(row[i] + row[i - bpp]);
+            }
+        }
+
+        template< size_t bpp >
+        __m128i sse2_load_pixel(byte const* p)
+        {
+            byte buf[8] = { 0 };
+            std::memcpy(buf, p, bpp);
+            return _mm_loadl_epi64(reinterpret_cast< __m128i const* >(buf));
+        }
+
+        template< size_t bpp >
+        void sse2_store_pixel(byte* p, __m128i x)
+        {
+            byte buf[8];
+            _mm_storel_epi64(reinterpret_cast< __m128i* >(buf), x);
+            std::memcpy(p, buf, bpp);
+        }
+
+        /*
+         * Avg and Paeth depend on the reconstructed pixel to the
+         * left, so these go one pixel (3 to 8 bytes) at a time with
+         * all its channels in one register.  \c size must be a
+         * multiple of \c bpp.
+         */
+        template< size_t bpp >
+        void sse2_unfilter_avg(byte* row, byte const* prev, size_t size)
+        {
+            __m128i const one = _mm_set1_epi8(1);
+            __m128i a = _mm_setzero_si128();
+            for (size_t i = 0; i < size; i += bpp)
+            {
+                __m128i b = sse2_load_pixel< bpp >(prev + i);
+                // _mm_avg_epu8() rounds up, the filter rounds down
+                __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+                                           _mm_and_si128(_mm_xor_si128(a, b),
+                                                         one));
+                a = _mm_add_epi8(sse2_load_pixel< bpp >(row + i), avg);
+                sse2_store_pixel< bpp >(row + i, a);
+            }
+        }
+
+        inline __m128i sse2_abs_epi16(__m128i x)
+        {
+            return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+        }
+
+        inline __m128i sse2_select(__m128i mask, __m128i x, __m128i y)
+        {
+            return _mm_or_si128(_mm_and_si128(mask, x),
+                                _mm_andnot_si128(mask, y));
+        }
+
+        template< size_t bpp >
+        void sse2_unfilter_paeth(byte* row, byte const* prev, size_t size)
+        {
+            __m128i const zero = _mm_setzero_si128();
+            __m128i a = zero;
+            __m128i c = zero;
+            for (size_t i = 0; i < size; i += bpp)
+            {
+                __m128i b = _mm_unpacklo_epi8(sse2_load_pixel< bpp >
+                                              (prev + i), zero);
+                __m128i pa = _mm_sub_epi16(b, c);
+                __m128i pb = _mm_sub_epi16(a, c);
+                __m128i pc = sse2_abs_epi16(_mm_add_epi16(pa, pb));
+                pa = sse2_abs_epi16(pa);
+                pb = sse2_abs_epi16(pb);
+                __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+                __m128i nearest
+                    = sse2_select(_mm_cmpeq_epi16(smallest, pa), a,
+                                  sse2_select(_mm_cmpeq_epi16(smallest, pb),
+                                              b, c));
+                __m128i x = _mm_add_epi8(sse2_load_pixel< bpp >(row + i),
+                                         _mm_packus_epi16(nearest, zero));
+                sse2_store_pixel< bpp >(row + i, x);
+                a = _mm_unpacklo_epi8(x, zero);
+                c = b;
+            }
+        }
+
+#endif // PNGPP_HAS_SSE2
+
+        /*
+         * Filtering for writing: stores \c row filtered with the \c
+         * filter method into \c out.  Unlike reconstruction this has
+         * no dependency on neighbouring output bytes, so the SSE2
+         * kernels handle any pixel size.
+         */
+
+        inline void filter_sub(byte* out, byte const* row, size_t size,
+                               size_t bpp, size_t i = 0)
+        {
+            for (; i < bpp && i < size; ++i)
+            {
+                out[i] = row[i];
+            }
+            for (; i < size; ++i)
+            {
+                out[i] = byte(row[i] - row[i - bpp]);
+            }
+        }
+
+        inline void filter_up(byte* out, byte const* row, byte const* prev,
+                              size_t size, size_t i = 0)
+        {
+            for (; i < size; ++i)
+            {
+                out[i] = byte(row[i] - prev[i]);
+            }
+        }
+
+        inline void filter_avg(byte* out, byte const* row, byte const* prev,
+                               size_t size, size_t bpp, size_t i = 0)
+        {
+            for (; i < bpp && i < size; ++i)
+            {
+                out[i] = byte(row[i] - (prev[i] >> 1));
+            }
+            for (; i < size; ++i)
+            {
+                out[i] = byte(row[i] - ((row[i - bpp] + prev[i]) >> 1));
+            }
+        }
+
+        inline void filter_paeth(byte* out, byte const* row, byte const* prev,
+                                 size_t size, size_t bpp, size_t i = 0)
+        {
+            for (; i < bpp && i < size; ++i)
+            {
+                out[i] = byte(row[i] - prev[i]);
+            }
+            for (; i < size; ++i)
+            {
+                out[i] = byte(row[i] - paeth_predictor(row[i - bpp], prev[i],
+                                                       prev[i - bpp]));
+            }
+        }
+
+#ifdef PNGPP_HAS_SSE2
+
+        inline __m128i sse2_load(byte const* p)
+        {
+            return _mm_loadu_si128(reinterpret_cast< __m128i const* >(p));
+        }
+
+        inline void sse2_store(byte* p, __m128i x)
+        {
+            _mm_storeu_si128(reinterpret_cast< __m128i* >(p), x);
+        }
+
+        inline void sse2_filter_sub(byte* out, byte const* row, size_t size,
+                                    size_t bpp)
+        {
+            filter_sub(out, row, bpp < size ? bpp : size, bpp);
+            size_t i = bpp;
+            for (; i + 16 <= size; i += 16)
+            {
+                sse2_store(out + i, _mm_sub_epi8(sse2_load(row + i),
+                                                 sse2_load(row + i - bpp)));
+            }
+            filter_sub(out, row, size, bpp, i);
+        }
+
+        inline void sse2_filter_up(byte* out, byte const* row,
+                                   byte const* prev, size_t size)
+        {
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16)
+            {
+                sse2_store(out + i, _mm_sub_epi8(sse2_load(row + i),
+                                                 sse2_load(prev + i)));
+            }
+            filter_up(out, row, prev, size, i);
+        }
+
+        inline void sse2_filter_avg(byte* out, byte const* row,
+                                    byte const* prev, size_t size, size_t bpp)
+        {
+            filter_avg(out, row, prev, bpp < size ? bpp : size, bpp);
+            __m128i const one = _mm_set1_epi8(1);
+            size_t i = bpp;
+            for (; i + 16 <= size; i += 16)
+            {
+                __m128i a = sse2_load(row + i - bpp);
+                __m128i b = sse2_load(prev + i);
+                __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+                                           _mm_and_si128(_mm_xor_si128(a, b),
+                                                         one));
+                sse2_store(out + i, _mm_sub_epi8(sse2_load(row + i), avg));
+            }
+            filter_avg(out, row, prev, size, bpp, i);
+        }
+
+        inline void sse2_filter_paeth(byte* out, byte const* row,
+                                      byte const* prev, size_t size,
+                                      size_t bpp)
+        {
+            filter_paeth(out, row, prev, bpp < size ? bpp : size, bpp);
+            __m128i const zero = _mm_setzero_si128();
+            size_t i = bpp;
+            for (; i + 8 <= size; i += 8)
+            {
+                __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64
+                    (reinterpret_cast< __m128i const* >(row + i - bpp)), zero);
+                __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64
+                    (reinterpret_cast< __m128i const* >(prev + i)), zero);
+                __m128i c = _mm_unpacklo_epi8(_mm_loadl_epi64
+                    (reinterpret_cast< __m128i const* >(prev + i - bpp)),
+                                              zero);
+                __m128i pa = _mm_sub_epi16(b, c);
+                __m128i pb = _mm_sub_epi16(a, c);
+                __m128i pc = sse2_abs_epi16(_mm_add_epi16(pa, pb));
+                pa = sse2_abs_epi16(pa);
+                pb = sse2_abs_epi16(pb);
+                __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+                __m128i nearest
+                    = sse2_select(_mm_cmpeq_epi16(smallest, pa), a,
+                                  sse2_select(_mm_cmpeq_epi16(smallest, pb),
+                                              b, c));
+                __m128i x = _mm_loadl_epi64(reinterpret_cast< __m128i const* >
+                                            (row + i));
+                _mm_storel_epi64(reinterpret_cast< __m128i* >(out + i),
+                                 _mm_sub_epi8(x, _mm_packus_epi16(nearest,
+                                                                  zero)));
+            }
+            filter_paeth(out, row, prev, size, bpp, i);
+        }
+
+#endif // PNGPP_HAS_SSE2
+
+        /*
+         * Filters a row with the \c filter method (one of the \c
+         * PNG_FILTER_VALUE_* constants) for writing.
+         */
+        inline void filter_row(int filter, byte* out, byte const* row,
+                               byte const* prev, size_t size, size_t bpp)
+        {
+            switch (filter)
+            {
+            case PNG_FILTER_VALUE_SUB:
+#ifdef PNGPP_HAS_SSE2
+                sse2_filter_sub(out, row, size, bpp);
+#else
+                filter_sub(out, row, size, bpp);
+#endif
+                break;
+
+            case PNG_FILTER_VALUE_UP:
+#ifdef PNGPP_HAS_SSE2
+                sse2_filter_up(out, row, prev, size);
+#else
+                filter_up(out, row, prev, size);
+#endif
+                break;
+
+            case PNG_FILTER_VALUE_AVG:
+#ifdef PNGPP_HAS_SSE2
+                sse2_filter_avg(out, row, prev, size, bpp);
+#else
+                filter_avg(out, row, prev, size, bpp);
+#endif
+                break;
+
+            case PNG_FILTER_VALUE_PAETH:
+#ifdef PNGPP_HAS_SSE2
+                sse2_filter_paeth(out, row, prev, size, bpp);
+#else
+                filter_paeth(out, row, prev, size, bpp);
+#endif
+                break;
+
+            default:
+                std::memcpy(out, row, size);
+                break;
+            }
+        }
+
+        /*
+         * Reconstructs a row filtered with the \c filter method,
+         * using the SSE2 kernels where available.  Returns \c false
+         * for an unknown filter type.
+         */
+        inline bool unfilter_row(int filter, byte* row, byte const* prev,
+                                 size_t size, size_t bpp)
+        {
+            switch (filter)
+            {
+            case PNG_FILTER_VALUE_NONE:
+                return true;
+
+            case PNG_FILTER_VALUE_SUB:
+#ifdef PNGPP_HAS_SSE2
+                switch (bpp)
+                {
+                case 1: sse2_unfilter_sub< 1 >(row, size); return true;
+                case 2: sse2_unfilter_sub< 2 >(row, size); return true;
+                case 3: sse2_unfilter_sub< 3 >(row, size); return true;
+                case 4: sse2_unfilter_sub< 4 >(row, size); return true;
+                case 6: sse2_unfilter_sub< 6 >(row, size); return true;
+                case 8: sse2_unfilter_sub< 8 >(row, size); return true;
+                }
+#endif
+                unfilter_sub(row, size, bpp);
+                return true;
+
+            case PNG_FILTER_VALUE_UP:
+#ifdef PNGPP_HAS_SSE2
+                sse2_unfilter_up(row, prev, size);
+#else
+                unfilter_up(row, prev, size);
+#endif
+                return true;
+
+            case PNG_FILTER_VALUE_AVG:
+#ifdef PNGPP_HAS_SSE2
+                switch (bpp)
+                {
+                case 3: sse2_unfilter_avg< 3 >(row, prev, size); return true;
+                case 4: sse2_unfilter_avg< 4 >(row, prev, size); return true;
+                case 6: sse2_unfilter_avg< 6 >(row, prev, size); return true;
+                case 8: sse2_unfilter_avg< 8 >(row, prev, size); return true;
+                }
+#endif
+                unfilter_avg(row, prev, size, bpp);
+                return true;
+
+            case PNG_FILTER_VALUE_PAETH:
+#ifdef PNGPP_HAS_SSE2
+                switch (bpp)
+                {
+                case 3: sse2_unfilter_paeth< 3 >(row, prev, size); return true;
+                case 4: sse2_unfilter_paeth< 4 >(row, prev, size); return true;
+                case 6: sse2_unfilter_paeth< 6 >(row, prev, size); return true;
+                case 8: sse2_unfilter_paeth< 8 >(row, prev, size); return true;
+                }
+#endif
+                unfilter_paeth(row, prev, size, bpp);
+                return true;
+            }
+            return false;
+        }
+
+    } // namespace detail
+
+} // namespace png
+
+#endif // PNGPP_ROW_FILTER_HPP_INCLUDED
@@ -38,6 +38,7 @@
 #include <vector>
 
 #include "config.hpp"
+#include "memory_resource.hpp"
 #include "packed_pixel.hpp"
 #include "gray_pixel.hpp"
 #include "index_pixel.hpp"
@@ -49,12 +50,34 @@ namespace png
      * \brief Pixel buffer, that stores pixels as continuous memory chunk.
      * solid_pixel_buffer is useful when user whats to open png, do some
      * changes and fetch to buffer to draw (as texture for example).
+     *
+     * The bytes are allocated with \a allocator rebound to byte.
+     * Pass png::allocator< pixel > to allocate from the current
+     * memory_resource.
+     *
+     * Each row starts get_stride() bytes after the previous one: the
+     * row size rounded up to a multiple of \a row_alignment bytes.
+     * The default of 1 packs the rows without gaps.  Together with
+     * png::aligned_allocator, a \a row_alignment of 32 or 64 starts
+     * every row on an AVX or cache line boundary, so per-row SIMD
+     * kernels need no unaligned head or split loads:
+     *
+     * \code
+     * typedef png::solid_pixel_buffer
+     *     < png::rgba_pixel,
+     *       png::aligned_allocator< png::rgba_pixel, 64 >,
+     *       64 > aligned_buffer;
+     * \endcode
      */
-    template< typename pixel >
+    template< typename pixel, class allocator = std::allocator< pixel >,
+              size_t row_alignment = 1 >
     class solid_pixel_buffer
     {
     public:
         typedef pixel_traits< pixel > pixel_traits_t;
+        typedef std::vector< byte,
+                             typename detail::rebind_allocator
+                             < allocator, byte >::type > byte_vector;
         struct row_traits
         {
             typedef pixel* row_access;
@@ -105,6 +128,15 @@ namespace png
             return m_height;
         }
 
+        /**
+         * \brief Returns the distance between the starts of two
+         * consecutive rows in bytes.
+         */
+        size_t get_stride() const
+        {
+            return m_stride;
+        }
+
         /**
          * \brief Resizes the pixel buffer.
          *
@@ -115,7 +147,8 @@ namespace png
         {
             m_width = width;
             m_height = height;
-            m_stride = m_width * bytes_per_pixel;
+            m_stride = (m_width * bytes_per_pixel + row_alignment - 1)
+                / row_alignment * row_alignment;
             m_bytes.resize(height * m_stride);
         }
 
@@ -164,7 +197,7 @@ namespace png
          */
         void put_row(size_t index, row_const_access r)
         {
-            row_access row = get_row();
+            row_access row = get_row(index);
             for (size_t i = 0; i < m_width; ++i)
                 *row++ = *r++;
         }
@@ -174,7 +207,7 @@ namespace png
          */
         pixel get_pixel(size_t x, size_t y) const
         {
-            size_t index = (y * m_width + x) * bytes_per_pixel;
+            size_t index = y * m_stride + x * bytes_per_pixel;
             return *reinterpret_cast< const pixel* >(&m_bytes.at(index));
         }
 
@@ -183,14 +216,16 @@ namespace png
          */
         void set_pixel(size_t x, size_t y, pixel p)
         {
-            size_t index = (y * m_width + x) * bytes_per_pixel;
+            size_t index = y * m_stride + x * bytes_per_pixel;
             *reinterpret_cast< pixel* >(&m_bytes.at(index)) = p;
         }
 
         /**
          * \brief Provides easy constant read access to underlying byte-buffer.
+         *
+         * Rows are get_stride() bytes apart.
          */
-        const std::vector< byte >& get_bytes() const
+        const byte_vector& get_bytes() const
         {
             return m_bytes;
         }
@@ -199,7 +234,7 @@ namespace png
         /**
          * \brief Moves the buffer to client code (c++11 only) .
          */
-        std::vector< byte > fetch_bytes()
+        byte_vector fetch_bytes()
         {
             m_width = 0;
             m_height = 0;
@@ -218,7 +253,7 @@ namespace png
         size_t m_width;
         size_t m_height;
         size_t m_stride;
-        std::vector< byte > m_bytes;
+        byte_vector m_bytes;
 
 #ifdef PNGPP_HAS_STATIC_ASSERT
         static_assert(pixel_traits_t::bit_depth % CHAR_BIT == 0,
@@ -227,6 +262,10 @@ namespace png
         static_assert(sizeof(pixel) * CHAR_BIT ==
             pixel_traits_t::channels * pixel_traits_t::bit_depth,
             "pixel type should contain channels data only");
+
+        static_assert(row_alignment != 0
+                      && (row_alignment & (row_alignment - 1)) == 0,
+            "row_alignment should be a power of two");
 #endif
     };
 
@@ -235,8 +274,9 @@ namespace png
      * Should there be a gap between rows? How to deal with last
      * useless bits in last byte in buffer?
      */
-    template< size_t bits >
-    class solid_pixel_buffer< packed_pixel< bits > >;
+    template< size_t bits, class allocator, size_t row_alignment >
+    class solid_pixel_buffer< packed_pixel< bits >, allocator,
+                              row_alignment >;
 
 } // namespace png
 
@@ -110,11 +110,41 @@ namespace png
         }
 
     protected:
+        /**
+         * \brief The maximum number of rows requested from
+         * get_next_rows() at a time.
+         */
+        static size_t const rows_per_block = 64;
+
         void reset(size_t /*pass*/)
         {
             // nothing to do in the most general case
         }
 
+        size_t get_next_rows(size_t /*pos*/, size_t /*count*/,
+                             byte** /*rows*/)
+        {
+            // rows are handled one at a time by get_next_row()
+            return 0;
+        }
+
+        byte** get_image_rows()
+        {
+            // no table of all the rows
+            return 0;
+        }
+
+        bool finish_row(size_t /*pos*/)
+        {
+            // keep reading to the end of the image
+            return true;
+        }
+
+        bool finish_pass(size_t /*pass*/)
+        {
+            return true;
+        }
+
         image_info& get_info()
         {
             return m_info_holder.get_info();
@@ -123,6 +153,9 @@ namespace png
         info_holder m_info_holder;
     };
 
+    template< typename pixel, class info_holder >
+    size_t const streaming_base< pixel, info_holder >::rows_per_block;
+
 } // namespace png
 
 #endif // PNGPP_STREAMING_BASE_HPP_INCLUDED
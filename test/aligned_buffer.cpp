@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstring>
+#include <iostream>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include <png.hpp>
+
+/*
+ * Reads every image into solid_pixel_buffers with padded, aligned
+ * rows and checks the pixels against the default pixel_buffer, the
+ * row alignment and a write/read round trip.
+ */
+
+void
+print_usage()
+{
+    std::cerr << "usage: aligned_buffer FILE..." << std::endl;
+}
+
+template< class first, class second >
+bool
+same_pixels(first const& a, second const& b)
+{
+    if (a.get_width() != b.get_width() || a.get_height() != b.get_height())
+    {
+        return false;
+    }
+    for (size_t y = 0; y < a.get_height(); ++y)
+    {
+        if (a.get_width() != 0
+            && std::memcmp(& a[y][0], & b[y][0],
+                           a.get_width() * sizeof(a[y][0])) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template< typename pixel, class buffer >
+void
+check(char const* filename, size_t alignment)
+{
+    png::image< pixel, buffer > image(filename,
+                                      png::convert_color_space< pixel >());
+    png::image< pixel > reference(filename,
+                                  png::convert_color_space< pixel >());
+    if (!same_pixels(image.get_pixbuf(), reference.get_pixbuf()))
+    {
+        throw png::error("pixel mismatch");
+    }
+
+    buffer const& pixels = image.get_pixbuf();
+    size_t const stride = pixels.get_stride();
+    if (stride % alignment != 0
+        || stride < pixels.get_width() * sizeof(pixel)
+        || pixels.get_bytes().size() != stride * pixels.get_height())
+    {
+        throw png::error("bad stride");
+    }
+    for (size_t y = 0; y < pixels.get_height(); ++y)
+    {
+        if (reinterpret_cast< size_t >(pixels[y]) % alignment != 0)
+        {
+            throw png::error("row is not aligned");
+        }
+    }
+    size_t const x = pixels.get_width() - 1;
+    size_t const y = pixels.get_height() - 1;
+    if (std::memcmp(& pixels[y][x], & reference[y][x], sizeof(pixel)) != 0)
+    {
+        throw png::error("get_pixel does not follow the stride");
+    }
+
+    std::vector< png::byte > data;
+    png::memory_ostream out(data);
+    image.write_stream(out);
+    png::memory_istream in(& data[0], data.size());
+    png::image< pixel, buffer > copy;
+    copy.read_stream(in);
+    if (!same_pixels(copy.get_pixbuf(), image.get_pixbuf()))
+    {
+        throw png::error("round trip mismatch");
+    }
+}
+
+template< typename pixel >
+void
+check(char const* filename)
+{
+    check< pixel, png::solid_pixel_buffer
+           < pixel, png::aligned_allocator< pixel, 32 >, 32 > >
+        (filename, 32);
+    check< pixel, png::solid_pixel_buffer
+           < pixel, png::aligned_allocator< pixel, 64 >, 64 > >
+        (filename, 64);
+}
+
+#ifdef PNGPP_HAS_STD_MOVE
+/*
+ * Swapping buffers bound to different arenas exchanges their
+ * allocators along with the memory.
+ */
+void
+check_swap()
+{
+    typedef png::solid_pixel_buffer
+        < png::rgba_pixel, png::aligned_allocator< png::rgba_pixel, 64 >,
+          64 > buffer;
+    png::arena first(4096);
+    png::arena second(4096);
+    png::memory_resource::scope use_first(first);
+    buffer a(5, 3);
+    png::memory_resource::scope use_second(second);
+    buffer b(2, 2);
+    std::swap(a, b);
+    if (a.get_bytes().get_allocator().get_resource() != & second
+        || b.get_bytes().get_allocator().get_resource() != & first
+        || b.get_width() != 5)
+    {
+        throw png::error("swap did not exchange the allocators");
+    }
+}
+#endif
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc < 2)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        try
+        {
+            check< png::rgba_pixel >(filename);
+            check< png::rgb_pixel >(filename);
+            check< png::gray_pixel >(filename);
+            check< png::ga_pixel_16 >(filename);
+        }
+        catch (std::exception const& error)
+        {
+            std::cerr << filename << ": " << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+#ifdef PNGPP_HAS_STD_MOVE
+    check_swap();
+#endif
+
+    png::memory_cache cache;
+    png::memory_resource::scope use_cache(cache);
+    check< png::rgba_pixel >(argv[1]);
+}
+catch (std::exception const& error)
+{
+    std::cerr << "aligned_buffer: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
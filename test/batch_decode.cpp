@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <png.hpp>
+
+/*
+ * Decodes every file passed on the command line with batch_decoder
+ * and compares the results with sequential decoding.  A missing file
+ * is added to the batch to check that errors are reported per image.
+ */
+
+typedef png::rgba_pixel pixel;
+typedef png::image< pixel > image_type;
+
+bool
+equal(image_type const& a, image_type const& b)
+{
+    if (a.get_width() != b.get_width() || a.get_height() != b.get_height())
+    {
+        return false;
+    }
+    for (size_t y = 0; y < a.get_height(); ++y)
+    {
+        for (size_t x = 0; x < a.get_width(); ++x)
+        {
+            pixel p = a[y][x];
+            pixel q = b[y][x];
+            if (p.red != q.red || p.green != q.green || p.blue != q.blue
+                || p.alpha != q.alpha)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+struct callback_results
+{
+    std::vector< image_type > images;
+    std::vector< bool > failed;
+    std::mutex mutex;
+
+    void operator()(size_t index, image_type& image, std::exception_ptr error)
+    {
+        std::lock_guard< std::mutex > lock(mutex);
+        images[index] = image;
+        failed[index] = bool(error);
+    }
+};
+
+int
+main(int argc, char* argv[])
+try
+{
+    std::vector< std::string > files(argv + 1, argv + argc);
+    files.push_back("does-not-exist.png");
+
+    png::batch_decoder< pixel > decoder(4);
+    std::vector< std::future< image_type > > results = decoder.decode(files);
+
+    callback_results callback;
+    callback.images.resize(files.size());
+    callback.failed.resize(files.size());
+    decoder.decode(files, std::ref(callback));
+    decoder.wait();
+
+    int fails = 0;
+    for (size_t i = 0; i + 1 < files.size(); ++i)
+    {
+        image_type expected(files[i]);
+        if (!equal(results[i].get(), expected)
+            || callback.failed[i] || !equal(callback.images[i], expected))
+        {
+            std::cerr << "batch_decode: " << files[i] << " differs"
+                      << std::endl;
+            ++fails;
+        }
+    }
+    try
+    {
+        results.back().get();
+        std::cerr << "batch_decode: missing file not reported" << std::endl;
+        ++fails;
+    }
+    catch (std::exception const&)
+    {
+    }
+    if (!callback.failed.back())
+    {
+        std::cerr << "batch_decode: missing file not reported to callback"
+                  << std::endl;
+        ++fails;
+    }
+    return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    std::cerr << "batch_decode: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstring>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+/*
+ * Decodes every image into caller memory through pixel_buffer_view,
+ * top-down with padded rows and bottom-up with a negative stride,
+ * and checks the pixels against the default pixel_buffer, that the
+ * padding is left alone, that writing from the view round-trips,
+ * also from a freshly wrapped view, and that images larger than the
+ * view are rejected.
+ */
+
+void
+print_usage()
+{
+    std::cerr << "usage: buffer_view FILE..." << std::endl;
+}
+
+template< class first, class second >
+bool
+same_pixels(first const& a, second const& b)
+{
+    if (a.get_width() != b.get_width() || a.get_height() != b.get_height())
+    {
+        return false;
+    }
+    for (size_t y = 0; y < a.get_height(); ++y)
+    {
+        if (a.get_width() != 0
+            && std::memcmp(& a[y][0], & b[y][0],
+                           a.get_width() * sizeof(a[y][0])) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template< typename pixel, class buffer >
+png::pixel_buffer< pixel >
+write_read(png::image< pixel, buffer >& image)
+{
+    std::vector< png::byte > data;
+    png::memory_ostream out(data);
+    image.write_stream(out);
+    png::memory_istream in(& data[0], data.size());
+    png::image< pixel > copy;
+    copy.read_stream(in);
+    return copy.get_pixbuf();
+}
+
+png::byte const sentinel = 0xa5;
+
+template< typename pixel >
+void
+check(char const* filename, png::image< pixel > const& reference,
+      bool bottom_up)
+{
+    typedef png::pixel_buffer_view< pixel > view;
+
+    // room for two more columns and one more row than the image
+    size_t const width = reference.get_width() + 2;
+    size_t const height = reference.get_height() + 1;
+    ptrdiff_t const stride = width * sizeof(pixel) + 3;
+    std::vector< png::byte > memory(stride * height, sentinel);
+    pixel* first = reinterpret_cast< pixel* >
+        (bottom_up ? & memory[(height - 1) * stride] : & memory[0]);
+
+    png::image< pixel, view > image;
+    image.set_pixbuf(view(first, width, height,
+                          bottom_up ? -stride : stride));
+    image.read(filename, png::convert_color_space< pixel >());
+    if (image.get_pixbuf().get_data() != first
+        || !same_pixels(image.get_pixbuf(), reference.get_pixbuf()))
+    {
+        throw png::error("pixel mismatch");
+    }
+
+    size_t const row_size = reference.get_width() * sizeof(pixel);
+    for (size_t y = 0; y < height; ++y)
+    {
+        size_t const row = bottom_up ? height - 1 - y : y;
+        size_t const used = y < reference.get_height() ? row_size : 0;
+        for (size_t i = used; i < size_t(stride); ++i)
+        {
+            if (memory[row * stride + i] != sentinel)
+            {
+                throw png::error("bytes outside the image were written");
+            }
+        }
+    }
+
+    std::vector< png::byte > data;
+    png::memory_ostream out(data);
+    image.write_stream(out);
+    png::memory_istream in(& data[0], data.size());
+    png::image< pixel > copy;
+    copy.read_stream(in);
+    if (!same_pixels(copy.get_pixbuf(), reference.get_pixbuf()))
+    {
+        throw png::error("round trip mismatch");
+    }
+
+    // a freshly wrapped view is written without a read or resize()
+    png::image< pixel, view > fresh;
+    fresh.set_pixbuf(view(first, reference.get_width(),
+                          reference.get_height(),
+                          bottom_up ? -stride : stride));
+    if (!same_pixels(write_read(fresh), reference.get_pixbuf()))
+    {
+        throw png::error("fresh view round trip mismatch");
+    }
+
+    // and so is a shorter view swapped in afterwards
+    fresh.set_pixbuf(view(first, reference.get_width(),
+                          reference.get_height() / 2,
+                          bottom_up ? -stride : stride));
+    png::pixel_buffer< pixel > top = reference.get_pixbuf();
+    top.resize(reference.get_width(), reference.get_height() / 2);
+    if (reference.get_height() > 1
+        && !same_pixels(write_read(fresh), top))
+    {
+        throw png::error("shorter view round trip mismatch");
+    }
+
+    png::image< pixel, view > small;
+    small.set_pixbuf(view(first, reference.get_width(),
+                          reference.get_height() - 1,
+                          bottom_up ? -stride : stride));
+    try
+    {
+        small.read(filename, png::convert_color_space< pixel >());
+    }
+    catch (png::error const&)
+    {
+        return;
+    }
+    throw png::error("image larger than the view was accepted");
+}
+
+template< typename pixel >
+void
+check(char const* filename)
+{
+    png::image< pixel > reference(filename,
+                                  png::convert_color_space< pixel >());
+    check(filename, reference, false);
+    check(filename, reference, true);
+}
+
+void
+check_view()
+{
+    png::gray_pixel pixels[6] = { 0, 1, 2, 3, 4, 5 };
+    png::pixel_buffer_view< png::gray_pixel > view(pixels, 3, 2);
+    if (view.get_pixel(2, 1) != 5 || view.get_stride() != 3)
+    {
+        throw png::error("packed view");
+    }
+    view.set_pixel(0, 1, 9);
+    if (pixels[3] != 9)
+    {
+        throw png::error("view does not alias the memory");
+    }
+    view.resize(2, 1);
+    try
+    {
+        view.get_pixel(2, 0);
+        throw png::error("get_pixel did not throw");
+    }
+    catch (std::out_of_range const&)
+    {
+    }
+    png::gray_pixel const short_row[1] = { 7 };
+    try
+    {
+        view.put_row(0, png::row_view< png::gray_pixel const >
+                     (short_row, 1));
+        throw png::error("put_row accepted a short row");
+    }
+    catch (std::out_of_range const&)
+    {
+    }
+    try
+    {
+        view.resize(4, 1);
+        throw png::error("resize beyond the capacity did not throw");
+    }
+    catch (png::error const& error)
+    {
+        if (std::strstr(error.what(), "does not fit") == 0)
+        {
+            throw;
+        }
+    }
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc < 2)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    check_view();
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        try
+        {
+            check< png::rgba_pixel >(filename);
+            check< png::rgb_pixel >(filename);
+            check< png::gray_pixel >(filename);
+            check< png::ga_pixel_16 >(filename);
+        }
+        catch (std::exception const& error)
+        {
+            std::cerr << filename << ": " << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "buffer_view: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
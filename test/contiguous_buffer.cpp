@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstring>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+/*
+ * Reads every image into a contiguous_pixel_buffer and checks it
+ * against the same image read into the default pixel_buffer, checks
+ * the row layout, that resize() keeps the overlapping pixels and
+ * that writing the buffer back round-trips.
+ */
+
+void
+print_usage()
+{
+    std::cerr << "usage: contiguous_buffer FILE..." << std::endl;
+}
+
+template< class first, class second >
+bool
+same_pixels(first const& a, second const& b)
+{
+    if (a.get_width() != b.get_width() || a.get_height() != b.get_height())
+    {
+        return false;
+    }
+    for (size_t y = 0; y < a.get_height(); ++y)
+    {
+        if (a.get_width() != 0
+            && std::memcmp(& a[y][0], & b[y][0],
+                           a.get_width() * sizeof(a[y][0])) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template< typename pixel >
+void
+check_layout(png::contiguous_pixel_buffer< pixel > const& buffer)
+{
+    size_t const stride = buffer.get_stride();
+    if (stride % 16 != 0 || stride < buffer.get_width() * sizeof(pixel))
+    {
+        throw png::error("bad stride");
+    }
+    for (size_t y = 0; y < buffer.get_height(); ++y)
+    {
+        if (reinterpret_cast< png::byte const* >(buffer[y].data())
+            != buffer.get_data() + y * stride
+            || buffer[y].size() != buffer.get_width())
+        {
+            throw png::error("rows are not contiguous");
+        }
+    }
+}
+
+template< typename pixel >
+void
+check(char const* filename)
+{
+    typedef png::contiguous_pixel_buffer< pixel > buffer;
+    png::image< pixel, buffer > image(filename,
+                                      png::convert_color_space< pixel >());
+    png::image< pixel > reference(filename,
+                                  png::convert_color_space< pixel >());
+    if (!same_pixels(image.get_pixbuf(), reference.get_pixbuf()))
+    {
+        throw png::error("pixel mismatch");
+    }
+    check_layout(image.get_pixbuf());
+
+    std::vector< png::byte > data;
+    png::memory_ostream out(data);
+    image.write_stream(out);
+    png::memory_istream in(& data[0], data.size());
+    png::image< pixel, buffer > copy;
+    copy.read_stream(in);
+    if (!same_pixels(copy.get_pixbuf(), image.get_pixbuf()))
+    {
+        throw png::error("round trip mismatch");
+    }
+
+    size_t const width = image.get_width();
+    size_t const height = image.get_height();
+    buffer resized = image.get_pixbuf();
+    resized.resize(width / 2 + 1, height + 3);
+    check_layout(resized);
+    png::pixel_buffer< pixel > expected = reference.get_pixbuf();
+    expected.resize(width / 2 + 1, height + 3);
+    if (!same_pixels(resized, expected))
+    {
+        throw png::error("resize lost pixels");
+    }
+    resized.resize(width + 5, height);
+    expected.resize(width + 5, height);
+    if (!same_pixels(resized, expected))
+    {
+        throw png::error("resize did not clear new pixels");
+    }
+}
+
+void
+check_row_view()
+{
+    png::contiguous_pixel_buffer< png::gray_pixel > buffer(3, 2);
+    png::contiguous_pixel_buffer< png::gray_pixel >::row_access row
+        = buffer.get_row(1);
+    for (size_t i = 0; i < row.size(); ++i)
+    {
+        row[i] = static_cast< png::gray_pixel >(i + 1);
+    }
+    if (buffer.get_pixel(2, 1) != 3 || row.front() != 1 || row.back() != 3)
+    {
+        throw png::error("row_view does not alias the buffer");
+    }
+    try
+    {
+        row.at(3);
+        throw png::error("row_view::at did not throw");
+    }
+    catch (std::out_of_range const&)
+    {
+    }
+    try
+    {
+        buffer.get_row(2);
+        throw png::error("get_row did not throw");
+    }
+    catch (std::out_of_range const&)
+    {
+    }
+    png::gray_pixel const short_row[2] = { 7, 8 };
+    try
+    {
+        buffer.put_row(0, png::row_view< png::gray_pixel const >
+                       (short_row, 2));
+        throw png::error("put_row accepted a short row");
+    }
+    catch (std::out_of_range const&)
+    {
+    }
+
+    // a zero width leaves no bytes to address rows in
+    buffer.resize(0, 4);
+    if (buffer.get_stride() != 0 || buffer.get_data() != 0
+        || !buffer[3].empty())
+    {
+        throw png::error("zero width buffer not empty");
+    }
+    buffer.resize(3, 2);
+    for (size_t y = 0; y < 2; ++y)
+    {
+        for (size_t x = 0; x < 3; ++x)
+        {
+            if (buffer.get_pixel(x, y) != 0)
+            {
+                throw png::error("resize from zero width kept pixels");
+            }
+        }
+    }
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc < 2)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    check_row_view();
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        try
+        {
+            check< png::rgba_pixel >(filename);
+            check< png::rgb_pixel >(filename);
+            check< png::gray_pixel >(filename);
+            check< png::ga_pixel_16 >(filename);
+        }
+        catch (std::exception const& error)
+        {
+            std::cerr << filename << ": " << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "contiguous_buffer: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -36,7 +36,7 @@
 void
 print_usage()
 {
-    std::cerr << "usage: convert_color_space RGB|RGBA|GRAY|GA 8|16 PB|PB2"
+    std::cerr << "usage: convert_color_space RGB|RGBA|GRAY|GA 8|16 PB|PB2|NB"
               << " INFILE OUTFILE" << std::endl;
 }
 
@@ -44,7 +44,12 @@ template< typename pixel >
 void
 convert_image(char const* buffer_type, char const *infile, char const* outfile)
 {
-    if (strcmp(buffer_type, "PB")) {
+    if (strcmp(buffer_type, "NB") == 0) {
+        png::image< pixel > image;
+        image.read(infile, png::native_decoding
+                   < png::convert_color_space< pixel > >());
+        image.write(outfile);
+    } else if (strcmp(buffer_type, "PB")) {
         png::image< pixel, png::pixel_buffer< pixel > > image(infile);
         image.write(outfile);
     } else {
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+/*
+ * Checks that png::probe() agrees with reader::read_info() on every
+ * file passed on the command line.
+ */
+
+void
+check(bool condition, char const* what, char const* filename)
+{
+    if (!condition)
+    {
+        throw std::runtime_error(std::string(filename) + ": " + what);
+    }
+}
+
+void
+compare(png::image_info const& probed, png::image_info const& info,
+        char const* filename)
+{
+    check(probed.get_width() == info.get_width(), "width", filename);
+    check(probed.get_height() == info.get_height(), "height", filename);
+    check(probed.get_bit_depth() == info.get_bit_depth(),
+          "bit depth", filename);
+    check(probed.get_color_type() == info.get_color_type(),
+          "color type", filename);
+    check(probed.get_interlace_type() == info.get_interlace_type(),
+          "interlace type", filename);
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open())
+        {
+            throw png::std_error(filename);
+        }
+        png::reader< std::istream > reader(file);
+        reader.read_info();
+        png::image_info const& info = reader.get_image_info();
+
+        file.clear();
+        file.seekg(0);
+        std::vector< char > data((std::istreambuf_iterator< char >(file)),
+                                 std::istreambuf_iterator< char >());
+
+        compare(png::probe(& data[0], data.size()), info, filename);
+
+        std::vector< std::string > chunks;
+        png::image_info probed = png::probe(& data[0], data.size(), chunks);
+        compare(probed, info, filename);
+        check(probed.get_palette().size() == info.get_palette().size(),
+              "palette", filename);
+        check(probed.get_tRNS() == info.get_tRNS(), "tRNS", filename);
+        check(chunks.front() == "IHDR" && chunks.back() == "IDAT",
+              "chunk list", filename);
+
+        int fd = open(filename, O_RDONLY);
+        if (fd == -1)
+        {
+            throw png::std_error(filename);
+        }
+        std::vector< std::string > fd_chunks;
+        probed = png::probe(fd, fd_chunks);
+        close(fd);
+        compare(probed, info, filename);
+        check(fd_chunks == chunks, "chunk list (fd)", filename);
+
+        // through a pipe, which cannot seek, chunks are skipped by
+        // reading; a huge declared chunk length must not be
+        // allocated but end in an error at the end of the data
+        for (int hostile = 0; hostile < 2; ++hostile)
+        {
+            std::vector< char > piped(data);
+            if (hostile)
+            {
+                // signature and IHDR, then a 2 GiB tEXt chunk
+                static char const text[8] =
+                    { 0x7f, char(0xff), char(0xff), char(0xff),
+                      't', 'E', 'X', 't' };
+                piped.resize(33);
+                piped.insert(piped.end(), text, text + 8);
+            }
+            int pipe_fds[2];
+            if (pipe(pipe_fds) == -1)
+            {
+                throw png::std_error("pipe");
+            }
+            // the pngsuite files fit in the pipe buffer
+            ssize_t const written
+                = write(pipe_fds[1], & piped[0], piped.size());
+            close(pipe_fds[1]);
+            check(written == ssize_t(piped.size()), "pipe write", filename);
+            std::vector< std::string > pipe_chunks;
+            // a 2 GiB buffer would exceed this address space limit
+            struct rlimit limit;
+            getrlimit(RLIMIT_AS, & limit);
+            struct rlimit const saved = limit;
+            limit.rlim_cur = rlim_t(1) << 30;
+            if (hostile && (saved.rlim_cur == RLIM_INFINITY
+                            || saved.rlim_cur > limit.rlim_cur))
+            {
+                setrlimit(RLIMIT_AS, & limit);
+            }
+            try
+            {
+                probed = png::probe(pipe_fds[0], pipe_chunks);
+                check(!hostile, "huge chunk not detected", filename);
+                compare(probed, info, filename);
+                check(pipe_chunks == chunks, "chunk list (pipe)", filename);
+            }
+            catch (png::error const&)
+            {
+                check(hostile, "pipe probe failed", filename);
+            }
+            setrlimit(RLIMIT_AS, & saved);
+            close(pipe_fds[0]);
+        }
+
+        try
+        {
+            png::probe(& data[0], 20);
+            check(false, "truncated data not detected", filename);
+        }
+        catch (png::error const&)
+        {
+        }
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "probe: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
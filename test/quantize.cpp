@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+/*
+ * Quantizes every image to 256 and to 16 colors, with and without
+ * dithering, and checks that images with few colors convert
+ * exactly, that the result is a valid %color-mapped image which
+ * survives a write and read, and that the quality stays reasonable.
+ */
+
+void
+print_usage()
+{
+    std::cerr << "usage: quantize FILE..." << std::endl;
+}
+
+typedef png::image< png::rgba_pixel > rgba_image;
+typedef png::image< png::index_pixel > index_image;
+
+double
+get_psnr(rgba_image const& src, index_image const& dst)
+{
+    png::palette const& plte = dst.get_palette();
+    png::tRNS const& trns = dst.get_tRNS();
+    double error = 0;
+    for (size_t y = 0; y < src.get_height(); ++y)
+    {
+        for (size_t x = 0; x < src.get_width(); ++x)
+        {
+            png::rgba_pixel const p = src.get_pixel(x, y);
+            size_t const i = dst.get_pixel(x, y);
+            if (i >= plte.size())
+            {
+                throw png::error("index out of palette");
+            }
+            int const a = i < trns.size() ? trns[i] : 255;
+            int const d[4] = { p.red - plte[i].red, p.green - plte[i].green,
+                               p.blue - plte[i].blue, p.alpha - a };
+            for (size_t k = 0; k < 4; ++k)
+            {
+                error += d[k] * d[k];
+            }
+        }
+    }
+    error /= 4.0 * src.get_width() * src.get_height();
+    return error == 0 ? 1000 : 10 * std::log10(255.0 * 255.0 / error);
+}
+
+size_t
+count_colors(rgba_image const& image)
+{
+    std::vector< unsigned > colors;
+    for (size_t y = 0; y < image.get_height(); ++y)
+    {
+        for (size_t x = 0; x < image.get_width(); ++x)
+        {
+            png::rgba_pixel const p = image.get_pixel(x, y);
+            colors.push_back(unsigned(p.red) << 24 | p.green << 16
+                             | p.blue << 8 | p.alpha);
+        }
+    }
+    std::sort(colors.begin(), colors.end());
+    return std::unique(colors.begin(), colors.end()) - colors.begin();
+}
+
+void
+check(char const* filename, size_t max_colors, bool dither)
+{
+    rgba_image src(filename, png::convert_color_space< png::rgba_pixel >());
+    png::quantizer quant;
+    quant.set_max_colors(max_colors);
+    quant.set_dither(dither);
+    quant.set_thread_count(2);
+    index_image dst;
+    quant.quantize(src, dst);
+    if (dst.get_width() != src.get_width()
+        || dst.get_height() != src.get_height()
+        || dst.get_palette().size() > max_colors
+        || dst.get_tRNS().size() > dst.get_palette().size())
+    {
+        throw png::error("bad quantized image");
+    }
+    double const psnr = get_psnr(src, dst);
+    if (count_colors(src) <= max_colors)
+    {
+        if (psnr < 1000)
+        {
+            throw png::error("few colors not converted exactly");
+        }
+    }
+    else if (psnr < (max_colors == 256 ? 28 : 15))
+    {
+        throw png::error("poor quality");
+    }
+
+    std::vector< png::byte > data;
+    png::memory_ostream out(data);
+    dst.write_stream(out);
+    png::memory_istream in(& data[0], data.size());
+    index_image copy;
+    copy.read_stream(in, png::require_color_space< png::index_pixel >());
+    if (get_psnr(src, copy) != psnr)
+    {
+        throw png::error("written image differs");
+    }
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc < 2)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        try
+        {
+            check(filename, 256, false);
+            check(filename, 256, true);
+            check(filename, 16, false);
+            check(filename, 16, true);
+        }
+        catch (std::exception const& error)
+        {
+            std::cerr << filename << ": " << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "quantize: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <iostream>
+#include <utility>
+#include <ostream>
+
+#include <png.hpp>
+
+typedef png::allocator< png::rgba_pixel > allocator;
+typedef png::image< png::rgba_pixel,
+                    png::pixel_buffer< png::rgba_pixel, allocator > > image;
+typedef png::image< png::rgba_pixel,
+                    png::solid_pixel_buffer< png::rgba_pixel, allocator > >
+    solid_image;
+typedef png::pixel_buffer< png::gray_pixel_1,
+                           png::allocator< png::gray_pixel_1 > > packed_buffer;
+
+#ifdef PNGPP_HAS_STD_MOVE
+/*
+ * Swapping and move-assigning buffers bound to different arenas
+ * must hand the allocator over along with the memory.
+ */
+void
+check_exchange(char const* infile)
+{
+    png::arena first(4096);
+    png::arena second(4096);
+    png::memory_resource::scope use_first(first);
+    solid_image a(infile);
+    png::memory_resource::scope use_second(second);
+    solid_image b(3, 2);
+    png::rgba_pixel const pixel = a.get_pixel(0, 0);
+
+    std::swap(a.get_pixbuf(), b.get_pixbuf());
+    if (b.get_pixbuf().get_bytes().get_allocator().get_resource() != & first
+        || a.get_pixbuf().get_bytes().get_allocator().get_resource()
+           != & second
+        || b.get_pixel(0, 0).alpha != pixel.alpha)
+    {
+        throw png::error("swap did not exchange the allocators");
+    }
+
+    a.get_pixbuf() = std::move(b.get_pixbuf());
+    if (a.get_pixbuf().get_bytes().get_allocator().get_resource() != & first
+        || a.get_pixel(0, 0).red != pixel.red)
+    {
+        throw png::error("move assignment did not take the allocator");
+    }
+}
+#endif
+
+void
+print_usage()
+{
+    std::cerr << "usage: read_arena INFILE OUTFILE" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc != 3)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    char const* infile = argv[1];
+    char const* outfile = argv[2];
+
+    png::arena arena(4096);
+    size_t capacity = 0;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        {
+            png::memory_resource::scope use_arena(arena);
+            image img(infile);
+            solid_image solid(infile);
+            if (img[0].get_allocator().get_resource() != & arena)
+            {
+                throw png::error("rows not allocated from the arena");
+            }
+            for (size_t y = 0; y < img.get_height(); ++y)
+            {
+                for (size_t x = 0; x < img.get_width(); ++x)
+                {
+                    png::rgba_pixel a = img.get_pixel(x, y);
+                    png::rgba_pixel b = solid.get_pixel(x, y);
+                    if (a.red != b.red || a.green != b.green
+                        || a.blue != b.blue || a.alpha != b.alpha)
+                    {
+                        throw png::error("solid buffer pixel mismatch");
+                    }
+                }
+            }
+
+            packed_buffer packed(img.get_width(), img.get_height());
+            packed.set_pixel(0, 0, 1);
+            if (packed.get_pixel(0, 0) != 1)
+            {
+                throw png::error("packed buffer pixel mismatch");
+            }
+
+            img.write(outfile);
+        }
+        if (pass == 0)
+        {
+            capacity = arena.get_capacity();
+        }
+        else if (arena.get_capacity() != capacity)
+        {
+            // the chunks were coalesced by reset(), nothing to add
+            throw png::error("arena grew on the second pass");
+        }
+        arena.reset();
+    }
+#ifdef PNGPP_HAS_STD_MOVE
+    check_exchange(infile);
+#endif
+    return EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    std::cerr << "read_arena: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fstream>
+#include <iostream>
+#include <ostream>
+
+#include <png.hpp>
+
+/*
+ * Checks downscale_consumer against a full decode followed by a box
+ * filter (or point sampling for index pixels).
+ */
+
+void
+print_usage()
+{
+    std::cerr << "usage: read_downscaled FILE..." << std::endl;
+}
+
+template< typename pixel >
+size_t
+get_sample(pixel const& p, size_t c)
+{
+    typedef typename png::pixel_traits< pixel >::component_type component;
+    return reinterpret_cast< component const* >(& p)[c];
+}
+
+template< size_t bits >
+size_t
+get_sample(png::packed_gray_pixel< bits > const& p, size_t)
+{
+    return png::byte(p);
+}
+
+template< typename pixel, class transformation >
+void
+check(char const* filename, size_t factor, transformation const& transform)
+{
+    typedef png::pixel_traits< pixel > traits;
+    png::image< pixel > full(filename, transform);
+
+    png::image_info info;
+    png::pixel_buffer< pixel > small;
+    std::ifstream stream(filename, std::ios::binary);
+    png::downscale_consumer< pixel > con(info, small, factor);
+    con.read(stream, transform);
+
+    size_t const width = full.get_width();
+    size_t const height = full.get_height();
+    if (small.get_width() != (width + factor - 1) / factor
+        || small.get_height() != (height + factor - 1) / factor)
+    {
+        throw png::error("downscaled size mismatch");
+    }
+    bool const palette = traits::get_color_type() == png::color_type_palette;
+    for (size_t oy = 0; oy < small.get_height(); ++oy)
+    {
+        for (size_t ox = 0; ox < small.get_width(); ++ox)
+        {
+            for (size_t c = 0; c < traits::channels; ++c)
+            {
+                size_t sum = 0;
+                size_t count = 0;
+                for (size_t y = oy * factor;
+                     y < height && y < (oy + 1) * factor; ++y)
+                {
+                    for (size_t x = ox * factor;
+                         x < width && x < (ox + 1) * factor; ++x)
+                    {
+                        sum += get_sample(pixel(full.get_pixel(x, y)), c);
+                        ++count;
+                    }
+                }
+                size_t expected = palette
+                    ? get_sample(pixel(full.get_pixel(ox * factor,
+                                                      oy * factor)), c)
+                    : (sum + count / 2) / count;
+                if (get_sample(pixel(small.get_pixel(ox, oy)), c)
+                    != expected)
+                {
+                    throw png::error("downscaled pixel mismatch");
+                }
+            }
+        }
+    }
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc < 2)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    size_t const factors[] = { 1, 2, 3, 8, 40 };
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        try
+        {
+            for (size_t f = 0; f < sizeof(factors) / sizeof(*factors); ++f)
+            {
+                check< png::rgba_pixel >
+                    (filename, factors[f],
+                     png::convert_color_space< png::rgba_pixel >());
+                check< png::rgba_pixel_16 >
+                    (filename, factors[f],
+                     png::convert_color_space< png::rgba_pixel_16 >());
+                check< png::ga_pixel >
+                    (filename, factors[f],
+                     png::convert_color_space< png::ga_pixel >());
+
+                std::ifstream stream(filename, std::ios::binary);
+                png::reader< std::istream > info(stream);
+                info.read_info();
+                if (info.get_color_type() == png::color_type_palette
+                    && info.get_bit_depth() == 8)
+                {
+                    check< png::index_pixel >
+                        (filename, factors[f],
+                         png::require_color_space< png::index_pixel >());
+                }
+                if (info.get_color_type() == png::color_type_gray
+                    && info.get_bit_depth() == 1)
+                {
+                    check< png::gray_pixel_1 >
+                        (filename, factors[f],
+                         png::require_color_space< png::gray_pixel_1 >());
+                }
+            }
+        }
+        catch (std::exception const& error)
+        {
+            std::cerr << filename << ": " << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "read_downscaled: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
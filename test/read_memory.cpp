@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+void
+print_usage()
+{
+    std::cerr << "usage: read_memory INFILE OUTFILE" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc != 3)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    char const* infile = argv[1];
+    char const* outfile = argv[2];
+
+    std::ifstream file(infile, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw png::std_error(infile);
+    }
+    std::vector< char > data((std::istreambuf_iterator< char >(file)),
+                             std::istreambuf_iterator< char >());
+
+    png::memory_istream stream(& data[0], data.size());
+    png::image< png::rgba_pixel > image;
+    image.read_stream(stream);
+    image.write(outfile);
+
+    // decoding in a memory_cache scope gives the same pixels, and
+    // the libpng memory retained after the first image is reused
+    png::memory_cache cache;
+    png::memory_cache::scope use_cache(cache);
+    size_t retained = 0;
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        png::memory_istream cached_stream(& data[0], data.size());
+        png::image< png::rgba_pixel > cached;
+        cached.read_stream(cached_stream);
+        for (size_t y = 0; y < image.get_height(); ++y)
+        {
+            if (std::memcmp(& cached[y][0], & image[y][0],
+                            image.get_width() * sizeof(png::rgba_pixel))
+                != 0)
+            {
+                std::cerr << "read_memory: cached decode differs"
+                          << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+#ifdef PNG_USER_MEM_SUPPORTED
+        if (cache.get_size() == 0
+            || (pass != 0 && cache.get_size() != retained))
+        {
+            std::cerr << "read_memory: memory_cache not reused"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+#endif
+        retained = cache.get_size();
+    }
+
+    // a truncated buffer must be reported as an error
+    png::memory_istream truncated(& data[0], data.size() / 2);
+    try
+    {
+        image.read_stream(truncated);
+    }
+    catch (png::error const&)
+    {
+        return EXIT_SUCCESS;
+    }
+    std::cerr << "read_memory: truncated data not detected" << std::endl;
+    return EXIT_FAILURE;
+}
+catch (std::exception const& error)
+{
+    std::cerr << "read_memory: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <iostream>
+#include <ostream>
+#include <string>
+
+#include <png.hpp>
+
+/*
+ * Built with PNGPP_USE_MMAP (see Makefile): image::read(filename)
+ * goes through mapped_file.  Also checks mapped_file directly and
+ * that a missing file is reported.
+ */
+
+#ifndef PNGPP_USE_MMAP
+#error read_mmap must be compiled with -DPNGPP_USE_MMAP
+#endif
+
+void
+print_usage()
+{
+    std::cerr << "usage: read_mmap INFILE OUTFILE" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc != 3)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    char const* infile = argv[1];
+    char const* outfile = argv[2];
+
+    png::image< png::rgba_pixel > image;
+    image.read(infile);
+    image.write(outfile);
+
+#ifdef PNGPP_HAS_MMAP
+    png::mapped_file file(infile);
+    png::memory_istream stream(file.get_data(), file.get_size());
+    png::image< png::rgba_pixel > mapped;
+    mapped.read_stream(stream);
+    if (mapped.get_width() != image.get_width()
+        || mapped.get_height() != image.get_height())
+    {
+        std::cerr << "read_mmap: mapped_file read differs" << std::endl;
+        return EXIT_FAILURE;
+    }
+#endif
+
+    // a missing file must be reported as an error
+    std::string const missing = std::string(outfile) + ".missing";
+    try
+    {
+        image.read(missing);
+    }
+    catch (png::std_error const&)
+    {
+        return EXIT_SUCCESS;
+    }
+    std::cerr << "read_mmap: missing file not detected" << std::endl;
+    return EXIT_FAILURE;
+}
+catch (std::exception const& error)
+{
+    std::cerr << "read_mmap: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
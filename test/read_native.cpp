@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <sys/resource.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include <png.hpp>
+
+/*
+ * Checks that native_decoding does not buffer huge ancillary chunks
+ * preceding the image data: a 9 MB tEXt chunk (above libpng's chunk
+ * limit) inserted after IHDR is skipped on either decoding path, and
+ * a truncated chunk declaring 2 GiB ends in png::error.
+ */
+
+typedef png::image< png::rgba_pixel > image_type;
+typedef png::native_decoding< png::convert_color_space< png::rgba_pixel > >
+    decoding;
+
+void
+check(bool condition, char const* what, char const* filename)
+{
+    if (!condition)
+    {
+        throw std::runtime_error(std::string(filename) + ": " + what);
+    }
+}
+
+void
+put_uint_32(std::string& data, png::uint_32 value)
+{
+    data += char(value >> 24);
+    data += char(value >> 16);
+    data += char(value >> 8);
+    data += char(value);
+}
+
+// the file with a tEXt chunk of the given length inserted after IHDR
+std::string
+insert_text(std::string const& data, png::uint_32 length, bool complete)
+{
+    std::string chunk;
+    put_uint_32(chunk, length);
+    chunk += "tEXt";
+    if (complete)
+    {
+        chunk += "Comment";
+        chunk.append(1, '\0');
+        chunk.append(length - 8, 'x');
+        uLong crc = crc32(crc32(0, Z_NULL, 0),
+                          reinterpret_cast< Bytef const* >(& chunk[4]),
+                          length + 4);
+        put_uint_32(chunk, png::uint_32(crc));
+    }
+    std::string result(data, 0, 33);
+    return result + chunk + (complete ? data.substr(33) : std::string());
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open())
+        {
+            throw png::std_error(filename);
+        }
+        std::string data((std::istreambuf_iterator< char >(file)),
+                         std::istreambuf_iterator< char >());
+
+        std::istringstream stream(data);
+        image_type image;
+        image.read(stream, decoding());
+
+        std::istringstream large(insert_text(data, 9000000, true));
+        image_type large_image;
+        large_image.read(large, decoding());
+        check(large_image.get_width() == image.get_width()
+              && large_image.get_height() == image.get_height(),
+              "size differs", filename);
+        for (size_t y = 0; y < image.get_height(); ++y)
+        {
+            check(std::memcmp(& large_image[y][0], & image[y][0],
+                              image.get_width()
+                              * sizeof(png::rgba_pixel)) == 0,
+                  "pixels differ", filename);
+        }
+
+        // a 2 GiB buffer would exceed this address space limit
+        std::istringstream hostile(insert_text(data, 0x7fffffff, false));
+        struct rlimit limit;
+        getrlimit(RLIMIT_AS, & limit);
+        struct rlimit const saved = limit;
+        limit.rlim_cur = rlim_t(1) << 30;
+        if (saved.rlim_cur == RLIM_INFINITY
+            || saved.rlim_cur > limit.rlim_cur)
+        {
+            setrlimit(RLIMIT_AS, & limit);
+        }
+        bool detected = false;
+        try
+        {
+            image_type hostile_image;
+            hostile_image.read(hostile, decoding());
+        }
+        catch (png::error const&)
+        {
+            detected = true;
+        }
+        setrlimit(RLIMIT_AS, & saved);
+        check(detected, "huge chunk not detected", filename);
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "read_native: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <iostream>
+#include <ostream>
+
+#include <png.hpp>
+
+typedef png::image< png::rgba_pixel > image;
+
+void
+print_usage()
+{
+    std::cerr << "usage: read_progressive FILE..." << std::endl;
+}
+
+bool
+same(png::rgba_pixel a, png::rgba_pixel b)
+{
+    return a.red == b.red && a.green == b.green
+        && a.blue == b.blue && a.alpha == b.alpha;
+}
+
+/*
+ * Checks every preview against the fully decoded image and stops
+ * after the pass \c stop_after.
+ */
+class preview_checker
+{
+public:
+    preview_checker(image const& full, bool interlaced, size_t stop_after)
+        : m_full(full),
+          m_interlaced(interlaced),
+          m_stop_after(stop_after),
+          m_calls(0)
+    {
+    }
+
+    bool operator()(image::preview const& preview) const
+    {
+        if (preview.get_pass() != m_calls)
+        {
+            throw png::error("pass out of order");
+        }
+        ++m_calls;
+        size_t const x_step = m_interlaced
+            ? png::adam7::get_known_x_step(preview.get_pass()) : 1;
+        size_t const y_step = m_interlaced
+            ? png::adam7::get_known_y_step(preview.get_pass()) : 1;
+        if (preview.get_width() != (m_full.get_width() + x_step - 1) / x_step
+            || preview.get_height()
+               != (m_full.get_height() + y_step - 1) / y_step)
+        {
+            throw png::error("preview size mismatch");
+        }
+        for (size_t y = 0; y < preview.get_height(); ++y)
+        {
+            for (size_t x = 0; x < preview.get_width(); ++x)
+            {
+                if (!same(preview.get_pixel(x, y),
+                          m_full.get_pixel(x * x_step, y * y_step)))
+                {
+                    throw png::error("preview pixel mismatch");
+                }
+            }
+        }
+        return preview.get_pass() < m_stop_after;
+    }
+
+    size_t get_calls() const
+    {
+        return m_calls;
+    }
+
+private:
+    image const& m_full;
+    bool m_interlaced;
+    size_t m_stop_after;
+    mutable size_t m_calls;
+};
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc < 2)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        try
+        {
+            image full(filename);
+            bool const interlaced
+                = full.get_interlace_type() != png::interlace_none;
+            size_t const passes = interlaced ? png::adam7::pass_count : 1;
+
+            preview_checker all(full, interlaced, passes);
+            image progressive;
+            progressive.read_progressive(filename, all);
+            if (all.get_calls() != passes)
+            {
+                throw png::error("wrong number of passes");
+            }
+
+            preview_checker first(full, interlaced, 0);
+            progressive.read_progressive(filename, first);
+            if (first.get_calls() != 1)
+            {
+                throw png::error("reading did not stop");
+            }
+
+            // temporaries bind to the const reference parameter
+            progressive.read_progressive(filename,
+                                         preview_checker(full, interlaced,
+                                                         passes));
+#ifdef PNGPP_HAS_STD_THREAD
+            size_t calls = 0;
+            progressive.read_progressive(filename,
+                                         [&calls](image::preview const&)
+                                         {
+                                             ++calls;
+                                             return true;
+                                         });
+            if (calls != passes)
+            {
+                throw png::error("lambda callback not called every pass");
+            }
+#endif
+        }
+        catch (std::exception const& error)
+        {
+            std::cerr << filename << ": " << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "read_progressive: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+typedef png::rgba_pixel pixel;
+typedef png::image< pixel > image_type;
+
+class pixel_consumer
+    : public png::push_consumer< pixel, pixel_consumer,
+                                 png::image_info_ref_holder, true >
+{
+public:
+    pixel_consumer(png::image_info& info, image_type::pixbuf& pixbuf)
+        : png::push_consumer< pixel, pixel_consumer,
+                              png::image_info_ref_holder, true >(info),
+          m_pixbuf(pixbuf)
+    {
+    }
+
+    void transform(png::io_base& io)
+    {
+        png::convert_color_space< pixel >()(io);
+    }
+
+    void reset(size_t pass)
+    {
+        if (pass == 0)
+        {
+            m_pixbuf.resize(get_info().get_width(), get_info().get_height());
+        }
+    }
+
+    png::byte* get_next_row(size_t pos)
+    {
+        return reinterpret_cast< png::byte* >(& m_pixbuf.get_row(pos)[0]);
+    }
+
+private:
+    image_type::pixbuf& m_pixbuf;
+};
+
+void
+print_usage()
+{
+    std::cerr << "usage: read_push INFILE OUTFILE" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc != 3)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    char const* infile = argv[1];
+    char const* outfile = argv[2];
+
+    std::ifstream file(infile, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw png::std_error(infile);
+    }
+    std::vector< char > data((std::istreambuf_iterator< char >(file)),
+                             std::istreambuf_iterator< char >());
+    png::byte const* bytes = reinterpret_cast< png::byte* >(& data[0]);
+
+    // feed the data in fragments of varying size
+    png::image_info info;
+    image_type::pixbuf pixbuf;
+    pixel_consumer pixcon(info, pixbuf);
+    size_t pos = 0;
+    for (size_t size = 1; pos < data.size(); size = size % 17 + 1)
+    {
+        if (size > data.size() - pos)
+        {
+            size = data.size() - pos;
+        }
+        pixcon.feed(bytes + pos, size);
+        pos += size;
+    }
+    if (!pixcon.is_done())
+    {
+        std::cerr << "read_push: end of image not reached" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    image_type image(pixbuf.get_width(), pixbuf.get_height());
+    image.set_interlace_type(info.get_interlace_type());
+    image.set_pixbuf(pixbuf);
+    image.write(outfile);
+}
+catch (std::exception const& error)
+{
+    std::cerr << "read_push: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
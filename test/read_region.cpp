@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+typedef png::image< png::rgba_pixel > image;
+
+void
+print_usage()
+{
+    std::cerr << "usage: read_region FILE..." << std::endl;
+}
+
+bool
+same(png::rgba_pixel a, png::rgba_pixel b)
+{
+    return a.red == b.red && a.green == b.green
+        && a.blue == b.blue && a.alpha == b.alpha;
+}
+
+void
+check_region(char const* filename, image const& full,
+             size_t x, size_t y, size_t width, size_t height)
+{
+    image region;
+    region.read_region(filename, x, y, width, height);
+    if (region.get_width() != width || region.get_height() != height)
+    {
+        throw png::error("region size mismatch");
+    }
+    for (size_t j = 0; j < height; ++j)
+    {
+        for (size_t i = 0; i < width; ++i)
+        {
+            if (!same(region.get_pixel(i, j), full.get_pixel(x + i, y + j)))
+            {
+                throw png::error("region pixel mismatch");
+            }
+        }
+    }
+}
+
+/*
+ * Reading a region at the top must not need the rest of the data.
+ */
+void
+check_early_stop()
+{
+    png::image< png::rgb_pixel > source(256, 1024);
+    for (size_t y = 0; y < source.get_height(); ++y)
+    {
+        for (size_t x = 0; x < source.get_width(); ++x)
+        {
+            unsigned v = (x * 7919 + y * 104729) * 2654435761u;
+            source.set_pixel(x, y, png::rgb_pixel(v >> 24, v >> 16, v >> 8));
+        }
+    }
+    std::vector< png::byte > data;
+    png::memory_ostream out(data);
+    source.write_stream(out);
+
+    png::memory_istream truncated(& data[0], data.size() / 3);
+    png::image< png::rgb_pixel > region;
+    region.read_region_stream(truncated, 10, 0, 100, 16);
+    for (size_t y = 0; y < 16; ++y)
+    {
+        for (size_t x = 0; x < 100; ++x)
+        {
+            if (region[y][x].red != source[y][x + 10].red)
+            {
+                throw png::error("early stop: region pixel mismatch");
+            }
+        }
+    }
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc < 2)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        image full(filename);
+        size_t const w = full.get_width();
+        size_t const h = full.get_height();
+        try
+        {
+            check_region(filename, full, 0, 0, w, h);
+            check_region(filename, full, 0, h / 3, w, h / 2);
+            check_region(filename, full, w / 4, h / 4, w / 2, h / 2);
+            check_region(filename, full, w - 1, h - 1, 1, 1);
+        }
+        catch (std::exception const& error)
+        {
+            std::cerr << filename << ": " << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    check_early_stop();
+
+    try
+    {
+        image region;
+        region.read_region(argv[1], 1, 0, 1 << 30, 1);
+    }
+    catch (std::out_of_range const&)
+    {
+        return EXIT_SUCCESS;
+    }
+    std::cerr << "read_region: region out of bounds not detected"
+              << std::endl;
+    return EXIT_FAILURE;
+}
+catch (std::exception const& error)
+{
+    std::cerr << "read_region: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
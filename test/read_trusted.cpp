@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+typedef png::image< png::rgba_pixel > image;
+typedef png::trusted_input< png::convert_color_space< png::rgba_pixel > >
+    trusted;
+
+void
+print_usage()
+{
+    std::cerr << "usage: read_trusted INFILE OUTFILE" << std::endl;
+}
+
+/*
+ * Flips a bit in the CRC of the first IDAT chunk.
+ */
+void
+corrupt_idat_crc(std::vector< char >& data)
+{
+    size_t pos = 8;
+    while (pos + 12 <= data.size())
+    {
+        size_t length = (png::byte(data[pos]) << 24)
+            | (png::byte(data[pos + 1]) << 16)
+            | (png::byte(data[pos + 2]) << 8)
+            | png::byte(data[pos + 3]);
+        if (std::string(& data[pos + 4], 4) == "IDAT")
+        {
+            data[pos + 8 + length] ^= 1;
+            return;
+        }
+        pos += 12 + length;
+    }
+    throw png::error("no IDAT chunk");
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc != 3)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    char const* infile = argv[1];
+    char const* outfile = argv[2];
+
+    image img;
+    img.read(infile, trusted());
+    img.write(outfile);
+
+    std::ifstream file(infile, std::ios::binary);
+    std::vector< char > data((std::istreambuf_iterator< char >(file)),
+                             std::istreambuf_iterator< char >());
+    corrupt_idat_crc(data);
+
+    // a broken CRC passes unnoticed in trusted mode only
+    image corrupted;
+    png::memory_istream trusted_stream(& data[0], data.size());
+    corrupted.read_stream(trusted_stream, trusted());
+    for (size_t y = 0; y < img.get_height(); ++y)
+    {
+        for (size_t x = 0; x < img.get_width(); ++x)
+        {
+            png::rgba_pixel a = img.get_pixel(x, y);
+            png::rgba_pixel b = corrupted.get_pixel(x, y);
+            if (a.red != b.red || a.green != b.green
+                || a.blue != b.blue || a.alpha != b.alpha)
+            {
+                throw png::error("pixel mismatch");
+            }
+        }
+    }
+
+    png::memory_istream checked_stream(& data[0], data.size());
+    try
+    {
+        corrupted.read_stream(checked_stream);
+    }
+    catch (png::error const&)
+    {
+        return EXIT_SUCCESS;
+    }
+    std::cerr << "read_trusted: CRC error not detected" << std::endl;
+    return EXIT_FAILURE;
+}
+catch (std::exception const& error)
+{
+    std::cerr << "read_trusted: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
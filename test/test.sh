@@ -18,7 +18,7 @@ run() {
 for i in pngsuite/*.png; do
     for j in RGB RGBA GRAY GA; do
 	for k in 8 16; do
-    for p in PB PB2; do
+    for p in PB PB2 NB; do
 	    out=$i.$j.$k.out
 	    run "./convert_color_space $j $k $p $i $out && cmp $out cmp/$out"
 	done;
@@ -26,6 +26,38 @@ for i in pngsuite/*.png; do
     done;
 done
 
+for i in pngsuite/*.png; do
+    out=$i.RGBA.8.mem.out
+    run "./read_memory $i $out && cmp $out cmp/$i.RGBA.8.out"
+    out=$i.RGBA.8.mmap.out
+    run "./read_mmap $i $out && cmp $out cmp/$i.RGBA.8.out"
+    out=$i.RGBA.8.memw.out
+    run "./write_memory $i $out && cmp $out cmp/$i.RGBA.8.out"
+    out=$i.RGBA.8.push.out
+    run "./read_push $i $out && cmp $out cmp/$i.RGBA.8.out"
+    out=$i.RGBA.8.arena.out
+    run "./read_arena $i $out && cmp $out cmp/$i.RGBA.8.out"
+    out=$i.RGBA.8.trusted.out
+    run "./read_trusted $i $out && cmp $out cmp/$i.RGBA.8.out"
+done
+
+run ./write_buffer_size
+run ./probe pngsuite/*.png
+run ./read_native pngsuite/*.png
+run ./read_region pngsuite/*.png
+run ./read_downscaled pngsuite/*.png
+run ./read_progressive pngsuite/*.png
+run ./batch_decode pngsuite/*.png
+run ./write_fast pngsuite/*.png
+run ./write_profile pngsuite/*.png
+run ./write_parallel pngsuite/*.png
+run ./write_optimized pngsuite/*.png
+run ./write_reduced pngsuite/*.png
+run ./quantize pngsuite/*.png
+run ./contiguous_buffer pngsuite/*.png
+run ./aligned_buffer pngsuite/*.png
+run ./buffer_view pngsuite/*.png
+
 for i in 1 2 4; do
     in=pngsuite/basn0g0$i.png
     out=$in.out
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <iostream>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#include <png.hpp>
+
+/*
+ * Writes images whose pixel buffer was made smaller than the image
+ * info after construction and checks that every write method throws
+ * std::out_of_range instead of reading past the buffer.
+ */
+
+template< class image_type, class write_function >
+void
+check(char const* name, size_t width, size_t height,
+      write_function write)
+{
+    image_type image(64, 4000);
+    image.get_pixbuf().resize(width, height);
+    std::vector< png::byte > data;
+    png::memory_ostream out(data);
+    try
+    {
+        write(image, out);
+    }
+    catch (std::out_of_range const&)
+    {
+        return;
+    }
+    throw png::error(std::string(name) + ": smaller pixel buffer accepted");
+}
+
+template< class image_type >
+struct write_stream
+{
+    void operator()(image_type& image, png::memory_ostream& out) const
+    {
+        image.write_stream(out);
+    }
+};
+
+template< class image_type >
+struct write_fast_stream
+{
+    void operator()(image_type& image, png::memory_ostream& out) const
+    {
+        image.write_fast_stream(out);
+    }
+};
+
+template< class image_type >
+struct write_reduced_stream
+{
+    void operator()(image_type& image, png::memory_ostream& out) const
+    {
+        image.write_reduced_stream(out);
+    }
+};
+
+#ifdef PNGPP_HAS_STD_THREAD
+template< class image_type >
+struct write_parallel_stream
+{
+    void operator()(image_type& image, png::memory_ostream& out) const
+    {
+        image.write_parallel_stream(out, 2);
+    }
+};
+
+template< class image_type >
+struct write_optimized_stream
+{
+    void operator()(image_type& image, png::memory_ostream& out) const
+    {
+        png::optimize_options options;
+        options.set_candidates(std::vector< png::compression_profile >(2));
+        image.write_optimized_stream(out, options);
+    }
+};
+#endif
+
+template< class image_type >
+void
+check(size_t width, size_t height)
+{
+    check< image_type >("write_stream", width, height,
+                        write_stream< image_type >());
+    check< image_type >("write_fast_stream", width, height,
+                        write_fast_stream< image_type >());
+    check< image_type >("write_reduced_stream", width, height,
+                        write_reduced_stream< image_type >());
+#ifdef PNGPP_HAS_STD_THREAD
+    check< image_type >("write_parallel_stream", width, height,
+                        write_parallel_stream< image_type >());
+    check< image_type >("write_optimized_stream", width, height,
+                        write_optimized_stream< image_type >());
+#endif
+}
+
+template< class image_type >
+void
+check()
+{
+    check< image_type >(64, 3);
+    check< image_type >(63, 4000);
+    check< image_type >(0, 0);
+}
+
+int
+main()
+try
+{
+    check< png::image< png::rgb_pixel > >();
+    check< png::image< png::rgb_pixel,
+                       png::solid_pixel_buffer< png::rgb_pixel > > >();
+}
+catch (std::exception const& error)
+{
+    std::cerr << "write_buffer_size: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+/*
+ * Writes every image with image::write_fast() using each filter
+ * method and each adaptive filter strategy and checks that libpng
+ * reads back the same pixels.
+ */
+
+void
+print_usage()
+{
+    std::cerr << "usage: write_fast FILE..." << std::endl;
+}
+
+template< typename pixel, class transformation >
+void
+check(char const* filename, transformation const& transform)
+{
+    typedef png::solid_pixel_buffer< pixel > buffer;
+    png::image< pixel, buffer > image(filename, transform);
+    std::vector< png::filter_strategy > strategies;
+    for (int filter = PNG_FILTER_VALUE_NONE;
+         filter <= PNG_FILTER_VALUE_PAETH; ++filter)
+    {
+        strategies.push_back(png::filter_strategy::fixed(filter));
+    }
+    strategies.push_back(png::filter_strategy::min_sum());
+    strategies.push_back(png::filter_strategy::min_sum(PNG_FILTER_SUB
+                                                       | PNG_FILTER_PAETH));
+    strategies.push_back(png::filter_strategy::entropy());
+    strategies.push_back(png::filter_strategy::reuse_previous());
+    for (size_t s = 0; s < strategies.size(); ++s)
+    {
+        std::vector< png::byte > data;
+        png::memory_ostream out(data);
+        image.write_fast_stream(out, strategies[s]);
+
+        png::memory_istream in(& data[0], data.size());
+        png::image< pixel, buffer > copy;
+        copy.read_stream(in, png::require_color_space< pixel >());
+        bool const palette = png::pixel_traits< pixel >::get_color_type()
+            == png::color_type_palette;
+        if (copy.get_width() != image.get_width()
+            || copy.get_height() != image.get_height()
+            || (palette && (copy.get_palette().size()
+                            != image.get_palette().size()
+                            || copy.get_tRNS() != image.get_tRNS())))
+        {
+            throw png::error("image info mismatch");
+        }
+        if (copy.get_pixbuf().get_bytes() != image.get_pixbuf().get_bytes())
+        {
+            throw png::error("pixel mismatch");
+        }
+    }
+}
+
+/*
+ * Filter types outside None..Paeth must be rejected rather than
+ * written into the filter type bytes; valid ones may be passed to
+ * write_fast_stream() directly.
+ */
+void
+check_filter_values()
+{
+    png::image< png::rgb_pixel > image(8, 8);
+    int const invalid[] = { -1, 5, 7 };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(*invalid); ++i)
+    {
+        std::vector< png::byte > data;
+        png::memory_ostream out(data);
+        try
+        {
+            image.write_fast_stream(out, invalid[i]);
+        }
+        catch (png::error const&)
+        {
+            try
+            {
+                png::filter_strategy::fixed(invalid[i]);
+            }
+            catch (png::error const&)
+            {
+                continue;
+            }
+        }
+        throw png::error("invalid filter type accepted");
+    }
+
+    std::vector< png::byte > by_value;
+    png::memory_ostream value_out(by_value);
+    image.write_fast_stream(value_out, PNG_FILTER_VALUE_PAETH);
+    std::vector< png::byte > by_strategy;
+    png::memory_ostream strategy_out(by_strategy);
+    image.write_fast_stream(strategy_out, png::filter_strategy::fixed
+                            (PNG_FILTER_VALUE_PAETH));
+    if (by_value != by_strategy)
+    {
+        throw png::error("filter value and fixed strategy differ");
+    }
+}
+
+/*
+ * The minimum-sum cost of a row must not wrap around at 2^31 in the
+ * SIMD lanes, which each sum half of a 32 MB row of -128 bytes.
+ */
+void
+check_sum_abs()
+{
+    size_t const size = (size_t(1) << 25) + 4096 + 7;
+    std::vector< png::byte > row(size, 0x80);
+    if (png::detail::sum_abs_signed(& row[0], size) != 128 * size)
+    {
+        throw png::error("minimum-sum cost overflow");
+    }
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc < 2)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    check_filter_values();
+    check_sum_abs();
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        try
+        {
+            check< png::rgba_pixel >
+                (filename, png::convert_color_space< png::rgba_pixel >());
+            check< png::rgb_pixel >
+                (filename, png::convert_color_space< png::rgb_pixel >());
+            check< png::ga_pixel >
+                (filename, png::convert_color_space< png::ga_pixel >());
+            check< png::gray_pixel >
+                (filename, png::convert_color_space< png::gray_pixel >());
+            check< png::rgba_pixel_16 >
+                (filename, png::convert_color_space< png::rgba_pixel_16 >());
+            check< png::gray_pixel_16 >
+                (filename, png::convert_color_space< png::gray_pixel_16 >());
+
+            std::ifstream stream(filename, std::ios::binary);
+            png::reader< std::istream > info(stream);
+            info.read_info();
+            if (info.get_color_type() == png::color_type_palette
+                && info.get_bit_depth() == 8)
+            {
+                check< png::index_pixel >
+                    (filename, png::require_color_space< png::index_pixel >());
+            }
+        }
+        catch (std::exception const& error)
+        {
+            std::cerr << filename << ": " << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "write_fast: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+void
+print_usage()
+{
+    std::cerr << "usage: write_memory INFILE OUTFILE" << std::endl;
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc != 3)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    char const* infile = argv[1];
+    char const* outfile = argv[2];
+
+    png::image< png::rgba_pixel > image(infile);
+    std::vector< png::byte > buffer;
+    png::memory_ostream stream(buffer);
+    image.write_stream(stream);
+
+    std::ofstream file(outfile, std::ios::binary);
+    file.write(reinterpret_cast< char const* >(& buffer[0]), buffer.size());
+
+    // a fixed buffer with room to spare receives the same bytes
+    std::vector< png::byte > large(buffer.size() + 16, 0xa5);
+    png::memory_ostream spare(& large[0], large.size());
+    image.write_stream(spare);
+    if (!spare.good() || spare.get_size() != buffer.size()
+        || !std::equal(buffer.begin(), buffer.end(), large.begin())
+        || std::count(large.begin() + buffer.size(), large.end(), 0xa5)
+           != 16)
+    {
+        std::cerr << "write_memory: fixed buffer write differs" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // so does one of exactly the encoded size
+    std::vector< png::byte > exact(buffer.size());
+    png::memory_ostream full(& exact[0], exact.size());
+    image.write_stream(full);
+    if (!full.good() || full.get_size() != buffer.size() || exact != buffer)
+    {
+        std::cerr << "write_memory: exact buffer write differs" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // a fixed buffer which is too small must be reported as an error
+    std::vector< png::byte > small(buffer.size() - 1);
+    png::memory_ostream fixed(& small[0], small.size());
+    try
+    {
+        image.write_stream(fixed);
+    }
+    catch (png::error const&)
+    {
+        return EXIT_SUCCESS;
+    }
+    std::cerr << "write_memory: buffer overflow not detected" << std::endl;
+    return EXIT_FAILURE;
+}
+catch (std::exception const& error)
+{
+    std::cerr << "write_memory: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+/*
+ * Writes every image with image::write_optimized() on two threads
+ * and checks that the result is the smallest of the candidate
+ * encodings, that write() with the reported profile reproduces it
+ * and that libpng reads back the same pixels.
+ */
+
+void
+print_usage()
+{
+    std::cerr << "usage: write_optimized FILE..." << std::endl;
+}
+
+template< typename pixel, class transformation >
+void
+check(char const* filename, transformation const& transform)
+{
+    typedef png::image< pixel, png::solid_pixel_buffer< pixel > > image_type;
+    image_type image(filename, transform);
+
+    png::optimize_options options;
+    options.set_thread_count(2);
+    std::vector< png::byte > data;
+    png::memory_ostream out(data);
+    png::optimize_report report = image.write_optimized_stream(out, options);
+    if (report.size != data.size()
+        || report.trials != options.get_candidates().size()
+        || report.skipped != 0)
+    {
+        throw png::error("report mismatch");
+    }
+
+    std::vector< png::compression_profile > const& candidates
+        = options.get_candidates();
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        std::vector< png::byte > trial;
+        png::memory_ostream trial_out(trial);
+        image.write_stream(trial_out, candidates[i]);
+        if (trial.size() < data.size())
+        {
+            throw png::error("not the smallest encoding");
+        }
+    }
+
+    std::vector< png::byte > again;
+    png::memory_ostream again_out(again);
+    image.write_stream(again_out, report.profile);
+    if (again != data)
+    {
+        throw png::error("reported profile does not reproduce the output");
+    }
+
+    png::memory_istream in(& data[0], data.size());
+    image_type copy;
+    copy.read_stream(in, png::require_color_space< pixel >());
+    if (copy.get_pixbuf().get_bytes() != image.get_pixbuf().get_bytes())
+    {
+        throw png::error("pixel mismatch");
+    }
+
+    // a spent budget still encodes the first candidate
+    options.set_thread_count(1);
+    options.set_time_budget(1);
+    data.clear();
+    report = image.write_optimized_stream(out, options);
+    if (report.trials == 0
+        || report.trials + report.skipped != candidates.size())
+    {
+        throw png::error("time budget report mismatch");
+    }
+
+    // a fixed buffer too small for the result must be reported
+    std::vector< png::byte > small(data.size() / 2);
+    png::memory_ostream fixed(& small[0], small.size());
+    try
+    {
+        image.write_optimized_stream(fixed, options);
+    }
+    catch (png::error const&)
+    {
+        return;
+    }
+    throw png::error("failed write not detected");
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc < 2)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        try
+        {
+            check< png::rgba_pixel >
+                (filename, png::convert_color_space< png::rgba_pixel >());
+            check< png::gray_pixel >
+                (filename, png::convert_color_space< png::gray_pixel >());
+        }
+        catch (std::exception const& error)
+        {
+            std::cerr << filename << ": " << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "write_optimized: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+/*
+ * Writes every image with generator::write_parallel() on 1, 2 and 4
+ * threads using strips of a few rows, checks that the output does
+ * not depend on the thread count and that libpng reads back the
+ * same pixels.
+ */
+
+void
+print_usage()
+{
+    std::cerr << "usage: write_parallel FILE..." << std::endl;
+}
+
+template< typename pixel >
+class buffer_generator
+    : public png::generator< pixel, buffer_generator< pixel > >
+{
+public:
+    typedef png::solid_pixel_buffer< pixel > buffer;
+    typedef png::generator< pixel, buffer_generator > base;
+
+    buffer_generator(png::image< pixel, buffer >& image)
+        : base(image.get_width(), image.get_height()),
+          m_pixbuf(image.get_pixbuf())
+    {
+        this->get_info().set_palette(image.get_palette());
+        this->get_info().set_tRNS(image.get_tRNS());
+    }
+
+    png::byte* get_next_row(size_t pos)
+    {
+        typedef typename buffer::row_traits row_traits;
+        return reinterpret_cast< png::byte* >
+            (row_traits::get_data(m_pixbuf.get_row(pos)));
+    }
+
+private:
+    buffer& m_pixbuf;
+};
+
+template< typename pixel, class transformation >
+void
+check(char const* filename, transformation const& transform)
+{
+    typedef png::solid_pixel_buffer< pixel > buffer;
+    png::image< pixel, buffer > image(filename, transform);
+
+    std::vector< png::byte > first;
+    for (size_t threads = 1; threads <= 4; threads *= 2)
+    {
+        png::thread_pool pool(threads);
+        png::compression_profile profile;
+        std::vector< png::byte > data;
+        png::memory_ostream out(data);
+        buffer_generator< pixel > gen(image);
+        gen.write_parallel(out, pool, profile, 300);
+        if (threads == 1)
+        {
+            first = data;
+        }
+        else if (data != first)
+        {
+            throw png::error("output depends on the thread count");
+        }
+    }
+
+    png::memory_istream in(& first[0], first.size());
+    png::image< pixel, buffer > copy;
+    copy.read_stream(in, png::require_color_space< pixel >());
+    if (copy.get_width() != image.get_width()
+        || copy.get_height() != image.get_height())
+    {
+        throw png::error("image info mismatch");
+    }
+    if (copy.get_pixbuf().get_bytes() != image.get_pixbuf().get_bytes())
+    {
+        throw png::error("pixel mismatch");
+    }
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc < 2)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        try
+        {
+            check< png::rgba_pixel >
+                (filename, png::convert_color_space< png::rgba_pixel >());
+            check< png::rgb_pixel >
+                (filename, png::convert_color_space< png::rgb_pixel >());
+            check< png::gray_pixel >
+                (filename, png::convert_color_space< png::gray_pixel >());
+            check< png::rgba_pixel_16 >
+                (filename, png::convert_color_space< png::rgba_pixel_16 >());
+
+            std::ifstream stream(filename, std::ios::binary);
+            png::reader< std::istream > info(stream);
+            info.read_info();
+            if (info.get_color_type() == png::color_type_palette
+                && info.get_bit_depth() == 8)
+            {
+                check< png::index_pixel >
+                    (filename, png::require_color_space< png::index_pixel >());
+            }
+        }
+        catch (std::exception const& error)
+        {
+            std::cerr << filename << ": " << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "write_parallel: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+/*
+ * Writes every image with each compression_profile preset and a
+ * custom profile and checks that the same pixels are read back.
+ */
+
+void
+print_usage()
+{
+    std::cerr << "usage: write_profile FILE..." << std::endl;
+}
+
+typedef png::rgba_pixel pixel;
+typedef png::image< pixel, png::solid_pixel_buffer< pixel > > image_type;
+
+void
+check(image_type& image, png::compression_profile const& profile)
+{
+    std::vector< png::byte > data;
+    png::memory_ostream out(data);
+    image.write_stream(out, profile);
+
+    png::memory_istream in(& data[0], data.size());
+    image_type copy;
+    copy.read_stream(in);
+    if (copy.get_pixbuf().get_bytes() != image.get_pixbuf().get_bytes())
+    {
+        throw png::error("pixel mismatch");
+    }
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc < 2)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    png::compression_profile custom;
+    custom.set_level(0);
+    custom.set_strategy(png::strategy_huffman_only);
+    custom.set_window_bits(9);
+    custom.set_mem_level(1);
+    custom.set_filters(PNG_FILTER_AVG);
+    custom.set_buffer_size(100);
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        try
+        {
+            image_type image(filename);
+            check(image, png::compression_profile::fastest());
+            check(image, png::compression_profile::balanced());
+            check(image, png::compression_profile::smallest());
+            check(image, custom);
+        }
+        catch (std::exception const& error)
+        {
+            std::cerr << filename << ": " << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "write_profile: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
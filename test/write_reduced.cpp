@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+#include <png.hpp>
+
+/*
+ * Writes every image with image::write_reduced() and checks that
+ * libpng reads back the same pixels and that the written format
+ * never takes more bits per pixel than the pixel type.  Two
+ * synthetic images check the chosen formats.
+ *
+ * 16-bit samples of the form v * 257 are written as 8-bit v, which
+ * is exact by the PNG specification, but convert_color_space reads
+ * 8-bit samples into 16-bit pixels as v << 8; the comparison allows
+ * for that.  Images below 8 bits per sample are read into packed
+ * pixels and must be written unchanged.
+ */
+
+void
+print_usage()
+{
+    std::cerr << "usage: write_reduced FILE..." << std::endl;
+}
+
+size_t
+get_pixel_bits(png::image_info const& info)
+{
+    return png::detail::get_color_channels(info.get_color_type())
+        * info.get_bit_depth();
+}
+
+template< typename pixel >
+png::image_info
+check(png::image< pixel, png::solid_pixel_buffer< pixel > >& image)
+{
+    std::vector< png::byte > data;
+    png::memory_ostream out(data);
+    png::image_info const info = image.write_reduced_stream(out);
+    if (get_pixel_bits(info) > png::pixel_traits< pixel >::get_bit_depth()
+        * png::pixel_traits< pixel >::get_channels())
+    {
+        throw png::error("reduced format is larger");
+    }
+
+    std::vector< png::byte > expected = image.get_pixbuf().get_bytes();
+    if (png::pixel_traits< pixel >::get_bit_depth() == 16
+        && info.get_bit_depth() < 16)
+    {
+        for (size_t i = 0; i < expected.size(); i += 2)
+        {
+            png::uint_16 v;
+            std::memcpy(& v, & expected[i], 2);
+            v &= 0xff00;
+            std::memcpy(& expected[i], & v, 2);
+        }
+    }
+
+    png::memory_istream in(& data[0], data.size());
+    png::image< pixel, png::solid_pixel_buffer< pixel > > copy;
+    copy.read_stream(in, png::convert_color_space< pixel >());
+    if (copy.get_width() != image.get_width()
+        || copy.get_height() != image.get_height()
+        || copy.get_pixbuf().get_bytes() != expected)
+    {
+        throw png::error("pixel mismatch");
+    }
+    return info;
+}
+
+template< typename pixel, class transformation >
+void
+check(char const* filename, transformation const& transform)
+{
+    png::image< pixel, png::solid_pixel_buffer< pixel > >
+        image(filename, transform);
+    check(image);
+}
+
+template< typename pixel >
+void
+check_packed(char const* filename)
+{
+    png::image< pixel > image(filename, png::require_color_space< pixel >());
+    std::vector< png::byte > data;
+    png::memory_ostream out(data);
+    png::image_info const info = image.write_reduced_stream(out);
+    if (info.get_color_type() != png::pixel_traits< pixel >::get_color_type()
+        || info.get_bit_depth() != png::pixel_traits< pixel >::get_bit_depth())
+    {
+        throw png::error("packed format changed");
+    }
+
+    png::memory_istream in(& data[0], data.size());
+    png::image< pixel > copy;
+    copy.read_stream(in, png::require_color_space< pixel >());
+    if (copy.get_width() != image.get_width()
+        || copy.get_height() != image.get_height()
+        || copy.get_palette().size() != image.get_palette().size())
+    {
+        throw png::error("packed image info mismatch");
+    }
+    for (size_t y = 0; y < image.get_height(); ++y)
+    {
+        for (size_t x = 0; x < image.get_width(); ++x)
+        {
+            if (copy.get_pixel(x, y) != image.get_pixel(x, y))
+            {
+                throw png::error("packed pixel mismatch");
+            }
+        }
+    }
+}
+
+void
+check_packed(char const* filename)
+{
+    std::ifstream stream(filename, std::ios::binary);
+    png::reader< std::istream > reader(stream);
+    reader.read_info();
+    png::color_type const type = reader.get_color_type();
+    switch (type == png::color_type_gray || type == png::color_type_palette
+            ? reader.get_bit_depth() : 8)
+    {
+    case 1:
+        type == png::color_type_gray
+            ? check_packed< png::gray_pixel_1 >(filename)
+            : check_packed< png::index_pixel_1 >(filename);
+        break;
+    case 2:
+        type == png::color_type_gray
+            ? check_packed< png::gray_pixel_2 >(filename)
+            : check_packed< png::index_pixel_2 >(filename);
+        break;
+    case 4:
+        type == png::color_type_gray
+            ? check_packed< png::gray_pixel_4 >(filename)
+            : check_packed< png::index_pixel_4 >(filename);
+        break;
+    }
+}
+
+void
+check_synthetic()
+{
+    png::image< png::rgba_pixel, png::solid_pixel_buffer< png::rgba_pixel > >
+        image(16, 16);
+    for (size_t y = 0; y < 16; ++y)
+    {
+        for (size_t x = 0; x < 16; ++x)
+        {
+            png::byte const v = (x + y) % 2 ? 255 : 0;
+            image.set_pixel(x, y, png::rgba_pixel(v, v, v, 255));
+        }
+    }
+    png::image_info info = check(image);
+    if (info.get_color_type() != png::color_type_gray
+        || info.get_bit_depth() != 1)
+    {
+        throw png::error("two gray levels not reduced to 1-bit gray");
+    }
+
+    image.set_pixel(0, 0, png::rgba_pixel(255, 0, 0, 255));
+    image.set_pixel(1, 0, png::rgba_pixel(0, 0, 255, 128));
+    info = check(image);
+    if (info.get_color_type() != png::color_type_palette
+        || info.get_bit_depth() != 2
+        || info.get_palette().size() != 4
+        || info.get_tRNS().size() != 1)
+    {
+        throw png::error("four colors not reduced to a 2-bit palette");
+    }
+}
+
+int
+main(int argc, char* argv[])
+try
+{
+    if (argc < 2)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    check_synthetic();
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* filename = argv[i];
+        try
+        {
+            check< png::rgba_pixel >
+                (filename, png::convert_color_space< png::rgba_pixel >());
+            check< png::rgb_pixel >
+                (filename, png::convert_color_space< png::rgb_pixel >());
+            check< png::ga_pixel >
+                (filename, png::convert_color_space< png::ga_pixel >());
+            check< png::gray_pixel >
+                (filename, png::convert_color_space< png::gray_pixel >());
+            check< png::rgba_pixel_16 >
+                (filename, png::convert_color_space< png::rgba_pixel_16 >());
+            check< png::gray_pixel_16 >
+                (filename, png::convert_color_space< png::gray_pixel_16 >());
+            check_packed(filename);
+        }
+        catch (std::exception const& error)
+        {
+            std::cerr << filename << ": " << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+}
+catch (std::exception const& error)
+{
+    std::cerr << "write_reduced: " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_THREAD_POOL_HPP_INCLUDED
+#define PNGPP_THREAD_POOL_HPP_INCLUDED
+
+#include "config.hpp"
+
+#ifdef PNGPP_HAS_STD_THREAD
+
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace png
+{
+
+    /**
+     * \brief A work-stealing thread pool.
+     *
+     * Every worker thread owns a task queue.  Tasks submitted from a
+     * worker go to the back of its own queue; other tasks are spread
+     * round-robin.  A worker takes tasks from the back of its own
+     * queue and, when that is empty, steals from the front of the
+     * others.
+     *
+     * Tasks should not throw: an exception escaping a task is
+     * swallowed.  Use \c std::packaged_task to pass results and
+     * errors back to the caller.
+     *
+     * Requires C++11 (see \c PNGPP_HAS_STD_THREAD in config.hpp).
+     */
+    class thread_pool
+    {
+        thread_pool(thread_pool const&);
+        thread_pool& operator=(thread_pool const&);
+
+    public:
+        typedef std::function< void () > task;
+
+        /**
+         * \brief Starts \a thread_count worker threads.  The default
+         * of \c 0 means one thread per hardware thread.
+         */
+        explicit thread_pool(size_t thread_count = 0)
+            : m_queued(0),
+              m_pending(0),
+              m_next(0),
+              m_stop(false)
+        {
+            if (thread_count == 0)
+            {
+                thread_count = std::thread::hardware_concurrency();
+                if (thread_count == 0)
+                {
+                    thread_count = 1;
+                }
+            }
+            for (size_t i = 0; i < thread_count; ++i)
+            {
+                m_queues.push_back(std::unique_ptr< queue >(new queue));
+            }
+            for (size_t i = 0; i < thread_count; ++i)
+            {
+                m_threads.push_back(std::thread(& thread_pool::run,
+                                                this, i));
+            }
+        }
+
+        /**
+         * \brief Waits for all the submitted tasks to complete and
+         * stops the worker threads.
+         */
+        ~thread_pool()
+        {
+            wait();
+            {
+                std::lock_guard< std::mutex > lock(m_mutex);
+                m_stop = true;
+            }
+            m_wake.notify_all();
+            for (size_t i = 0; i < m_threads.size(); ++i)
+            {
+                m_threads[i].join();
+            }
+        }
+
+        size_t get_thread_count() const
+        {
+            return m_threads.size();
+        }
+
+        /**
+         * \brief Schedules \a t for execution.
+         */
+        void submit(task t)
+        {
+            std::lock_guard< std::mutex > lock(m_mutex);
+            size_t index;
+            if (get_current_pool() == this)
+            {
+                index = get_current_index();
+            }
+            else
+            {
+                index = m_next++ % m_queues.size();
+            }
+            {
+                queue& q = *m_queues[index];
+                std::lock_guard< std::mutex > queue_lock(q.mutex);
+                q.tasks.push_back(std::move(t));
+            }
+            ++m_queued;
+            ++m_pending;
+            m_wake.notify_one();
+        }
+
+        /**
+         * \brief Blocks until all the submitted tasks have completed.
+         * Must not be called from a task.
+         */
+        void wait()
+        {
+            assert(get_current_pool() != this);
+            std::unique_lock< std::mutex > lock(m_mutex);
+            while (m_pending != 0)
+            {
+                m_idle.wait(lock);
+            }
+        }
+
+    private:
+        struct queue
+        {
+            std::mutex mutex;
+            std::deque< task > tasks;
+        };
+
+        static thread_pool*& get_current_pool()
+        {
+            static thread_local thread_pool* pool = 0;
+            return pool;
+        }
+
+        static size_t& get_current_index()
+        {
+            static thread_local size_t index = 0;
+            return index;
+        }
+
+        bool take(size_t index, task& t)
+        {
+            {
+                queue& own = *m_queues[index];
+                std::lock_guard< std::mutex > lock(own.mutex);
+                if (!own.tasks.empty())
+                {
+                    t = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    return true;
+                }
+            }
+            for (size_t i = 1; i < m_queues.size(); ++i)
+            {
+                queue& victim = *m_queues[(index + i) % m_queues.size()];
+                std::lock_guard< std::mutex > lock(victim.mutex);
+                if (!victim.tasks.empty())
+                {
+                    t = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void run(size_t index)
+        {
+            get_current_pool() = this;
+            get_current_index() = index;
+            for (;;)
+            {
+                task t;
+                if (take(index, t))
+                {
+                    {
+                        std::lock_guard< std::mutex > lock(m_mutex);
+                        --m_queued;
+                    }
+                    try
+                    {
+                        t();
+                    }
+                    catch (...)
+                    {
+                        // see the class description
+                    }
+                    std::lock_guard< std::mutex > lock(m_mutex);
+                    if (--m_pending == 0)
+                    {
+                        m_idle.notify_all();
+                    }
+                    continue;
+                }
+                std::unique_lock< std::mutex > lock(m_mutex);
+                while (!m_stop && m_queued == 0)
+                {
+                    m_wake.wait(lock);
+                }
+                if (m_stop && m_queued == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        std::vector< std::unique_ptr< queue > > m_queues;
+        std::vector< std::thread > m_threads;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        size_t m_queued;
+        size_t m_pending;
+        size_t m_next;
+        bool m_stop;
+    };
+
+} // namespace png
+
+#endif // PNGPP_HAS_STD_THREAD
+
+#endif // PNGPP_THREAD_POOL_HPP_INCLUDED
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2007,2008   Alex Shulgin
+ *
+ * This file is part of png++ the C++ wrapper for libpng.  PNG++ is free
+ * software; the exact copying conditions are as follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * 3. The name of the author may not be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PNGPP_TRUSTED_INPUT_HPP_INCLUDED
+#define PNGPP_TRUSTED_INPUT_HPP_INCLUDED
+
+#include "io_base.hpp"
+#include "reader.hpp"
+
+namespace png
+{
+
+    namespace detail
+    {
+
+        /**
+         * \brief Pass-through transformation: the default for
+         * trusted_input.
+         */
+        struct no_transform
+        {
+            void operator()(io_base&) const {}
+        };
+
+    } // namespace detail
+
+    /**
+     * \brief IO transformation wrapper switching off the integrity
+     * checks of libpng for input known to be intact.
+     *
+     * Applies \c transformation as usual; in addition consumer::read()
+     * calls reader::set_trusted_input() before reading the image
+     * %info, so chunk CRCs, ancillary chunks and (unless requested)
+     * the zlib Adler-32 checksum are skipped:
+     *
+     * \code
+     * png::image< png::rgba_pixel > image;
+     * image.read(filename,
+     *            png::trusted_input< png::convert_color_space
+     *                                < png::rgba_pixel > >());
+     * \endcode
+     *
+     * Corrupted data may then produce garbage pixels instead of an
+     * error.  push_consumer cannot apply the settings in time and
+     * only applies the wrapped transformation.
+     */
+    template< class transformation = detail::no_transform >
+    class trusted_input
+    {
+    public:
+        explicit trusted_input(transformation const& transform
+                                   = transformation(),
+                               bool check_adler32 = false)
+            : m_transform(transform),
+              m_check_adler32(check_adler32)
+        {
+        }
+
+        void operator()(io_base& io) const
+        {
+            m_transform(io);
+        }
+
+        /**
+         * \brief Applies the trusted input settings to a reader
+         * which has not read the image %info yet.
+         */
+        template< class istream >
+        void prepare(reader< istream >& rd) const
+        {
+            rd.set_trusted_input(m_check_adler32);
+        }
+
+    private:
+        transformation m_transform;
+        bool m_check_adler32;
+    };
+
+    namespace detail
+    {
+
+        /*
+         * Called by consumer::read() before the image info is read:
+         * nothing to do for ordinary transformations.
+         */
+        template< class istream, class transformation >
+        void prepare_reader(reader< istream >&, transformation const&)
+        {
+        }
+
+        template< class istream, class transformation >
+        void prepare_reader(reader< istream >& rd,
+                            trusted_input< transformation > const& transform)
+        {
+            transform.prepare(rd);
+        }
+
+    } // namespace detail
+
+} // namespace png
+
+#endif // PNGPP_TRUSTED_INPUT_HPP_INCLUDED
@@ -95,6 +95,24 @@ namespace png
         filter_type_default     = PNG_FILTER_TYPE_DEFAULT
     };
 
+    enum crc_action
+    {
+        crc_default      = PNG_CRC_DEFAULT,
+        crc_error_quit   = PNG_CRC_ERROR_QUIT,
+        crc_warn_discard = PNG_CRC_WARN_DISCARD,
+        crc_warn_use     = PNG_CRC_WARN_USE,
+        crc_quiet_use    = PNG_CRC_QUIET_USE,
+        crc_no_change    = PNG_CRC_NO_CHANGE
+    };
+
+    enum chunk_handling
+    {
+        handle_chunk_as_default = PNG_HANDLE_CHUNK_AS_DEFAULT,
+        handle_chunk_never      = PNG_HANDLE_CHUNK_NEVER,
+        handle_chunk_if_safe    = PNG_HANDLE_CHUNK_IF_SAFE,
+        handle_chunk_always     = PNG_HANDLE_CHUNK_ALWAYS
+    };
+
     enum chunk
     {
         chunk_gAMA = PNG_INFO_gAMA,
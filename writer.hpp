@@ -33,6 +33,7 @@
 
 #include <cassert>
 #include "io_base.hpp"
+#include "compression_profile.hpp"
 
 namespace png
 {
@@ -58,9 +59,15 @@ namespace png
      *
      * With the semantics similar to the \c std::ostream.  Naturally,
      * \c std::ostream fits this requirement and can be used with the
-     * writer class as is.
+     * writer class as is.  To write PNG data into memory use
+     * memory_ostream.
      *
-     * \see image, reader, generator, io_base
+     * libpng and zlib memory is allocated through the calling
+     * thread's current memory_resource, if any (see
+     * memory_resource::scope).
+     *
+     * \see image, reader, generator, io_base, memory_ostream,
+     * memory_resource
      */
     template< class ostream >
     class writer
@@ -72,10 +79,7 @@ namespace png
          * a \a stream.
          */
         explicit writer(ostream& stream)
-            : io_base(png_create_write_struct(PNG_LIBPNG_VER_STRING,
-                                              static_cast< io_base* >(this),
-                                              raise_error,
-                                              0))
+            : io_base(create_write_struct(static_cast< io_base* >(this)))
         {
             png_set_write_fn(m_png, & stream, write_data, flush_data);
         }
@@ -86,6 +90,103 @@ namespace png
             png_destroy_write_struct(& m_png, m_info.get_png_info_ptr());
         }
 
+#ifdef PNG_WRITE_CUSTOMIZE_COMPRESSION_SUPPORTED
+        /**
+         * \brief Sets the zlib compression level (0 to 9).
+         */
+        void set_compression_level(int level) const
+        {
+            png_set_compression_level(m_png, level);
+        }
+
+        /**
+         * \brief Sets the zlib compression strategy.
+         */
+        void set_compression_strategy(int strategy) const
+        {
+            png_set_compression_strategy(m_png, strategy);
+        }
+
+        /**
+         * \brief Sets the zlib window size as a base two logarithm
+         * (8 to 15).
+         */
+        void set_compression_window_bits(int bits) const
+        {
+            png_set_compression_window_bits(m_png, bits);
+        }
+
+        /**
+         * \brief Sets the zlib memory level (1 to 9).
+         */
+        void set_compression_mem_level(int level) const
+        {
+            png_set_compression_mem_level(m_png, level);
+        }
+#endif
+
+        /**
+         * \brief Sets the size of the buffer collecting compressed
+         * data, which is also the size of the IDAT chunks written.
+         */
+        void set_compression_buffer_size(size_t size) const
+        {
+            if (setjmp(png_jmpbuf(m_png)))
+            {
+                throw error(m_error);
+            }
+            png_set_compression_buffer_size(m_png, size);
+        }
+
+        /**
+         * \brief Sets the row filters libpng chooses from, a
+         * combination of the \c PNG_FILTER_* flags.
+         */
+        void set_filter(int filters) const
+        {
+            if (setjmp(png_jmpbuf(m_png)))
+            {
+                throw error(m_error);
+            }
+            png_set_filter(m_png, PNG_FILTER_TYPE_BASE, filters);
+        }
+
+        /**
+         * \brief Applies the fields of \a profile which are not left
+         * at their defaults.  Must be called before write_info().
+         */
+        void set_compression_profile(compression_profile const& profile)
+            const
+        {
+#ifdef PNG_WRITE_CUSTOMIZE_COMPRESSION_SUPPORTED
+            if (profile.get_level() != compression_profile::keep_default)
+            {
+                set_compression_level(profile.get_level());
+            }
+            if (profile.get_strategy() != compression_profile::keep_default)
+            {
+                set_compression_strategy(profile.get_strategy());
+            }
+            if (profile.get_window_bits()
+                != compression_profile::keep_default)
+            {
+                set_compression_window_bits(profile.get_window_bits());
+            }
+            if (profile.get_mem_level() != compression_profile::keep_default)
+            {
+                set_compression_mem_level(profile.get_mem_level());
+            }
+#endif
+            if (profile.get_filters() != compression_profile::keep_default)
+            {
+                set_filter(profile.get_filters());
+            }
+            if (profile.get_buffer_size())
+            {
+                set_compression_buffer_size(profile.get_buffer_size());
+            }
+        }
+
         void write_png() const
         {
             if (setjmp(png_jmpbuf(m_png)))
@@ -122,6 +223,31 @@ namespace png
             png_write_row(m_png, bytes);
         }
 
+        /**
+         * \brief Writes \a count rows of image data at a time.
+         */
+        void write_rows(byte** rows, size_t count)
+        {
+            if (setjmp(png_jmpbuf(m_png)))
+            {
+                throw error(m_error);
+            }
+            png_write_rows(m_png, rows, static_cast< png_uint_32 >(count));
+        }
+
+        /**
+         * \brief Writes the whole image, all interlace passes
+         * included, from the rows listed in \a rows.
+         */
+        void write_image(byte** rows)
+        {
+            if (setjmp(png_jmpbuf(m_png)))
+            {
+                throw error(m_error);
+            }
+            png_write_image(m_png, rows);
+        }
+
         /**
          * \brief Reads ending info about PNG image.
          */